@@ -0,0 +1,127 @@
+#ifndef NYKDTB_ALLOCATOR_HPP
+#define NYKDTB_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <new>
+
+#include "nykdtb/types.hpp"
+
+namespace nykdtb {
+
+// Allocator policies decide where PartialStackStorageVector puts its heap storage. A policy is a type
+// with static members only, deallocate is given the same size and alignment the block was allocated with.
+template<typename A>
+concept AllocatorPolicy = requires(void* ptr, std::size_t bytes, std::size_t alignment) {
+    { A::allocate(bytes, alignment) } -> std::same_as<void*>;
+    A::deallocate(ptr, bytes, alignment);
+};
+
+// Policies may also provide allocateZeroed, returning a block that already reads as zeros. It is used for
+// zero filled storage when the policy can do better than allocate followed by a fill.
+template<typename A>
+concept ZeroingAllocatorPolicy = AllocatorPolicy<A> && requires(std::size_t bytes, std::size_t alignment) {
+    { A::allocateZeroed(bytes, alignment) } -> std::same_as<void*>;
+};
+
+// The global heap. Blocks of MAP_THRESHOLD bytes or more are mapped from the OS directly where mmap is
+// available, so zeroed ones come as untouched pages that the kernel zeroes on first access.
+struct MallocAllocator {
+    // glibc maps blocks of this size itself as well, so plain allocations behave the same as with malloc
+    static constexpr std::size_t MAP_THRESHOLD = std::size_t{1} << 25;
+
+    static void* allocate(std::size_t bytes, std::size_t alignment);
+    static void* allocateZeroed(std::size_t bytes, std::size_t alignment);
+    static void deallocate(void* ptr, std::size_t bytes, std::size_t alignment);
+};
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(NoActiveArena, LogicException)
+
+// Bump-pointer arena. Allocations are carved out of large blocks and are not freed one by one, reset()
+// forgets all of them at once in O(1) while keeping the blocks for reuse. An arena is not thread safe
+// and must outlive everything allocated from it.
+class Arena {
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = std::size_t{1} << 20;
+
+    // Makes arena the one ArenaAllocator uses on the calling thread until the scope ends
+    class Scope {
+    public:
+        explicit Scope(Arena& arena);
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* m_previous;
+    };
+
+public:
+    explicit Arena(std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~Arena();
+
+    Arena(const Arena&)            = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t alignment);
+    void reset();
+
+    // Bytes handed out since the last reset, including alignment padding
+    std::size_t used() const { return m_used; }
+    // Bytes held in blocks
+    std::size_t reserved() const { return m_reserved; }
+
+    static Arena* current();
+
+private:
+    struct Block {
+        std::byte* begin;
+        std::size_t size;
+    };
+
+    bool fits(const Block& block, std::size_t bytes, std::size_t alignment) const;
+
+private:
+    Vec<Block> m_blocks;
+    Index m_current;
+    std::size_t m_offset;
+    std::size_t m_blockSize;
+    std::size_t m_used;
+    std::size_t m_reserved;
+};
+
+// Allocates from the current Arena of the thread and never frees, throws NoActiveArena without one
+struct ArenaAllocator {
+    static void* allocate(const std::size_t bytes, const std::size_t alignment) {
+        Arena* arena = Arena::current();
+        if (arena == nullptr) {
+            throw NoActiveArena();
+        }
+        return arena->allocate(bytes, alignment);
+    }
+
+    static void deallocate(void*, std::size_t, std::size_t) {}
+};
+
+// Size-class pool. Blocks are rounded up to powers of two and freed blocks are cached in free lists of
+// the deallocating thread, so arrays of similar sizes created over and over reuse memory without going
+// through malloc and its locks. Blocks outside the pooled classes go to MallocAllocator.
+struct PoolAllocator {
+    // Smallest class, also the alignment of every pooled block
+    static constexpr std::size_t MIN_CLASS = 256;
+    static constexpr std::size_t MAX_CLASS = std::size_t{1} << 22;
+    // Blocks kept per class and thread, further ones are freed
+    static constexpr Size MAX_CACHED = 32;
+
+    static void* allocate(std::size_t bytes, std::size_t alignment);
+    static void* allocateZeroed(std::size_t bytes, std::size_t alignment);
+    static void deallocate(void* ptr, std::size_t bytes, std::size_t alignment);
+    // Frees the blocks cached by the calling thread
+    static void trim();
+};
+
+}  // namespace nykdtb
+
+#endif
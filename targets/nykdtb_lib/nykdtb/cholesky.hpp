@@ -0,0 +1,54 @@
+#ifndef NYKDTB_CHOLESKY_HPP
+#define NYKDTB_CHOLESKY_HPP
+
+#include <algorithm>
+#include <cmath>
+
+#include "nykdtb/lu.hpp"
+
+namespace nykdtb::nda::cholesky {
+
+// Kernels on dense row-major n x n matrices addressed as a[row * lda + col]
+
+// In-place Cholesky factorization A = L * L^T of a symmetric positive definite matrix. Only the lower
+// triangle of a is read; afterwards it holds L and the strict upper triangle is zeroed. Every entry
+// is a dot product of two rows of L, so the inner loops run over contiguous memory.
+// Returns false if the matrix is not positive definite.
+template<typename T>
+inline static bool factorize(T* a, const Index lda, const Size n) {
+    for (Index j = 0; j < n; ++j) {
+        T* rowJ    = a + j * lda;
+        T diagonal = rowJ[j];
+        for (Index k = 0; k < j; ++k) {
+            diagonal -= rowJ[k] * rowJ[k];
+        }
+        if (!(diagonal > T{0})) {
+            return false;
+        }
+        rowJ[j] = std::sqrt(diagonal);
+        std::fill(rowJ + j + 1, rowJ + n, T{0});
+
+        const T inverse = T{1} / rowJ[j];
+        for (Index i = j + 1; i < n; ++i) {
+            T* rowI = a + i * lda;
+            T value = rowI[j];
+            for (Index k = 0; k < j; ++k) {
+                value -= rowI[k] * rowJ[k];
+            }
+            rowI[j] = value * inverse;
+        }
+    }
+    return true;
+}
+
+// b = A^-1 * b from the Cholesky factor L of A: L * y = b, then L^T * x = y
+template<typename T>
+inline static void solve(
+    const T* l, const Index ldl, const Size n, T* b, const Index ldb, const Size k, PSVec<T, 1, 64>& scratch) {
+    lu::solveTriangular(gemm::StridedSource<T>{l, ldl, 1}, n, true, false, b, ldb, k, scratch);
+    lu::solveTriangular(gemm::StridedSource<T>{l, 1, ldl}, n, false, false, b, ldb, k, scratch);
+}
+
+}  // namespace nykdtb::nda::cholesky
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef NYKDTB_CHUNKED_HPP
+#define NYKDTB_CHUNKED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "nykdtb/mapped.hpp"
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/ndarray_ops.hpp"
+#include "nykdtb/npy.hpp"
+#include "nykdtb/types.hpp"
+
+// Compressed array files. The array is cut along its first dimension into chunks of whole rows, every
+// chunk is filtered and compressed on its own with a small LZ codec, and an index of the chunks at the
+// end of the file lets readers decompress only the rows they need.
+namespace nykdtb::chunked {
+
+// The I/O errors are the ones of npy, so callers handle both formats alike
+using npy::DtypeMismatch;
+using npy::FileError;
+using npy::InvalidFormat;
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(InvalidRange, LogicException)
+
+// Reversible transforms applied to a chunk before compression
+enum class Filter : uint8_t {
+    None,
+    // Groups the n-th bytes of all elements together, the slowly changing high bytes of numbers then
+    // form long runs
+    Shuffle,
+    // Replaces every element by its difference to the previous one, as integers of the element size
+    Delta,
+    // Delta followed by Shuffle
+    DeltaShuffle,
+};
+
+struct WriteOptions {
+    Filter filter = Filter::Shuffle;
+    // Uncompressed size of a chunk, rounded to whole rows
+    std::size_t chunkBytes = 1 << 20;
+    // threadCount of 0 uses defaultThreadCount()
+    Size threadCount = 0;
+};
+
+using Shape = npy::Shape;
+
+struct Header {
+    // Element type in the notation of npy::descr
+    std::string descr;
+    std::size_t elementSize = 0;
+    Filter filter           = Filter::None;
+    Shape shape;
+    Size chunkRows = 1;
+};
+
+namespace detail {
+
+// Compresses size bytes of input into output, returns the compressed size, or 0 if it would not be
+// smaller than capacity
+std::size_t compress(const std::byte* input, std::size_t size, std::byte* output, std::size_t capacity);
+// Decompresses exactly rawSize bytes, throws InvalidFormat for corrupt input
+void decompress(const std::byte* input, std::size_t size, std::byte* output, std::size_t rawSize);
+
+void applyFilter(Filter filter, std::byte* data, std::byte* scratch, std::size_t size, std::size_t elementSize);
+void reverseFilter(Filter filter, std::byte* data, std::byte* scratch, std::size_t size, std::size_t elementSize);
+
+void write(const std::string& path, const Header& header, const std::byte* data, const WriteOptions& options);
+
+}  // namespace detail
+
+// Writes array to path in C order, the chunks are compressed in parallel
+template<NDArrayLike A>
+    requires npy::Element<std::remove_cv_t<typename A::Type>>
+inline static void save(const std::string& path, const A& array, const WriteOptions& options = {}) {
+    using T = std::remove_cv_t<typename A::Type>;
+    const Header header{npy::descr<T>(), sizeof(T), options.filter, Shape(array.shape().begin(), array.shape().end())};
+    if constexpr (ContiguousNDArray<A>) {
+        detail::write(path, header, reinterpret_cast<const std::byte*>(array.begin()), options);
+    } else {
+        const auto dense = nda::materialize(array);
+        detail::write(path, header, reinterpret_cast<const std::byte*>(dense.begin()), options);
+    }
+}
+
+// Maps a chunked file and decompresses rows of it on request
+class Reader {
+public:
+    explicit Reader(const std::string& path);
+
+    const Header& header() const { return m_header; }
+    const Shape& shape() const { return m_header.shape; }
+    Size rows() const { return m_header.shape[0]; }
+    Size chunkCount() const { return static_cast<Size>(m_index.size()); }
+    // Bytes taken by the chunks in the file
+    std::size_t storedBytes() const;
+
+    // Rows [begin, end) of the first dimension, only the chunks holding them are decompressed, in parallel
+    template<NDArrayLike A>
+        requires ContiguousNDArray<A> && npy::Element<typename A::Type>
+    A readRows(const Index begin, const Index end, const Size threadCount = 0) const {
+        using T = typename A::Type;
+        checkDtype(npy::descr<T>(), sizeof(T));
+        if (begin < 0 || end < begin || end > rows()) {
+            throw InvalidRange("Rows [" + std::to_string(begin) + ", " + std::to_string(end) + ") of " +
+                               std::to_string(rows()));
+        }
+        Shape shape = m_header.shape;
+        shape[0]    = end - begin;
+        A result    = uninitializedArray<A>(NDArrayCalc::convertShape<typename A::Shape>(shape));
+        readRows(begin,
+                 end,
+                 reinterpret_cast<std::byte*>(result.begin()),
+                 static_cast<std::size_t>(result.size()) * sizeof(T),
+                 threadCount);
+        return result;
+    }
+
+    template<npy::Element T>
+    NDArray<T> readRows(const Index begin, const Index end, const Size threadCount = 0) const {
+        return readRows<NDArray<T>>(begin, end, threadCount);
+    }
+
+    template<NDArrayLike A>
+        requires ContiguousNDArray<A> && npy::Element<typename A::Type>
+    A read(const Size threadCount = 0) const {
+        return readRows<A>(0, rows(), threadCount);
+    }
+
+    template<npy::Element T>
+    NDArray<T> read(const Size threadCount = 0) const {
+        return readRows<NDArray<T>>(0, rows(), threadCount);
+    }
+
+private:
+    struct Chunk {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+private:
+    void checkDtype(const std::string& expected, std::size_t elementSize) const;
+    // Decodes into output, which must hold outputBytes, at least the rows asked for
+    void readRows(Index begin, Index end, std::byte* output, std::size_t outputBytes, Size threadCount) const;
+
+private:
+    MappedFile m_file;
+    Header m_header;
+    Vec<Chunk> m_index;
+};
+
+template<NDArrayLike A>
+    requires ContiguousNDArray<A> && npy::Element<typename A::Type>
+inline static A load(const std::string& path, const Size threadCount = 0) {
+    return Reader(path).read<A>(threadCount);
+}
+
+template<npy::Element T>
+inline static NDArray<T> load(const std::string& path, const Size threadCount = 0) {
+    return load<NDArray<T>>(path, threadCount);
+}
+
+}  // namespace nykdtb::chunked
+
+#endif
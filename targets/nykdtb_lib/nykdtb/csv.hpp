@@ -0,0 +1,307 @@
+#ifndef NYKDTB_CSV_HPP
+#define NYKDTB_CSV_HPP
+
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "nykdtb/mapped.hpp"
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/ndarray_ops.hpp"
+#include "nykdtb/threadpool.hpp"
+#include "nykdtb/types.hpp"
+
+// Delimited text, one row of numbers per line, read into {rows, columns} arrays and written from arrays
+namespace nykdtb::csv {
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(ParseError, RuntimeException)
+NYKDTB_DEFINE_EXCEPTION_CLASS(WriteError, RuntimeException)
+
+// Numbers std::from_chars can parse
+template<typename T>
+concept Element = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+struct ReadOptions {
+    char delimiter = ',';
+    // Lines skipped before the first row, e.g. a header line
+    Size skipLines = 0;
+    // threadCount of 0 uses defaultThreadCount()
+    Size threadCount = 0;
+};
+
+struct WriteOptions {
+    char delimiter = ',';
+    // Digits of floating point values as in printf, 0 writes the shortest text that reads back exactly
+    int precision            = 0;
+    std::chars_format format = std::chars_format::general;
+};
+
+namespace detail {
+
+// Consecutive pieces of text, each starting at the beginning of a line
+struct Chunk {
+    const char* begin;
+    const char* end;
+};
+
+// Spaces, tabs and carriage returns around the values, unless one of them is the delimiter
+inline static const char* skipBlanks(const char* p, const char* end, const char delimiter) {
+    while (p != end && (*p == ' ' || *p == '\t' || *p == '\r') && *p != delimiter) {
+        ++p;
+    }
+    return p;
+}
+
+inline static const char* lineEnd(const char* p, const char* end) {
+    const void* found = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+    return found == nullptr ? end : static_cast<const char*>(found);
+}
+
+// Cuts text into about count chunks of similar size, but no smaller than minBytes
+Vec<Chunk> split(std::string_view text, Size count, std::size_t minBytes);
+// Rows in chunk, lines holding nothing but blanks are not rows
+Size countRows(const Chunk& chunk, char delimiter);
+// Values in the first row of text, 0 if there is none
+Size countColumns(std::string_view text, char delimiter);
+// text without its first lines lines
+std::string_view skipLines(std::string_view text, Size lines);
+
+// Writes all of data to fd, retrying partial and interrupted writes
+void writeAll(int fd, const char* data, std::size_t size);
+int createFile(const std::string& path);
+// False if the pending writes failed
+bool closeFile(int fd);
+
+// Parses the rows of chunk into out, row-major with columns values per row. firstRow only numbers errors.
+template<Element T>
+inline static void parseRows(
+    const Chunk& chunk, const char delimiter, const Size columns, T* out, const Index firstRow) {
+    Index row = firstRow;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* end = lineEnd(line, chunk.end);
+        const char* p   = skipBlanks(line, end, delimiter);
+        line            = end == chunk.end ? end : end + 1;
+        if (p == end) {
+            continue;
+        }
+        for (Index column = 0; column < columns; ++column) {
+            if (column > 0) {
+                if (p == end || *p != delimiter) {
+                    throw ParseError("Row " + std::to_string(row) + " has fewer than " + std::to_string(columns) +
+                                     " values");
+                }
+                p = skipBlanks(p + 1, end, delimiter);
+            }
+            // from_chars rejects an explicit plus sign
+            if (p + 1 < end && *p == '+' && p[1] != '-') {
+                ++p;
+            }
+            const auto parsed = std::from_chars(p, end, *out++);
+            if (parsed.ec != std::errc{}) {
+                throw ParseError("Invalid value in row " + std::to_string(row) + ", column " + std::to_string(column) +
+                                 ": " + std::string(p, static_cast<std::size_t>(end - p)));
+            }
+            p = skipBlanks(parsed.ptr, end, delimiter);
+        }
+        if (p != end) {
+            throw ParseError("Row " + std::to_string(row) + " has more than " + std::to_string(columns) + " values");
+        }
+        ++row;
+    }
+}
+
+}  // namespace detail
+
+// Parses text into a new {rows, columns} array. The text is cut into line aligned chunks, a first
+// parallel pass counts the rows of every chunk, then each chunk is parsed straight into its rows of the
+// uninitialized result. Every row needs the column count of the first one.
+template<NDArrayLike A>
+    requires ContiguousNDArray<A> && Element<typename A::Type>
+inline static A parse(std::string_view text, const ReadOptions& options = {}) {
+    constexpr std::size_t MIN_CHUNK_BYTES = 1 << 16;
+    constexpr Size CHUNKS_PER_THREAD      = 4;
+
+    const Size threadCount = options.threadCount > 0 ? options.threadCount : defaultThreadCount();
+    text                   = detail::skipLines(text, options.skipLines);
+    const auto chunks      = detail::split(text, threadCount * CHUNKS_PER_THREAD, MIN_CHUNK_BYTES);
+    const Size chunkCount  = static_cast<Size>(chunks.size());
+
+    Vec<Size> firstRows(chunks.size() + 1, 0);
+    parallelRun(
+        chunkCount,
+        [&](const Index i) { firstRows[i + 1] = detail::countRows(chunks[i], options.delimiter); },
+        threadCount);
+    for (Index i = 0; i < chunkCount; ++i) {
+        firstRows[i + 1] += firstRows[i];
+    }
+    const Size rows    = firstRows.back();
+    const Size columns = detail::countColumns(text, options.delimiter);
+    if (rows == 0) {
+        throw ParseError("No rows to parse");
+    }
+
+    A result = uninitializedArray<A>(NDArrayCalc::convertShape<typename A::Shape>(PSVec<Size, 2>{rows, columns}));
+    auto* out = result.begin();
+    parallelRun(
+        chunkCount,
+        [&](const Index i) {
+            detail::parseRows(chunks[i], options.delimiter, columns, out + firstRows[i] * columns, firstRows[i]);
+        },
+        threadCount);
+    return result;
+}
+
+template<Element T>
+inline static NDArray<T> parse(const std::string_view text, const ReadOptions& options = {}) {
+    return parse<NDArray<T>>(text, options);
+}
+
+// Maps the file at path and parses it, see parse
+template<NDArrayLike A>
+    requires ContiguousNDArray<A> && Element<typename A::Type>
+inline static A load(const std::string& path, const ReadOptions& options = {}) {
+    const MappedFile file(path, MapMode::ReadOnly);
+    file.advise(MapAdvice::Sequential);
+    return parse<A>({reinterpret_cast<const char*>(file.data()), file.size()}, options);
+}
+
+template<Element T>
+inline static NDArray<T> load(const std::string& path, const ReadOptions& options = {}) {
+    return load<NDArray<T>>(path, options);
+}
+
+// Formats arrays as delimited text with std::to_chars, independent of the locale. The last dimension is a
+// line, so a rank 1 array is a single line, and the matrices of higher rank arrays are separated by blank
+// lines, which parse skips. The text is built in a buffer reused across calls and handed on whenever it
+// fills up, so files are written in blocks of the buffer size.
+class Formatter {
+public:
+    static constexpr std::size_t DEFAULT_BUFFER_BYTES = 1 << 20;
+
+public:
+    explicit Formatter(const WriteOptions& options = {}, std::size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+    // Writes array to the file descriptor fd, which is left open
+    template<NDArrayLike A>
+    void write(const int fd, const A& array) {
+        format(array, [fd](const char* data, const std::size_t size) { detail::writeAll(fd, data, size); });
+    }
+
+    template<NDArrayLike A>
+    std::string toString(const A& array) {
+        std::string result;
+        format(array, [&](const char* data, const std::size_t size) { result.append(data, size); });
+        return result;
+    }
+
+    // Calls sink(data, size) with consecutive blocks of the text of array
+    template<NDArrayLike A, typename Sink>
+        requires Element<std::remove_cv_t<typename A::Type>>
+    void format(const A& array, Sink&& sink) {
+        if constexpr (ContiguousNDArray<A>) {
+            format(array.begin(), array.shape(), sink);
+        } else {
+            const auto dense = nda::materialize(array);
+            format(dense.begin(), dense.shape(), sink);
+        }
+    }
+
+private:
+    // Room for any value in the shortest or general format, longer fixed format values flush first
+    static constexpr std::size_t VALUE_RESERVE = 64;
+
+private:
+    template<typename T, typename Shape, typename Sink>
+    void format(const T* data, const Shape& shape, Sink& sink) {
+        const Size rank    = static_cast<Size>(shape.size());
+        const Size columns = shape[rank - 1];
+        const Size rows    = rank > 1 ? shape[rank - 2] : 1;
+        const Size count   = NDArrayCalc::shapeSize(shape);
+        m_used             = 0;
+        for (Index i = 0, column = 0, row = 0; i < count; ++i) {
+            append(data[i], sink);
+            if (++column < columns) {
+                m_buffer[m_used++] = m_options.delimiter;
+                continue;
+            }
+            column             = 0;
+            m_buffer[m_used++] = '\n';
+            if (++row == rows && i + 1 < count) {
+                row                = 0;
+                m_buffer[m_used++] = '\n';
+            }
+        }
+        flush(sink);
+    }
+
+    // Leaves room for the delimiter and the line ends that follow the value
+    template<typename T, typename Sink>
+    void append(const T value, Sink& sink) {
+        if (m_capacity - m_used < VALUE_RESERVE) {
+            flush(sink);
+        }
+        char* begin = m_buffer.get() + m_used;
+        char* end   = m_buffer.get() + m_capacity - 2;
+        auto result = convert(begin, end, value);
+        if (result.ec == std::errc::value_too_large && m_used > 0) {
+            flush(sink);
+            result = convert(m_buffer.get(), end, value);
+        }
+        if (result.ec != std::errc{}) {
+            throw WriteError("Value does not fit the formatting buffer");
+        }
+        m_used = static_cast<std::size_t>(result.ptr - m_buffer.get());
+    }
+
+    template<typename T>
+    std::to_chars_result convert(char* begin, char* end, const T value) const {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (m_options.precision > 0) {
+                return std::to_chars(begin, end, value, m_options.format, m_options.precision);
+            }
+            return std::to_chars(begin, end, value, m_options.format);
+        } else {
+            return std::to_chars(begin, end, value);
+        }
+    }
+
+    template<typename Sink>
+    void flush(Sink& sink) {
+        if (m_used > 0) {
+            sink(static_cast<const char*>(m_buffer.get()), m_used);
+            m_used = 0;
+        }
+    }
+
+private:
+    WriteOptions m_options;
+    UniquePtr<char[]> m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_used;
+};
+
+// Writes array to the file at path, replacing it
+template<NDArrayLike A>
+inline static void save(const std::string& path, const A& array, const WriteOptions& options = {}) {
+    const int fd = detail::createFile(path);
+    try {
+        Formatter(options).write(fd, array);
+    } catch (...) {
+        detail::closeFile(fd);
+        throw;
+    }
+    if (!detail::closeFile(fd)) {
+        throw WriteError("Cannot write " + path);
+    }
+}
+
+template<NDArrayLike A>
+inline static std::string toString(const A& array, const WriteOptions& options = {}) {
+    return Formatter(options, 1 << 12).toString(array);
+}
+
+}  // namespace nykdtb::csv
+
+#endif
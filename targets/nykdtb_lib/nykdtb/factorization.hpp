@@ -0,0 +1,170 @@
+#ifndef NYKDTB_FACTORIZATION_HPP
+#define NYKDTB_FACTORIZATION_HPP
+
+#include <cmath>
+
+#include "nykdtb/cholesky.hpp"
+#include "nykdtb/lu.hpp"
+#include "nykdtb/ndarray_ops.hpp"
+
+namespace nykdtb::nda::d2 {
+
+// Factorizations are computed once on construction and can then solve any number of right-hand
+// sides. A right-hand side is either a vector of shape {n} or a batch of k columns of shape {n, k}.
+
+template<typename T>
+struct LogDeterminant {
+    T sign;
+    T logAbs;
+};
+
+template<typename T, NDArrayLike A>
+inline static NDArray<T> squareCopy(const A& matrix) {
+    if (!isSquare<A>(matrix.shape())) {
+        throw Matrix2DError("Only 2D square matrices can be factorized");
+    }
+    return NDArray<T>(matrix.begin(), matrix.end(), typename NDArray<T>::Shape{matrix.shape(0), matrix.shape(1)});
+}
+
+// Number of right-hand side columns in rhs
+template<NDArrayLike B>
+inline static Size rightHandSideCount(const B& rhs, const Size dim) {
+    const Size rank = static_cast<Size>(rhs.shape().size());
+    if ((rank != 1 && rank != 2) || rhs.shape(0) != dim) {
+        throw Matrix2DError("Right-hand side does not match the factorized matrix");
+    }
+    return rank == 1 ? 1 : rhs.shape(1);
+}
+
+template<typename T, NDArrayLike B>
+inline static NDArray<T> rightHandSideCopy(const B& rhs, const Size dim) {
+    rightHandSideCount(rhs, dim);
+    return NDArray<T>(rhs.begin(), rhs.end(), NDArrayCalc::convertShape<typename NDArray<T>::Shape>(rhs.shape()));
+}
+
+// P * A = L * U with partial pivoting, for general square matrices
+template<typename T>
+class LU {
+public:
+    using Type   = T;
+    using Matrix = NDArray<T>;
+
+public:
+    template<NDArrayLike A>
+    explicit LU(const A& matrix)
+        : m_factors(squareCopy<T>(matrix)), m_pivots(PSVec<Index, 1>::constructFilled(matrix.shape(0), 0)) {
+        if (!lu::factorize(m_factors.begin(), dim(), dim(), m_pivots.begin())) {
+            throw Matrix2DError("Matrix is singular");
+        }
+    }
+
+    Size dim() const { return m_factors.shape(0); }
+    // L below the diagonal (with an implicit unit diagonal) and U on and above it
+    const Matrix& factors() const { return m_factors; }
+    const PSVec<Index, 1>& pivots() const { return m_pivots; }
+
+    T determinant() const { return lu::determinant(m_factors.begin(), dim(), m_pivots.begin(), dim()); }
+
+    LogDeterminant<T> logDeterminant() const {
+        LogDeterminant<T> result{T{1}, T{0}};
+        for (Index i = 0; i < dim(); ++i) {
+            const T diagonal = m_factors[{i, i}];
+            result.logAbs += std::log(std::abs(diagonal));
+            if ((diagonal < T{0}) != (m_pivots[i] != i)) {
+                result.sign = -result.sign;
+            }
+        }
+        return result;
+    }
+
+    template<NDArrayLike B>
+    Matrix solve(const B& rhs) const {
+        Matrix result = rightHandSideCopy<T>(rhs, dim());
+        solveInPlace(result);
+        return mmove(result);
+    }
+
+    void solveInPlace(Matrix& rhs) const {
+        const Size count = rightHandSideCount(rhs, dim());
+        lu::solve(m_factors.begin(),
+                  dim(),
+                  m_pivots.begin(),
+                  dim(),
+                  rhs.begin(),
+                  count,
+                  count,
+                  lu::Workspace<T>::local().scratch);
+    }
+
+    Matrix inverse() const {
+        Matrix result = uninitializedArray<Matrix>({dim(), dim()});
+        lu::invert(m_factors.begin(),
+                   dim(),
+                   m_pivots.begin(),
+                   dim(),
+                   result.begin(),
+                   dim(),
+                   lu::Workspace<T>::local().scratch);
+        return mmove(result);
+    }
+
+private:
+    Matrix m_factors;
+    PSVec<Index, 1> m_pivots;
+};
+
+// A = L * L^T for symmetric positive definite matrices. Only the lower triangle of A is read.
+template<typename T>
+class Cholesky {
+public:
+    using Type   = T;
+    using Matrix = NDArray<T>;
+
+public:
+    template<NDArrayLike A>
+    explicit Cholesky(const A& matrix)
+        : m_factor(squareCopy<T>(matrix)) {
+        if (!cholesky::factorize(m_factor.begin(), dim(), dim())) {
+            throw Matrix2DError("Matrix is not positive definite");
+        }
+    }
+
+    Size dim() const { return m_factor.shape(0); }
+    // Lower triangular L, zero above the diagonal
+    const Matrix& factor() const { return m_factor; }
+
+    T determinant() const {
+        T result = T{1};
+        for (Index i = 0; i < dim(); ++i) {
+            result *= m_factor[{i, i}] * m_factor[{i, i}];
+        }
+        return result;
+    }
+
+    T logDeterminant() const {
+        T result = T{0};
+        for (Index i = 0; i < dim(); ++i) {
+            result += std::log(m_factor[{i, i}]);
+        }
+        return T{2} * result;
+    }
+
+    template<NDArrayLike B>
+    Matrix solve(const B& rhs) const {
+        Matrix result = rightHandSideCopy<T>(rhs, dim());
+        solveInPlace(result);
+        return mmove(result);
+    }
+
+    void solveInPlace(Matrix& rhs) const {
+        const Size count = rightHandSideCount(rhs, dim());
+        cholesky::solve(m_factor.begin(), dim(), dim(), rhs.begin(), count, count, lu::Workspace<T>::local().scratch);
+    }
+
+private:
+    Matrix m_factor;
+};
+
+}  // namespace nykdtb::nda::d2
+
+#endif
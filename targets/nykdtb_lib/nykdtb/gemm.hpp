@@ -0,0 +1,311 @@
+#ifndef NYKDTB_GEMM_HPP
+#define NYKDTB_GEMM_HPP
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/threadpool.hpp"
+
+namespace nykdtb::nda::gemm {
+
+template<typename T>
+struct Blocking {
+    // Register tile of the micro-kernel: MR rows of A times NR columns of B
+    static constexpr Size MR = 4;
+    static constexpr Size NR = std::max<Size>(4, static_cast<Size>(32 / sizeof(T)));
+    // Cache blocks: an MC x KC panel of A stays in L2, a KC x NR sliver of B in L1
+    static constexpr Size KC = 256;
+    static constexpr Size MC = 128;
+    static constexpr Size NC = 4096;
+
+    // Below this many multiply-adds packing costs more than it saves
+    static constexpr Size SMALL_PRODUCT = 32 * 32 * 32;
+    // Below this many multiply-adds per thread the pool overhead dominates
+    static constexpr Size PARALLEL_PRODUCT_PER_THREAD = 64 * 64 * 64;
+};
+
+template<typename T>
+struct StridedSource {
+    const T* data;
+    Index rowStride;
+    Index colStride;
+
+    inline T operator()(const Index row, const Index col) const { return data[row * rowStride + col * colStride]; }
+};
+
+template<NDArrayLike A, typename T>
+struct IndexedSource {
+    const A& array;
+    Index rowStride;
+    Index colStride;
+
+    inline T operator()(const Index row, const Index col) const {
+        return static_cast<T>(array[row * rowStride + col * colStride]);
+    }
+};
+
+// Arrays that expose their memory layout, including slices and transposed views, are read
+// directly through their strides; anything else goes through operator[]
+template<typename T, NDArrayLike A>
+inline static auto source(const A& array) {
+    if constexpr (StridedAccessible<const A> && std::is_same_v<std::remove_cv_t<typename A::Type>, T>) {
+        const auto layout = stridedLayout(array);
+        return StridedSource<T>{layout.data, layout.strides[0], layout.strides[1]};
+    } else {
+        return IndexedSource<A, T>{array, array.stride(0), array.stride(1)};
+    }
+}
+
+template<typename T>
+struct Workspace {
+    PSVec<T, 1, 64> packedA;
+    PSVec<T, 1, 64> packedB;
+
+    inline void reserve(const Size sizeA, const Size sizeB) {
+        if (packedA.size() < sizeA) {
+            packedA.resize(sizeA);
+        }
+        if (packedB.size() < sizeB) {
+            packedB.resize(sizeB);
+        }
+    }
+
+    static inline Workspace& local() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+};
+
+// Whether consecutive columns of a row are closer in memory than consecutive rows of a column,
+// which decides the loop order that reads the source sequentially while packing
+template<typename Src>
+inline static bool rowMajor(const Src& src) {
+    return std::abs(src.colStride) <= std::abs(src.rowStride);
+}
+
+inline static constexpr Size roundUp(const Size value, const Size multiple) {
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+template<typename T, typename Src>
+inline static void packA(const Src& a, const Index rowBegin, const Index kBegin, const Size mc, const Size kc, T* out) {
+    constexpr Size MR  = Blocking<T>::MR;
+    const bool byDepth = rowMajor(a);
+    for (Index panel = 0; panel < mc; panel += MR, out += MR * kc) {
+        const Size rows = std::min(MR, mc - panel);
+        if (byDepth) {
+            for (Index i = 0; i < MR; ++i) {
+                for (Index k = 0; k < kc; ++k) {
+                    out[k * MR + i] = i < rows ? a(rowBegin + panel + i, kBegin + k) : T{0};
+                }
+            }
+        } else {
+            for (Index k = 0; k < kc; ++k) {
+                for (Index i = 0; i < MR; ++i) {
+                    out[k * MR + i] = i < rows ? a(rowBegin + panel + i, kBegin + k) : T{0};
+                }
+            }
+        }
+    }
+}
+
+template<typename T, typename Src>
+inline static void packB(const Src& b, const Index kBegin, const Index colBegin, const Size kc, const Size nc, T* out) {
+    constexpr Size NR   = Blocking<T>::NR;
+    const bool byColumn = rowMajor(b);
+    for (Index panel = 0; panel < nc; panel += NR, out += NR * kc) {
+        const Size cols = std::min(NR, nc - panel);
+        if (byColumn) {
+            for (Index k = 0; k < kc; ++k) {
+                for (Index j = 0; j < NR; ++j) {
+                    out[k * NR + j] = j < cols ? b(kBegin + k, colBegin + panel + j) : T{0};
+                }
+            }
+        } else {
+            for (Index j = 0; j < NR; ++j) {
+                for (Index k = 0; k < kc; ++k) {
+                    out[k * NR + j] = j < cols ? b(kBegin + k, colBegin + panel + j) : T{0};
+                }
+            }
+        }
+    }
+}
+
+template<typename T>
+inline static void microKernel(const Size kc,
+                               const T* a,
+                               const T* b,
+                               T* c,
+                               const Index ldc,
+                               const Size mr,
+                               const Size nr,
+                               const bool accumulate) {
+    constexpr Size MR = Blocking<T>::MR;
+    constexpr Size NR = Blocking<T>::NR;
+
+    T acc[MR][NR] = {};
+    for (Index k = 0; k < kc; ++k) {
+        for (Index i = 0; i < MR; ++i) {
+            const T av = a[i];
+            for (Index j = 0; j < NR; ++j) {
+                acc[i][j] += av * b[j];
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    if (mr == MR && nr == NR) [[likely]] {
+        for (Index i = 0; i < MR; ++i) {
+            T* row = c + i * ldc;
+            for (Index j = 0; j < NR; ++j) {
+                row[j] = accumulate ? row[j] + acc[i][j] : acc[i][j];
+            }
+        }
+    } else {
+        for (Index i = 0; i < mr; ++i) {
+            T* row = c + i * ldc;
+            for (Index j = 0; j < nr; ++j) {
+                row[j] = accumulate ? row[j] + acc[i][j] : acc[i][j];
+            }
+        }
+    }
+}
+
+template<typename T, typename ASrc, typename BSrc>
+inline static void smallProduct(const ASrc& a,
+                                const BSrc& b,
+                                const Size depth,
+                                T* c,
+                                const Index ldc,
+                                const Index rowBegin,
+                                const Index rowEnd,
+                                const Index colBegin,
+                                const Index colEnd) {
+    for (Index row = rowBegin; row < rowEnd; ++row) {
+        T* cRow = c + row * ldc;
+        for (Index col = colBegin; col < colEnd; ++col) {
+            cRow[col] = T{0};
+        }
+        for (Index k = 0; k < depth; ++k) {
+            const T av = a(row, k);
+            for (Index col = colBegin; col < colEnd; ++col) {
+                cRow[col] += av * b(k, col);
+            }
+        }
+    }
+}
+
+// Computes C[rowBegin:rowEnd, colBegin:colEnd] = A[rowBegin:rowEnd, :] * B[:, colBegin:colEnd]
+// with C addressed as c[row * ldc + col]. The target block is overwritten, not accumulated into.
+template<typename T, typename ASrc, typename BSrc>
+inline static void multiply(const ASrc& a,
+                            const BSrc& b,
+                            const Size depth,
+                            T* c,
+                            const Index ldc,
+                            const Index rowBegin,
+                            const Index rowEnd,
+                            const Index colBegin,
+                            const Index colEnd) {
+    using B         = Blocking<T>;
+    const Size rows = rowEnd - rowBegin;
+    const Size cols = colEnd - colBegin;
+    if (rows <= 0 || cols <= 0) {
+        return;
+    }
+    if (depth == 0 || static_cast<int64_t>(rows) * cols * depth <= B::SMALL_PRODUCT) {
+        smallProduct(a, b, depth, c, ldc, rowBegin, rowEnd, colBegin, colEnd);
+        return;
+    }
+
+    auto& workspace = Workspace<T>::local();
+    workspace.reserve(std::min(B::MC, roundUp(rows, B::MR)) * std::min(B::KC, depth),
+                      std::min(B::KC, depth) * std::min(B::NC, roundUp(cols, B::NR)));
+    T* packedA = workspace.packedA.begin();
+    T* packedB = workspace.packedB.begin();
+
+    for (Index jc = colBegin; jc < colEnd; jc += B::NC) {
+        const Size nc = std::min(B::NC, colEnd - jc);
+        for (Index pc = 0; pc < depth; pc += B::KC) {
+            const Size kc         = std::min(B::KC, depth - pc);
+            const bool accumulate = pc != 0;
+            packB(b, pc, jc, kc, nc, packedB);
+
+            for (Index ic = rowBegin; ic < rowEnd; ic += B::MC) {
+                const Size mc = std::min(B::MC, rowEnd - ic);
+                packA(a, ic, pc, mc, kc, packedA);
+
+                for (Index jr = 0; jr < nc; jr += B::NR) {
+                    const Size nr = std::min(B::NR, nc - jr);
+                    for (Index ir = 0; ir < mc; ir += B::MR) {
+                        const Size mr = std::min(B::MR, mc - ir);
+                        microKernel(kc,
+                                    packedA + ir * kc,
+                                    packedB + jr * kc,
+                                    c + (ic + ir) * ldc + jc + jr,
+                                    ldc,
+                                    mr,
+                                    nr,
+                                    accumulate);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Same contract as multiply, but the target block is split into row and column blocks
+// that are computed on the thread pool. Each block packs into its thread's own workspace.
+template<typename T, typename ASrc, typename BSrc>
+inline static void multiplyParallel(const ASrc& a,
+                                    const BSrc& b,
+                                    const Size depth,
+                                    T* c,
+                                    const Index ldc,
+                                    const Size rows,
+                                    const Size cols,
+                                    Size threadCount) {
+    using B = Blocking<T>;
+    if (threadCount <= 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    const double work = static_cast<double>(rows) * static_cast<double>(cols) * static_cast<double>(depth);
+    threadCount       = static_cast<Size>(
+        std::min<double>(threadCount, std::max(1.0, work / static_cast<double>(B::PARALLEL_PRODUCT_PER_THREAD))));
+    if (threadCount <= 1) {
+        multiply(a, b, depth, c, ldc, 0, rows, 0, cols);
+        return;
+    }
+
+    const Size targetTasks   = threadCount * 4;
+    const Size rowTiles      = (rows + B::MR - 1) / B::MR;
+    const Size colTiles      = (cols + B::NR - 1) / B::NR;
+    const Size rowBlockCount = std::min(rowTiles, targetTasks);
+    const Size colBlockCount = std::min(colTiles, (targetTasks + rowBlockCount - 1) / rowBlockCount);
+    const Size rowBlock      = ((rowTiles + rowBlockCount - 1) / rowBlockCount) * B::MR;
+    const Size colBlock      = ((colTiles + colBlockCount - 1) / colBlockCount) * B::NR;
+
+    parallelRun(
+        rowBlockCount * colBlockCount,
+        [&](const Index task) {
+            const Index rowBegin = (task / colBlockCount) * rowBlock;
+            const Index colBegin = (task % colBlockCount) * colBlock;
+            multiply(a,
+                     b,
+                     depth,
+                     c,
+                     ldc,
+                     rowBegin,
+                     std::min(rows, rowBegin + rowBlock),
+                     colBegin,
+                     std::min(cols, colBegin + colBlock));
+        },
+        threadCount);
+}
+
+}  // namespace nykdtb::nda::gemm
+
+#endif
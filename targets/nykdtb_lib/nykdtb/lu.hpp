@@ -0,0 +1,225 @@
+#ifndef NYKDTB_LU_HPP
+#define NYKDTB_LU_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "nykdtb/gemm.hpp"
+#include "nykdtb/psvector.hpp"
+#include "nykdtb/types.hpp"
+
+namespace nykdtb::nda::lu {
+
+// Kernels on dense row-major n x n matrices addressed as a[row * lda + col]
+
+template<typename T>
+struct Blocking {
+    // Width of the column panel that is factorized before the trailing matrix is updated
+    static constexpr Size NB = 32;
+    // Rows of a triangular solve handled by the substitution loop, the rest goes through gemm
+    static constexpr Size SOLVE_NB = 64;
+};
+
+template<typename T>
+struct Workspace {
+    PSVec<T, 1, 64> factors;
+    PSVec<Index, 1> pivots;
+    PSVec<T, 1, 64> scratch;
+
+    inline void reserve(const Size n) {
+        if (factors.size() < n * n) {
+            factors.resize(n * n);
+        }
+        if (pivots.size() < n) {
+            pivots.resize(n);
+        }
+    }
+
+    static inline Workspace& local() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+};
+
+// Subtracts row src scaled by factor from row dst over columns [begin, end)
+template<typename T>
+inline static void axpyRow(T* dst, const T* src, const T factor, const Index begin, const Index end) {
+    for (Index j = begin; j < end; ++j) {
+        dst[j] -= factor * src[j];
+    }
+}
+
+// In-place LU with partial pivoting: P * A = L * U, L unit lower triangular. Row k was swapped with
+// row pivots[k] at step k. Returns false if a pivot is exactly zero, i.e. the matrix is singular.
+template<typename T>
+inline static bool factorize(T* a, const Index lda, const Size n, Index* pivots) {
+    constexpr Size NB = Blocking<T>::NB;
+
+    for (Index k0 = 0; k0 < n; k0 += NB) {
+        const Index k1 = std::min<Index>(n, k0 + NB);
+
+        // Unblocked factorization of the panel a[k0:n, k0:k1]; row swaps span the full width
+        for (Index k = k0; k < k1; ++k) {
+            Index pivot = k;
+            for (Index i = k + 1; i < n; ++i) {
+                if (std::abs(a[i * lda + k]) > std::abs(a[pivot * lda + k])) {
+                    pivot = i;
+                }
+            }
+            pivots[k] = pivot;
+            if (a[pivot * lda + k] == T{0}) {
+                return false;
+            }
+            if (pivot != k) {
+                std::swap_ranges(a + k * lda, a + k * lda + n, a + pivot * lda);
+            }
+
+            const T* rowK   = a + k * lda;
+            const T inverse = T{1} / rowK[k];
+            for (Index i = k + 1; i < n; ++i) {
+                T* rowI = a + i * lda;
+                rowI[k] *= inverse;
+                axpyRow(rowI, rowK, rowI[k], k + 1, k1);
+            }
+        }
+
+        // U12 = L11^-1 * A12
+        for (Index k = k0; k < k1; ++k) {
+            for (Index i = k + 1; i < k1; ++i) {
+                axpyRow(a + i * lda, a + k * lda, a[i * lda + k], k1, n);
+            }
+        }
+
+        // A22 -= L21 * U12
+        for (Index i = k1; i < n; ++i) {
+            T* rowI = a + i * lda;
+            for (Index k = k0; k < k1; ++k) {
+                axpyRow(rowI, a + k * lda, rowI[k], k1, n);
+            }
+        }
+    }
+    return true;
+}
+
+// Determinant from the factors: the product of the diagonal of U, negated for every row swap
+template<typename T>
+inline static T determinant(const T* lu, const Index lda, const Index* pivots, const Size n) {
+    T result = T{1};
+    for (Index i = 0; i < n; ++i) {
+        result *= pivots[i] == i ? lu[i * lda + i] : -lu[i * lda + i];
+    }
+    return result;
+}
+
+// b = P * b for the k columns of b
+template<typename T>
+inline static void permuteRows(const Index* pivots, const Size n, T* b, const Index ldb, const Size k) {
+    for (Index i = 0; i < n; ++i) {
+        if (pivots[i] != i) {
+            std::swap_ranges(b + i * ldb, b + i * ldb + k, b + pivots[i] * ldb);
+        }
+    }
+}
+
+// Substitution on rows [begin, end) of b, assuming the contributions of all other solved rows have
+// already been subtracted. a(i, j) reads the triangle, which lies below the diagonal if lower.
+template<typename T>
+inline static void substituteBlock(const gemm::StridedSource<T>& a,
+                                   const bool lower,
+                                   const bool unitDiagonal,
+                                   const Index begin,
+                                   const Index end,
+                                   T* b,
+                                   const Index ldb,
+                                   const Size k) {
+    const Size count = end - begin;
+    for (Index step = 0; step < count; ++step) {
+        const Index i    = lower ? begin + step : end - 1 - step;
+        T* rowI          = b + i * ldb;
+        const Index from = lower ? begin : i + 1;
+        const Index to   = lower ? i : end;
+        for (Index j = from; j < to; ++j) {
+            axpyRow(rowI, b + j * ldb, a(i, j), 0, k);
+        }
+        if (!unitDiagonal) {
+            const T diagonal = a(i, i);
+            for (Index c = 0; c < k; ++c) {
+                rowI[c] /= diagonal;
+            }
+        }
+    }
+}
+
+// b = A^-1 * b for the n x k right-hand sides in b, A being the lower or upper triangle read through
+// a. Rows are solved in blocks: the contribution of the already solved blocks is subtracted with one
+// gemm product per block, only the diagonal block is done by substitution.
+template<typename T>
+inline static void solveTriangular(const gemm::StridedSource<T>& a,
+                                   const Size n,
+                                   const bool lower,
+                                   const bool unitDiagonal,
+                                   T* b,
+                                   const Index ldb,
+                                   const Size k,
+                                   PSVec<T, 1, 64>& scratch) {
+    constexpr Size NB = Blocking<T>::SOLVE_NB;
+    if (scratch.size() < NB * k) {
+        scratch.resize(NB * k);
+    }
+
+    for (Index block = 0; block < n; block += NB) {
+        const Index begin = lower ? block : std::max<Index>(0, n - block - NB);
+        const Index end   = lower ? std::min<Index>(n, block + NB) : n - block;
+        const Size rows   = end - begin;
+
+        const Index solvedBegin = lower ? 0 : end;
+        const Size solved       = lower ? begin : n - end;
+        if (solved > 0) {
+            const gemm::StridedSource<T> coefficients{
+                a.data + begin * a.rowStride + solvedBegin * a.colStride, a.rowStride, a.colStride};
+            const gemm::StridedSource<T> solution{b + solvedBegin * ldb, ldb, 1};
+            gemm::multiply(coefficients, solution, solved, scratch.begin(), k, 0, rows, 0, k);
+            for (Index i = 0; i < rows; ++i) {
+                axpyRow(b + (begin + i) * ldb, scratch.begin() + i * k, T{1}, 0, k);
+            }
+        }
+        substituteBlock(a, lower, unitDiagonal, begin, end, b, ldb, k);
+    }
+}
+
+// b = A^-1 * b from the LU factors of A
+template<typename T>
+inline static void solve(const T* lu,
+                         const Index lda,
+                         const Index* pivots,
+                         const Size n,
+                         T* b,
+                         const Index ldb,
+                         const Size k,
+                         PSVec<T, 1, 64>& scratch) {
+    const gemm::StridedSource<T> factors{lu, lda, 1};
+    permuteRows(pivots, n, b, ldb, k);
+    solveTriangular(factors, n, true, true, b, ldb, k, scratch);
+    solveTriangular(factors, n, false, false, b, ldb, k, scratch);
+}
+
+// out = A^-1 from the factors of A, out is addressed with row stride ldo
+template<typename T>
+inline static void invert(const T* lu,
+                          const Index lda,
+                          const Index* pivots,
+                          const Size n,
+                          T* out,
+                          const Index ldo,
+                          PSVec<T, 1, 64>& scratch) {
+    for (Index i = 0; i < n; ++i) {
+        std::fill(out + i * ldo, out + i * ldo + n, T{0});
+        out[i * ldo + i] = T{1};
+    }
+    solve(lu, lda, pivots, n, out, ldo, n, scratch);
+}
+
+}  // namespace nykdtb::nda::lu
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef NYKDTB_MAPPED_HPP
+#define NYKDTB_MAPPED_HPP
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/types.hpp"
+
+namespace nykdtb {
+
+enum class MapMode {
+    ReadOnly,
+    // Writes go to the file and are visible to other mappings of it
+    ReadWrite,
+    // Writes stay private to the mapping and never reach the file
+    CopyOnWrite,
+};
+
+// Access pattern hints passed on to madvise
+enum class MapAdvice {
+    Normal,
+    Sequential,
+    Random,
+    WillNeed,
+    // Drops the pages, a CopyOnWrite mapping loses its changes in them
+    DontNeed,
+};
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(MappingFailed, RuntimeException)
+
+// A whole file mapped into memory. Pages are read from the file when first touched and written back by
+// the kernel, or explicitly by sync().
+class MappedFile {
+public:
+    static constexpr std::size_t WHOLE = std::numeric_limits<std::size_t>::max();
+
+public:
+    MappedFile();
+    MappedFile(const std::string& path, MapMode mode);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other);
+    MappedFile& operator=(MappedFile&& other);
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Creates the file at path, or truncates it, with size zero bytes and maps it ReadWrite
+    static MappedFile create(const std::string& path, std::size_t size);
+
+    std::byte* data() { return m_data; }
+    const std::byte* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    MapMode mode() const { return m_mode; }
+
+    // Hint for the bytes [offset, offset + length), rounded out to whole pages
+    void advise(MapAdvice advice, std::size_t offset = 0, std::size_t length = WHOLE) const;
+    // Writes the modified pages back and waits until they are on disk. A no-op unless mapped ReadWrite.
+    void sync() const;
+
+private:
+    void release();
+
+private:
+    int m_fd;
+    std::byte* m_data;
+    std::size_t m_size;
+    MapMode m_mode;
+};
+
+// Array whose elements live in a mapped file, starting offset bytes into it, in row-major order. Mutable
+// element types need a ReadWrite or CopyOnWrite mapping, read-only access is NDArrayMapped<const T>.
+// Operations producing new arrays return the heap allocated MaterialType.
+template<typename T, typename Params = DefaultNDArrayParams>
+class NDArrayMapped {
+public:
+    using Type          = T;
+    using MaterialType  = NDArrayBase<std::remove_const_t<T>, Params>;
+    using Shape         = typename MaterialType::Shape;
+    using Strides       = typename MaterialType::Strides;
+    using Position      = typename MaterialType::Position;
+    using SliceShape    = typename MaterialType::SliceShape;
+    using Parameters    = Params;
+    using Iterator      = Type*;
+    using ConstIterator = const Type*;
+
+    static constexpr bool isReadOnly     = std::is_const_v<T>;
+    static constexpr MapMode defaultMode = isReadOnly ? MapMode::ReadOnly : MapMode::ReadWrite;
+
+    NYKDTB_DEFINE_EXCEPTION_CLASS(InvalidMapping, LogicException)
+
+public:
+    NDArrayMapped(const std::string& path, Shape shape, std::size_t offset = 0, MapMode mode = defaultMode)
+        : NDArrayMapped(MappedFile(path, mode), mmove(shape), offset) {}
+
+    NDArrayMapped(MappedFile file, Shape shape, std::size_t offset = 0)
+        : m_file(mmove(file)),
+          m_data(nullptr),
+          m_shape(mmove(shape)),
+          m_strides(NDArrayCalc::calculateStrides<Strides, Shape>(m_shape)) {
+        if (!isReadOnly && m_file.mode() == MapMode::ReadOnly) {
+            throw InvalidMapping("Mutable elements need a writable mapping");
+        }
+        if (offset % alignof(T) != 0) {
+            throw InvalidMapping("Offset is not aligned for the element type");
+        }
+        if (offset + static_cast<std::size_t>(size()) * sizeof(T) > m_file.size()) {
+            throw InvalidMapping("File is smaller than the array");
+        }
+        m_data = reinterpret_cast<T*>(m_file.data() + offset);
+    }
+
+    // Creates the file at path, or truncates it, to hold a zero filled array of shape
+    static NDArrayMapped create(const std::string& path, Shape shape)
+        requires(!isReadOnly)
+    {
+        const auto bytes = static_cast<std::size_t>(NDArrayCalc::shapeSize(shape)) * sizeof(T);
+        return {MappedFile::create(path, bytes), mmove(shape)};
+    }
+
+    static MaterialType zeros(Shape shape) { return MaterialType::zeros(mmove(shape)); }
+    static MaterialType filled(Shape shape, std::remove_const_t<T> init) {
+        return MaterialType::filled(mmove(shape), mmove(init));
+    }
+
+    NDArrayMapped(NDArrayMapped&&)            = default;
+    NDArrayMapped& operator=(NDArrayMapped&&) = default;
+
+    MaterialType clone() const { return {begin(), end(), m_shape}; }
+
+    const MappedFile& file() const { return m_file; }
+    void advise(const MapAdvice advice) const {
+        m_file.advise(advice, reinterpret_cast<const std::byte*>(m_data) - m_file.data(), size() * sizeof(T));
+    }
+    void sync() const { m_file.sync(); }
+
+    bool empty() const { return size() == 0; }
+    const Shape& shape() const { return m_shape; }
+    Size shape(const Index idx) const { return m_shape[idx]; }
+    const Strides& strides() const { return m_strides; }
+    Size stride(const Index idx) const { return m_strides[idx]; }
+    Size size() const { return NDArrayCalc::shapeSize(m_shape); }
+
+    Iterator begin() { return m_data; }
+    ConstIterator begin() const { return m_data; }
+    Iterator end() { return m_data + size(); }
+    ConstIterator end() const { return m_data + size(); }
+
+    T& operator[](Index index) { return m_data[index]; }
+    const T& operator[](Index index) const { return m_data[index]; }
+    T& operator[](std::initializer_list<Index> indices) {
+        return m_data[NDArrayCalc::calculateRawIndexUnchecked(m_strides, mmove(indices))];
+    }
+    const T& operator[](std::initializer_list<Index> indices) const {
+        return m_data[NDArrayCalc::calculateRawIndexUnchecked(m_strides, mmove(indices))];
+    }
+    T& operator[](const Position& pos) { return m_data[NDArrayCalc::calculateRawIndexUnchecked(m_strides, pos)]; }
+    const T& operator[](const Position& pos) const {
+        return m_data[NDArrayCalc::calculateRawIndexUnchecked(m_strides, pos)];
+    }
+
+private:
+    MappedFile m_file;
+    T* m_data;
+    Shape m_shape;
+    Strides m_strides;
+};
+
+}  // namespace nykdtb
+
+#endif
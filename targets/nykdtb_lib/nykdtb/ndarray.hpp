@@ -1,6 +1,7 @@
 #ifndef NYKDTB_NDARRAY_HPP
 #define NYKDTB_NDARRAY_HPP
 
+#include <algorithm>
 #include <variant>
 
 #include "nykdtb/psvector.hpp"
@@ -66,6 +67,90 @@ struct NDArrayCalc {
         return true;
     }
 
+    template<typename LHS, typename RHS>
+    static constexpr bool equalShapes(const LHS& lhs, const RHS& rhs) {
+        if (static_cast<Size>(lhs.size()) != static_cast<Size>(rhs.size())) {
+            return false;
+        }
+        for (Index i = 0; i < static_cast<Size>(lhs.size()); ++i) {
+            if (lhs[i] != rhs[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // NumPy broadcasting: shapes are aligned on their trailing dimension, and a dimension of size 1
+    // (or a missing leading dimension) stretches to the size of the other operand.
+    template<typename ShapeType, typename LHS, typename RHS>
+    static Optional<ShapeType> broadcastShape(const LHS& lhs, const RHS& rhs) {
+        const Size lhsRank = static_cast<Size>(lhs.size());
+        const Size rhsRank = static_cast<Size>(rhs.size());
+        const Size rank    = std::max(lhsRank, rhsRank);
+
+        ShapeType result;
+        result.resize(rank, 1);
+        for (Index i = 0; i < rank; ++i) {
+            const Index lhsDim = i - (rank - lhsRank);
+            const Index rhsDim = i - (rank - rhsRank);
+            const Size lhsSize = lhsDim < 0 ? 1 : lhs[lhsDim];
+            const Size rhsSize = rhsDim < 0 ? 1 : rhs[rhsDim];
+            if (lhsSize != rhsSize && lhsSize != 1 && rhsSize != 1) {
+                return nullopt;
+            }
+            result[i] = lhsSize == 1 ? rhsSize : lhsSize;
+        }
+        return result;
+    }
+
+    template<typename OperandShape, typename TargetShape>
+    static constexpr bool isBroadcastableTo(const OperandShape& operand, const TargetShape& target) {
+        const Size operandRank = static_cast<Size>(operand.size());
+        const Size targetRank  = static_cast<Size>(target.size());
+        if (operandRank > targetRank) {
+            return false;
+        }
+        for (Index i = 0; i < operandRank; ++i) {
+            const Size operandSize = operand[i];
+            const Size targetSize  = target[i + targetRank - operandRank];
+            if (operandSize != targetSize && operandSize != 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Strides to walk operand in the index space of target. Broadcast dimensions get stride 0.
+    template<typename StridesType, typename OperandShape, typename TargetShape>
+    static StridesType broadcastStrides(const OperandShape& operand, const TargetShape& target) {
+        const Size operandRank = static_cast<Size>(operand.size());
+        const Size targetRank  = static_cast<Size>(target.size());
+
+        StridesType result;
+        result.resize(targetRank, 0);
+        Size stride = 1;
+        for (Index i = operandRank - 1; i >= 0; --i) {
+            const Index targetDim = i + targetRank - operandRank;
+            result[targetDim]     = (operand[i] == 1 && target[targetDim] != 1) ? 0 : stride;
+            stride *= operand[i];
+        }
+        return result;
+    }
+
+    template<typename ShapeType, typename SourceShape>
+    static ShapeType convertShape(const SourceShape& source) {
+        if constexpr (DynamicStorage<ShapeType>) {
+            return ShapeType(source.begin(), source.end());
+        } else {
+            ShapeType result;
+            if (static_cast<Size>(result.size()) != static_cast<Size>(source.size())) {
+                throw SizesMismatch();
+            }
+            std::copy(source.begin(), source.end(), result.begin());
+            return result;
+        }
+    }
+
     template<typename ShapeType>
     static constexpr Size shapeSize(const ShapeType& lhs) {
         Size result = 1;
@@ -90,7 +175,7 @@ struct NDArrayCalc {
         }
         result.fill(init);
         return mmove(result);
-    };
+    }
 };
 
 template<typename T>
@@ -148,6 +233,21 @@ concept NDArrayLike = requires(T a) {
     { a.end() } -> std::same_as<typename T::ConstIterator>;
 };
 
+// Arrays whose elements live in one dense block in logical order, iterated through raw pointers
+template<typename T>
+concept ContiguousNDArray = NDArrayLike<T> && std::is_pointer_v<typename T::ConstIterator>;
+
+// Material array of the given shape for callers that overwrite every element. The elements are left
+// uninitialized when the array type supports it, zeroed otherwise.
+template<typename Mx>
+inline static Mx uninitializedArray(typename Mx::Shape shape) {
+    if constexpr (requires { Mx::uninitialized(shape); }) {
+        return Mx::uninitialized(mmove(shape));
+    } else {
+        return Mx::zeros(mmove(shape));
+    }
+}
+
 template<Size SIZE, Size... Sizes>
 struct NDArrayStaticParams {
     using Lower                               = NDArrayStaticParams<Sizes...>;
@@ -185,20 +285,20 @@ public:
     NYKDTB_DEFINE_EXCEPTION_CLASS(ShapeDoesNotMatchStaticShape, LogicException)
 
 public:
-    NDArrayStatic() = default;
-    NDArrayStatic(std::initializer_list<Type> input) { std::copy(input.begin(), input.end(), begin()); }
-    NDArrayStatic(std::initializer_list<Type> input, Shape shape) {
+    constexpr NDArrayStatic() = default;
+    constexpr NDArrayStatic(std::initializer_list<Type> input) { std::copy(input.begin(), input.end(), begin()); }
+    constexpr NDArrayStatic(std::initializer_list<Type> input, Shape shape) {
         if (shape != Meta::shape) {
             throw ShapeDoesNotMatchStaticShape();
         }
         std::copy(input.begin(), input.end(), begin());
     }
     template<typename Iter>
-    NDArrayStatic(Iter _begin, Iter _end) {
+    constexpr NDArrayStatic(Iter _begin, Iter _end) {
         std::copy(_begin, _end, begin());
     }
     template<typename Iter>
-    NDArrayStatic(Iter _begin, Iter _end, Shape shape) {
+    constexpr NDArrayStatic(Iter _begin, Iter _end, Shape shape) {
         if (shape != Meta::shape) {
             throw ShapeDoesNotMatchStaticShape();
         }
@@ -266,6 +366,56 @@ struct DefaultNDArrayParams {
     static constexpr Size STACK_SIZE        = 8;
     static constexpr Size SHAPE_STACK_SIZE  = 4;
     static constexpr Size STORAGE_ALIGNMENT = 256;
+    using Allocator                         = MallocAllocator;
+};
+
+// Allocator policy of the element storage, Params without an Allocator member use the global heap
+template<typename Params>
+struct ParamsAllocator {
+    using Type = MallocAllocator;
+};
+
+template<typename Params>
+    requires requires { typename Params::Allocator; }
+struct ParamsAllocator<Params> {
+    using Type = typename Params::Allocator;
+};
+
+// Walks the positions of a target shape in row-major order and tracks the matching logical index
+// of a broadcast operand. Broadcast dimensions have stride 0, so nothing is materialized.
+class BroadcastWalker {
+public:
+    using Dims = PSVec<Size, DefaultNDArrayParams::SHAPE_STACK_SIZE>;
+
+public:
+    BroadcastWalker()
+        : m_offset(0) {}
+
+    template<typename OperandShape, typename TargetShape>
+    BroadcastWalker(const OperandShape& operand, const TargetShape& target)
+        : m_extents(target.begin(), target.end()),
+          m_strides(NDArrayCalc::broadcastStrides<Dims>(operand, target)),
+          m_position(NDArrayCalc::constructFilled<Dims>(static_cast<Size>(target.size()), 0)),
+          m_offset(0) {}
+
+    inline Index offset() const { return m_offset; }
+
+    inline void next() {
+        for (Index i = m_extents.size() - 1; i >= 0; --i) {
+            m_offset += m_strides[i];
+            if (++m_position[i] < m_extents[i]) [[likely]] {
+                return;
+            }
+            m_offset -= m_strides[i] * m_extents[i];
+            m_position[i] = 0;
+        }
+    }
+
+private:
+    Dims m_extents;
+    Dims m_strides;
+    Dims m_position;
+    Index m_offset;
 };
 
 template<typename T, typename Params>
@@ -276,7 +426,8 @@ public:
     using Shape         = PSVec<Size, Params::SHAPE_STACK_SIZE>;
     using Strides       = PSVec<Size, Params::SHAPE_STACK_SIZE>;
     using Position      = PSVec<Index, Params::SHAPE_STACK_SIZE>;
-    using Storage       = PSVec<T, Params::STACK_SIZE, Params::STORAGE_ALIGNMENT>;
+    using Allocator     = typename ParamsAllocator<Params>::Type;
+    using Storage       = PSVec<T, Params::STACK_SIZE, Params::STORAGE_ALIGNMENT, Allocator>;
     using SliceShape    = PSVec<IndexRange, Params::SHAPE_STACK_SIZE>;
     using Parameters    = Params;
     using Iterator      = Type*;
@@ -332,11 +483,21 @@ public:
     }
 
     static NDArrayBase zeros(Shape shape) {
-        return {Storage::constructFilled(NDArrayCalc::shapeSize(shape), 0), shape};
+        if constexpr (std::is_arithmetic_v<T>) {
+            return {Storage::constructZeroed(NDArrayCalc::shapeSize(shape)), shape};
+        } else {
+            return {Storage::constructFilled(NDArrayCalc::shapeSize(shape), 0), shape};
+        }
     }
     static NDArrayBase filled(Shape shape, T input) {
         return {Storage::constructFilled(NDArrayCalc::shapeSize(shape), mmove(input)), shape};
     }
+    // Elements are left uninitialized, for callers that overwrite all of them
+    static NDArrayBase uninitialized(Shape shape)
+        requires(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>)
+    {
+        return {Storage::constructUninitialized(NDArrayCalc::shapeSize(shape)), shape};
+    }
 
     NDArrayBase(NDArrayBase&&)            = default;
     NDArrayBase& operator=(NDArrayBase&&) = default;
@@ -385,6 +546,15 @@ public:
         m_strides = NDArrayCalc::calculateStrides<Strides, Shape>(m_shape);
     }
 
+    // Same as resize, but the elements added are left uninitialized
+    void resizeUninitialized(Shape newShape)
+        requires(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>)
+    {
+        m_storage.resizeUninitialized(NDArrayCalc::shapeSize(newShape));
+        m_shape   = mmove(newShape);
+        m_strides = NDArrayCalc::calculateStrides<Strides, Shape>(m_shape);
+    }
+
 private:
     NDArrayBase(const NDArrayBase&)            = default;
     NDArrayBase& operator=(const NDArrayBase&) = delete;
@@ -395,11 +565,92 @@ private:
     Strides m_strides;
 };
 
+// Walks a view of an array in row-major order of the view's shape. View grants access to the viewed
+// array m_ndarray and to elementStrides(), the distance in the viewed array between neighbouring
+// elements of each view dimension, so a step is one addition in the common case.
+template<typename View>
+class StridedViewIterator {
+public:
+    enum EndPlacement { End };
+
+    using Type      = typename View::Type;
+    using MutType   = std::conditional_t<View::isConstArray, std::add_const_t<Type>, Type>;
+    using ConstType = const Type;
+    using Position  = typename View::Position;
+
+    using difference_type   = Size;
+    using value_type        = MutType;
+    using reference         = MutType&;
+    using iterator_category = std::forward_iterator_tag;
+
+public:
+    StridedViewIterator(View& view)
+        : m_view(view),
+          m_pos{NDArrayCalc::constructFilled<Position>(m_view.shape().size(), 0)},
+          m_rawIndex{m_view.calculateRawIndexFromPositionUnchecked(m_pos)},
+          m_index{0} {}
+    StridedViewIterator(View& view, EndPlacement)
+        : m_view(view),
+          m_pos{NDArrayCalc::constructFilled<Position>(m_view.shape().size(), 0)},
+          m_rawIndex{},
+          m_index{m_view.size()} {
+        m_pos[0]   = m_view.shape(0);
+        m_rawIndex = m_view.calculateRawIndexFromPositionUnchecked(m_pos);
+    }
+
+    StridedViewIterator& operator++() {
+        advanceOne();
+        return *this;
+    }
+
+    StridedViewIterator operator++(int) {
+        StridedViewIterator copy(*this);
+        advanceOne();
+        return mmove(copy);
+    }
+
+    MutType& operator*() { return m_view.m_ndarray[m_rawIndex]; }
+    ConstType& operator*() const { return m_view.m_ndarray[m_rawIndex]; }
+    MutType* operator->() { return &m_view.m_ndarray[m_rawIndex]; }
+    ConstType* operator->() const { return &m_view.m_ndarray[m_rawIndex]; }
+
+    // Iterators are ordered by their position in the view, as a negative step walks the array backwards
+    bool operator==(const StridedViewIterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const StridedViewIterator& other) const { return m_index != other.m_index; }
+    bool operator<(const StridedViewIterator& other) const { return m_index < other.m_index; }
+    bool operator<=(const StridedViewIterator& other) const { return m_index <= other.m_index; }
+
+    Size operator-(const StridedViewIterator& other) const { return m_index - other.m_index; }
+
+private:
+    void advanceOne() {
+        ++m_index;
+        const auto& elementStrides = m_view.elementStrides();
+        for (Index i = m_pos.size() - 1; i >= 0; --i) {
+            m_rawIndex += elementStrides[i];
+            if (++m_pos[i] < m_view.shape(i)) [[likely]] {
+                return;
+            }
+            if (i == 0) [[unlikely]] {
+                return;
+            }
+            m_rawIndex -= elementStrides[i] * m_view.shape(i);
+            m_pos[i] = 0;
+        }
+    }
+
+private:
+    View& m_view;
+    Position m_pos;
+    Index m_rawIndex;
+    Index m_index;
+};
+
 template<NDArrayLike NDT>
 class NDArraySlice {
 public:
     using NDArray      = NDT;
-    using MaterialType = std::remove_cvref_t<NDArray>;
+    using MaterialType = typename std::remove_cvref_t<NDArray>::MaterialType;
     using Type         = typename NDArray::Type;
     using SliceShape   = typename NDArray::SliceShape;
     using Shape        = typename NDArray::Shape;
@@ -410,25 +661,25 @@ public:
     using MutType                      = std::conditional_t<isConstArray, std::add_const_t<Type>, Type>;
     using ConstType                    = const std::remove_cvref_t<Type>;
 
-    template<typename T>
-    class IteratorBase;
-
-    using Iterator      = IteratorBase<NDArraySlice>;
-    using ConstIterator = IteratorBase<const std::remove_cvref_t<NDArraySlice>>;
+    using Iterator      = StridedViewIterator<NDArraySlice>;
+    using ConstIterator = StridedViewIterator<const std::remove_cvref_t<NDArraySlice>>;
 
     NYKDTB_DEFINE_EXCEPTION_CLASS(InvalidSliceShape, LogicException)
 
 public:
     NDArraySlice(NDArray& array, SliceShape shape)
         : m_ndarray{array},
-          m_sliceShape{mmove(shape)},
+          m_sliceShape{resolveSliceShape(m_ndarray.shape(), mmove(shape))},
           m_shape(calculateShape(m_ndarray.shape(), m_sliceShape)),
-          m_strides(NDArrayCalc::calculateStrides<Strides, Shape>(m_shape)) {}
+          m_strides(NDArrayCalc::calculateStrides<Strides, Shape>(m_shape)),
+          m_steppedStrides(calculateSteppedStrides(m_ndarray.strides(), m_sliceShape)) {}
 
     bool empty() const { return NDArrayCalc::shapeSize(m_shape); }
     const Shape& shape() const { return m_shape; }
     Size shape(const Index idx) const { return m_shape[idx]; }
     const SliceShape& sliceShape() const { return m_sliceShape; }
+    NDArray& array() { return m_ndarray; }
+    const NDArray& array() const { return m_ndarray; }
     const Strides& strides() const { return m_strides; }
     Size stride(const Index idx) const { return m_strides[idx]; }
     Size size() const { return NDArrayCalc::shapeSize(m_shape); }
@@ -477,6 +728,29 @@ public:
         return calculateRawIndexFromPositionUnchecked(m_ndarray.strides(), m_sliceShape, mmove(position));
     }
 
+    // Replaces open ends with the array extent so that ranges with negative steps know their first element
+    static constexpr SliceShape resolveSliceShape(const Shape& original, SliceShape sliceShape) {
+        if (original.size() != sliceShape.size()) {
+            throw InvalidSliceShape();
+        }
+        for (Index i = 0; i < static_cast<Size>(original.size()); ++i) {
+            if (sliceShape[i].step() == 0) {
+                throw InvalidSliceShape();
+            }
+            sliceShape[i] = sliceShape[i].resolved(original[i]);
+        }
+        return sliceShape;
+    }
+
+    // Distance in the underlying array between neighbouring slice elements of each dimension
+    static constexpr Strides calculateSteppedStrides(const Strides& arrayStrides, const SliceShape& sliceShape) {
+        Strides result(arrayStrides);
+        for (Index i = 0; i < static_cast<Size>(result.size()); ++i) {
+            result[i] *= sliceShape[i].step();
+        }
+        return result;
+    }
+
     static constexpr Shape calculateShape(const Shape& original, const SliceShape& sliceShape) {
         if (original.size() != sliceShape.size()) {
             throw InvalidSliceShape();
@@ -496,7 +770,7 @@ public:
                                                                   const Position& position) {
         Index result = 0;
         for (Index i = 0; i < static_cast<Size>(arrayStrides.size()); ++i) {
-            result += arrayStrides[i] * (sliceShape[i].begin() + position[i]);
+            result += arrayStrides[i] * sliceShape[i].at(position[i]);
         }
         return result;
     }
@@ -507,7 +781,7 @@ public:
         Index result = 0;
         Index i      = 0;
         for (const auto& pos : position) {
-            result += arrayStrides[i] * (sliceShape[i].begin() + pos);
+            result += arrayStrides[i] * sliceShape[i].at(pos);
             ++i;
         }
         return result;
@@ -521,108 +795,301 @@ public:
         for (Index i = 0; i < arrayStrides.size(); ++i) {
             const auto sliceStride = sliceStrides[i];
             const auto arrayStride = arrayStrides[i];
-            const auto arrayBegin  = sliceShape[i].begin();
             const Index dimStrides = index / sliceStride;
             index                  = index % sliceStride;
-            result += (dimStrides + arrayBegin) * arrayStride;
+            result += sliceShape[i].at(dimStrides) * arrayStride;
         }
         return result;
     }
 
+private:
+    template<typename>
+    friend class StridedViewIterator;
+
+    const Strides& elementStrides() const { return m_steppedStrides; }
+
 private:
     NDArray& m_ndarray;
     const SliceShape m_sliceShape;
     const Shape m_shape;
     const Strides m_strides;
+    const Strides m_steppedStrides;
+};
 
+template<NDArrayLike T>
+inline static NDArraySlice<T> slice(T& array, typename T::SliceShape shape) {
+    return {array, mmove(shape)};
+}
+
+// View of an NDArrayLike with its axes reordered: dimension i of the view is dimension axes[i] of
+// the viewed array. Like NDArraySlice, strides() describe the dense layout of the view's own shape,
+// while element access maps back into the viewed array without copying.
+template<NDArrayLike NDT>
+class NDArrayPermuted {
 public:
-    template<typename T>
-    class IteratorBase {
-    public:
-        enum EndPlacement { End };
-
-        using Type      = typename T::Type;
-        using MutType   = std::conditional_t<T::isConstArray, std::add_const_t<Type>, Type>;
-        using ConstType = const Type;
-        using Position  = typename T::Position;
-
-        using difference_type   = Size;
-        using value_type        = MutType;
-        using reference         = MutType&;
-        using iterator_category = std::forward_iterator_tag;
-
-    public:
-        IteratorBase(T& slice)
-            : m_slice(slice),
-              m_pos{NDArrayCalc::constructFilled<Position>(m_slice.shape().size(), 0)},
-              m_rawIndex{m_slice.calculateRawIndexFromPositionUnchecked(m_pos)} {}
-        IteratorBase(T& slice, EndPlacement)
-            : m_slice(slice), m_pos{NDArrayCalc::constructFilled<Position>(m_slice.shape().size(), 0)}, m_rawIndex{} {
-            m_pos[0]   = m_slice.shape(0);
-            m_rawIndex = m_slice.calculateRawIndexFromPositionUnchecked(m_pos);
-        }
-
-        IteratorBase& operator++() {
-            advanceOne();
-            return *this;
-        }
-
-        IteratorBase operator++(int) {
-            IteratorBase copy(*this);
-            advanceOne();
-            return mmove(copy);
-        }
-
-        MutType& operator*() { return m_slice.m_ndarray[m_rawIndex]; }
-        ConstType& operator*() const { return m_slice.m_ndarray[m_rawIndex]; }
-        MutType* operator->() { return &m_slice.m_ndarray[m_rawIndex]; }
-        ConstType* operator->() const { return &m_slice.m_ndarray[m_rawIndex]; }
-
-        bool operator==(const IteratorBase& other) const { return m_rawIndex == other.m_rawIndex; }
-        bool operator!=(const IteratorBase& other) const { return m_rawIndex != other.m_rawIndex; }
-        bool operator<(const IteratorBase& other) const { return m_rawIndex < other.m_rawIndex; }
-        bool operator<=(const IteratorBase& other) const { return m_rawIndex <= other.m_rawIndex; }
-
-        Size operator-(const IteratorBase& other) const {
-            auto selfIndex  = NDArrayCalc::calculateRawIndexUnchecked(m_slice.strides(), m_pos);
-            auto otherIndex = NDArrayCalc::calculateRawIndexUnchecked(other.m_slice.strides(), other.m_pos);
-            return selfIndex - otherIndex;
-        }
-
-    private:
-        void advanceOne() {
-            bool recalculateRaw = false;
-            for (Index i = m_pos.size() - 1; i >= 0; --i) {
-                if (++m_pos[i] >= m_slice.shape()[i]) [[unlikely]] {
-                    recalculateRaw = true;
-                    if (i != 0) [[likely]] {
-                        m_pos[i] = 0;
-                    }
-                } else [[likely]] {
-                    ++m_rawIndex;
-                    break;
-                }
-            }
-            if (recalculateRaw) [[unlikely]] {
-                m_rawIndex = m_slice.calculateRawIndexFromPositionUnchecked(m_pos);
+    using NDArray      = NDT;
+    using MaterialType = typename std::remove_cvref_t<NDArray>::MaterialType;
+    using Type         = typename NDArray::Type;
+    using SliceShape   = typename NDArray::SliceShape;
+    using Shape        = typename NDArray::Shape;
+    using Strides      = typename NDArray::Strides;
+    using Position     = typename NDArray::Position;
+    using Axes         = typename NDArray::Position;
+
+    static constexpr bool isConstArray = std::is_const_v<NDArray>;
+    using MutType                      = std::conditional_t<isConstArray, std::add_const_t<Type>, Type>;
+    using ConstType                    = const std::remove_cvref_t<Type>;
+
+    using Iterator      = StridedViewIterator<NDArrayPermuted>;
+    using ConstIterator = StridedViewIterator<const std::remove_cvref_t<NDArrayPermuted>>;
+
+    NYKDTB_DEFINE_EXCEPTION_CLASS(InvalidAxes, LogicException)
+
+public:
+    NDArrayPermuted(NDArray& array, Axes axes)
+        : m_ndarray{array},
+          m_axes{validateAxes(m_ndarray.shape(), mmove(axes))},
+          m_shape(permuteDims(m_ndarray.shape(), m_axes)),
+          m_strides(NDArrayCalc::calculateStrides<Strides, Shape>(m_shape)),
+          m_arrayStrides(permuteDims(m_ndarray.strides(), m_axes)) {}
+
+    bool empty() const { return NDArrayCalc::shapeSize(m_shape) == 0; }
+    const Shape& shape() const { return m_shape; }
+    Size shape(const Index idx) const { return m_shape[idx]; }
+    const Axes& axes() const { return m_axes; }
+    NDArray& array() { return m_ndarray; }
+    const NDArray& array() const { return m_ndarray; }
+    const Strides& strides() const { return m_strides; }
+    Size stride(const Index idx) const { return m_strides[idx]; }
+    Size size() const { return NDArrayCalc::shapeSize(m_shape); }
+
+    NDArrayBase<Type, DefaultNDArrayParams> materialize() const {
+        return {
+            begin(), end(), typename NDArrayBase<Type, DefaultNDArrayParams>::Shape{m_shape.begin(), m_shape.end()}};
+    }
+
+    static MaterialType filled(Shape shape, Type init) { return MaterialType::filled(mmove(shape), mmove(init)); }
+    static MaterialType zeros(Shape shape) { return MaterialType::zeros(mmove(shape)); }
+
+    Iterator begin() { return Iterator(*this); }
+    ConstIterator begin() const { return ConstIterator(*this); }
+    Iterator end() { return Iterator(*this, Iterator::End); }
+    ConstIterator end() const { return ConstIterator(*this, ConstIterator::End); }
+
+    MutType& operator[](const Index index) { return m_ndarray[calculateRawIndexFromIndex(index)]; }
+    ConstType& operator[](const Index index) const { return m_ndarray[calculateRawIndexFromIndex(index)]; }
+
+    MutType& operator[](std::initializer_list<Index> indices) {
+        return m_ndarray[NDArrayCalc::calculateRawIndexUnchecked(m_arrayStrides, mmove(indices))];
+    }
+    ConstType& operator[](std::initializer_list<Index> indices) const {
+        return m_ndarray[NDArrayCalc::calculateRawIndexUnchecked(m_arrayStrides, mmove(indices))];
+    }
+
+    MutType& operator[](const Position& position) {
+        return m_ndarray[NDArrayCalc::calculateRawIndexUnchecked(m_arrayStrides, position)];
+    }
+    ConstType& operator[](const Position& position) const {
+        return m_ndarray[NDArrayCalc::calculateRawIndexUnchecked(m_arrayStrides, position)];
+    }
+
+    Index calculateRawIndexFromPositionUnchecked(const Position& position) const {
+        return NDArrayCalc::calculateRawIndexUnchecked(m_arrayStrides, position);
+    }
+
+    Index calculateRawIndexFromIndex(Index index) const {
+        Index result = 0;
+        for (Index i = 0; i < static_cast<Size>(m_strides.size()); ++i) {
+            result += (index / m_strides[i]) * m_arrayStrides[i];
+            index = index % m_strides[i];
+        }
+        return result;
+    }
+
+    template<typename Dims>
+    static constexpr Dims permuteDims(const Dims& dims, const Axes& axes) {
+        Dims result(dims);
+        for (Index i = 0; i < static_cast<Size>(axes.size()); ++i) {
+            result[i] = dims[axes[i]];
+        }
+        return result;
+    }
+
+    static constexpr Axes validateAxes(const Shape& shape, Axes axes) {
+        const Size rank = static_cast<Size>(shape.size());
+        if (static_cast<Size>(axes.size()) != rank) {
+            throw InvalidAxes();
+        }
+        for (Index i = 0; i < rank; ++i) {
+            const auto previous = axes.begin() + i;
+            if (!betweenCO<Index>(0, axes[i], rank) || std::find(axes.begin(), previous, axes[i]) != previous) {
+                throw InvalidAxes();
             }
         }
+        return axes;
+    }
+
+private:
+    template<typename>
+    friend class StridedViewIterator;
 
-    private:
-        T & m_slice;
-        Position m_pos;
-        Index m_rawIndex;
-    };
+    const Strides& elementStrides() const { return m_arrayStrides; }
+
+private:
+    NDArray& m_ndarray;
+    const Axes m_axes;
+    const Shape m_shape;
+    const Strides m_strides;
+    const Strides m_arrayStrides;
 };
 
 template<NDArrayLike T>
-inline static NDArraySlice<T> slice(T& array, typename T::SliceShape shape) {
-    return {array, mmove(shape)};
+inline static NDArrayPermuted<T> permute(T& array, typename T::Position axes) {
+    return {array, mmove(axes)};
 }
 
 template<typename T>
 using NDArray = NDArrayBase<T, DefaultNDArrayParams>;
 
+// Raw memory view of an array: element (i0, i1, ...) lives at data[i0 * strides[0] + i1 * strides[1] + ...].
+// T is const qualified for read-only access.
+template<typename T>
+struct StridedLayout {
+    using Dims = PSVec<Size, DefaultNDArrayParams::SHAPE_STACK_SIZE>;
+
+    T* data;
+    Dims shape;
+    Dims strides;
+};
+
+template<typename A>
+    requires ContiguousNDArray<std::remove_const_t<A>>
+inline static auto stridedLayout(A& array) {
+    using Elem = std::remove_reference_t<decltype(*array.begin())>;
+    using Dims = typename StridedLayout<Elem>::Dims;
+    return StridedLayout<Elem>{array.begin(),
+                               Dims(array.shape().begin(), array.shape().end()),
+                               Dims(array.strides().begin(), array.strides().end())};
+}
+
+template<typename S>
+    requires requires(S& s) { stridedLayout(s.array()); s.sliceShape(); }
+inline static auto stridedLayout(S& slice) {
+    auto layout = stridedLayout(slice.array());
+    for (Index i = 0; i < static_cast<Size>(layout.shape.size()); ++i) {
+        layout.data += slice.sliceShape()[i].at(0) * layout.strides[i];
+        layout.strides[i] *= slice.sliceShape()[i].step();
+        layout.shape[i] = slice.shape(i);
+    }
+    return layout;
+}
+
+template<typename P>
+    requires requires(P& p) { stridedLayout(p.array()); p.axes(); }
+inline static auto stridedLayout(P& view) {
+    auto layout = stridedLayout(view.array());
+    auto source = layout;
+    for (Index i = 0; i < static_cast<Size>(layout.shape.size()); ++i) {
+        layout.shape[i]   = source.shape[view.axes()[i]];
+        layout.strides[i] = source.strides[view.axes()[i]];
+    }
+    return layout;
+}
+
+template<typename A>
+concept StridedAccessible = requires(A& a) { stridedLayout(a); };
+
+// Walks a strided layout as a sequence of runs. A run is the longest block of trailing dimensions
+// that is laid out with a single stride, so a dense array is one run and a slice of full rows is
+// one run per row block.
+template<typename T>
+class SpanWalker {
+public:
+    using Dims = typename StridedLayout<T>::Dims;
+
+public:
+    explicit SpanWalker(StridedLayout<T> layout)
+        : m_runBegin(layout.data), m_current(layout.data), m_runLength(1), m_runStride(1), m_remaining(1) {
+        Index inner = static_cast<Size>(layout.shape.size()) - 1;
+        if (inner >= 0) {
+            m_runLength = layout.shape[inner];
+            m_runStride = layout.strides[inner];
+            while (inner > 0 && layout.strides[inner - 1] == layout.strides[inner] * layout.shape[inner]) {
+                --inner;
+                m_runLength *= layout.shape[inner];
+            }
+            m_outerShape   = Dims(layout.shape.begin(), layout.shape.ptr(inner));
+            m_outerStrides = Dims(layout.strides.begin(), layout.strides.ptr(inner));
+            m_outerPos     = NDArrayCalc::constructFilled<Dims>(inner, 0);
+        }
+        m_remaining = m_runLength;
+    }
+
+    inline T* data() const { return m_current; }
+    inline Size remaining() const { return m_remaining; }
+    inline Index stride() const { return m_runStride; }
+
+    inline void advance(const Size count) {
+        m_remaining -= count;
+        m_current += count * m_runStride;
+        if (m_remaining == 0) {
+            nextRun();
+        }
+    }
+
+private:
+    inline void nextRun() {
+        for (Index i = static_cast<Size>(m_outerPos.size()) - 1; i >= 0; --i) {
+            m_runBegin += m_outerStrides[i];
+            if (++m_outerPos[i] < m_outerShape[i]) [[likely]] {
+                break;
+            }
+            m_runBegin -= m_outerStrides[i] * m_outerShape[i];
+            m_outerPos[i] = 0;
+        }
+        m_current   = m_runBegin;
+        m_remaining = m_runLength;
+    }
+
+private:
+    T* m_runBegin;
+    T* m_current;
+    Size m_runLength;
+    Index m_runStride;
+    Size m_remaining;
+    Dims m_outerShape;
+    Dims m_outerStrides;
+    Dims m_outerPos;
+};
+
+template<StridedAccessible A>
+inline static auto spanWalker(A& array) {
+    return SpanWalker(stridedLayout(array));
+}
+
+// Calls f(data, stride, count) for consecutive runs covering the first total elements
+template<typename T, typename F>
+inline static void forEachSpan(SpanWalker<T> walker, const Size total, F f) {
+    for (Size done = 0; done < total;) {
+        const Size count = std::min(walker.remaining(), total - done);
+        f(walker.data(), walker.stride(), count);
+        walker.advance(count);
+        done += count;
+    }
+}
+
+// Calls f(lhsData, lhsStride, rhsData, rhsStride, count) for runs that are contiguous in both walkers
+template<typename L, typename R, typename F>
+inline static void forEachSpanPair(SpanWalker<L> lhs, SpanWalker<R> rhs, const Size total, F f) {
+    for (Size done = 0; done < total;) {
+        const Size count = std::min({lhs.remaining(), rhs.remaining(), total - done});
+        f(lhs.data(), lhs.stride(), rhs.data(), rhs.stride(), count);
+        lhs.advance(count);
+        rhs.advance(count);
+        done += count;
+    }
+}
+
 }  // namespace nykdtb
 
 #endif
\ No newline at end of file
@@ -0,0 +1,294 @@
+#ifndef NYKDTB_NDARRAY_EXPR_HPP
+#define NYKDTB_NDARRAY_EXPR_HPP
+
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/ndarray_ops.hpp"
+
+namespace nykdtb::nda {
+
+// Lazy element-wise expressions. Operands are held by reference, so an expression must not
+// outlive the arrays it was built from. Nothing is computed until the expression is assigned
+// into an NDArrayLike target, at which point the whole tree is evaluated in a single pass.
+// Operand shapes follow NumPy broadcasting; broadcast operands are walked with stride 0.
+
+template<typename T>
+concept Expression = requires { typename T::IsExpression; };
+
+using ExpressionShape = PSVec<Size, DefaultNDArrayParams::SHAPE_STACK_SIZE>;
+
+template<NDArrayLike A>
+class TerminalExpression {
+public:
+    using IsExpression = void;
+    using Type         = std::remove_cv_t<typename A::Type>;
+    using MaterialType = typename A::MaterialType;
+
+    static constexpr bool isScalar = false;
+
+    class Cursor {
+    public:
+        Cursor(const A& array, const ExpressionShape& shape, const ExpressionShape& target)
+            : m_array(array), m_it(array.begin()), m_broadcast(!NDArrayCalc::equalShapes(shape, target)) {
+            if (m_broadcast) {
+                m_walker = BroadcastWalker(shape, target);
+            }
+        }
+
+        inline Type value() const { return m_broadcast ? Type(m_array[m_walker.offset()]) : Type(*m_it); }
+        inline void next() {
+            if (m_broadcast) {
+                m_walker.next();
+            } else {
+                ++m_it;
+            }
+        }
+
+    private:
+        const A& m_array;
+        typename A::ConstIterator m_it;
+        BroadcastWalker m_walker;
+        bool m_broadcast;
+    };
+
+public:
+    explicit TerminalExpression(const A& array)
+        : m_array(array), m_shape(array.shape().begin(), array.shape().end()) {}
+
+    const ExpressionShape& shape() const { return m_shape; }
+    Cursor cursor(const ExpressionShape& target) const { return Cursor(m_array, m_shape, target); }
+
+private:
+    const A& m_array;
+    ExpressionShape m_shape;
+};
+
+template<typename T>
+class ScalarExpression {
+public:
+    using IsExpression = void;
+    using Type         = T;
+    using MaterialType = void;
+
+    static constexpr bool isScalar = true;
+
+    class Cursor {
+    public:
+        explicit Cursor(T value)
+            : m_value(mmove(value)) {}
+
+        inline const T& value() const { return m_value; }
+        inline void next() {}
+
+    private:
+        T m_value;
+    };
+
+public:
+    explicit ScalarExpression(T value)
+        : m_value(mmove(value)) {}
+
+    const ExpressionShape& shape() const { return m_shape; }
+    Cursor cursor(const ExpressionShape&) const { return Cursor(m_value); }
+
+private:
+    T m_value;
+    ExpressionShape m_shape;
+};
+
+template<typename Op, Expression L, Expression R>
+class BinaryExpression {
+public:
+    using IsExpression = void;
+    using Type         = decltype(Op::apply(std::declval<typename L::Type>(), std::declval<typename R::Type>()));
+    using MaterialType = std::conditional_t<L::isScalar, typename R::MaterialType, typename L::MaterialType>;
+
+    static constexpr bool isScalar = L::isScalar && R::isScalar;
+
+    class Cursor {
+    public:
+        Cursor(typename L::Cursor lhs, typename R::Cursor rhs)
+            : m_lhs(mmove(lhs)), m_rhs(mmove(rhs)) {}
+
+        inline Type value() const { return Op::apply(m_lhs.value(), m_rhs.value()); }
+        inline void next() {
+            m_lhs.next();
+            m_rhs.next();
+        }
+
+    private:
+        typename L::Cursor m_lhs;
+        typename R::Cursor m_rhs;
+    };
+
+public:
+    BinaryExpression(L lhs, R rhs)
+        : m_lhs(mmove(lhs)), m_rhs(mmove(rhs)) {
+        auto shape = NDArrayCalc::broadcastShape<ExpressionShape>(m_lhs.shape(), m_rhs.shape());
+        if (!shape) {
+            throw ShapesDoNotMatch();
+        }
+        m_shape = mmove(*shape);
+    }
+
+    const ExpressionShape& shape() const { return m_shape; }
+    Cursor cursor(const ExpressionShape& target) const { return Cursor(m_lhs.cursor(target), m_rhs.cursor(target)); }
+
+private:
+    L m_lhs;
+    R m_rhs;
+    ExpressionShape m_shape;
+};
+
+namespace op {
+
+struct Neg {
+    template<typename T>
+    static constexpr auto apply(const T& value) {
+        return -value;
+    }
+};
+
+}  // namespace op
+
+template<typename Op, Expression E>
+class UnaryExpression {
+public:
+    using IsExpression = void;
+    using Type         = decltype(Op::apply(std::declval<typename E::Type>()));
+    using MaterialType = typename E::MaterialType;
+
+    static constexpr bool isScalar = E::isScalar;
+
+    class Cursor {
+    public:
+        explicit Cursor(typename E::Cursor inner)
+            : m_inner(mmove(inner)) {}
+
+        inline Type value() const { return Op::apply(m_inner.value()); }
+        inline void next() { m_inner.next(); }
+
+    private:
+        typename E::Cursor m_inner;
+    };
+
+public:
+    explicit UnaryExpression(E inner)
+        : m_inner(mmove(inner)) {}
+
+    const ExpressionShape& shape() const { return m_inner.shape(); }
+    Cursor cursor(const ExpressionShape& target) const { return Cursor(m_inner.cursor(target)); }
+
+private:
+    E m_inner;
+};
+
+template<NDArrayLike A>
+inline static TerminalExpression<A> lazy(const A& array) {
+    return TerminalExpression<A>(array);
+}
+
+template<typename T>
+inline static auto asExpression(const T& operand) {
+    if constexpr (Expression<T>) {
+        return operand;
+    } else if constexpr (NDArrayLike<T>) {
+        return TerminalExpression<T>(operand);
+    } else {
+        return ScalarExpression<T>(operand);
+    }
+}
+
+template<typename T>
+concept ExpressionOperand = Expression<T> || NDArrayLike<T> || std::is_arithmetic_v<T>;
+
+template<typename L, typename R>
+concept ExpressionOperands = ExpressionOperand<L> && ExpressionOperand<R> && (Expression<L> || Expression<R>);
+
+template<typename Op, typename L, typename R>
+inline static auto makeBinaryExpression(const L& lhs, const R& rhs) {
+    using LE = decltype(asExpression(lhs));
+    using RE = decltype(asExpression(rhs));
+    return BinaryExpression<Op, LE, RE>(asExpression(lhs), asExpression(rhs));
+}
+
+template<typename L, typename R>
+    requires ExpressionOperands<L, R>
+inline auto operator+(const L& lhs, const R& rhs) {
+    return makeBinaryExpression<op::Add>(lhs, rhs);
+}
+
+template<typename L, typename R>
+    requires ExpressionOperands<L, R>
+inline auto operator-(const L& lhs, const R& rhs) {
+    return makeBinaryExpression<op::Sub>(lhs, rhs);
+}
+
+template<typename L, typename R>
+    requires ExpressionOperands<L, R>
+inline auto operator*(const L& lhs, const R& rhs) {
+    return makeBinaryExpression<op::Mul>(lhs, rhs);
+}
+
+template<typename L, typename R>
+    requires ExpressionOperands<L, R>
+inline auto operator/(const L& lhs, const R& rhs) {
+    return makeBinaryExpression<op::Div>(lhs, rhs);
+}
+
+template<Expression E>
+inline auto operator-(const E& expr) {
+    return UnaryExpression<op::Neg, E>(expr);
+}
+
+template<NDArrayLike LHS, Expression E, typename F>
+inline static void baseAssignWithExpression(LHS& lhs, const E& expr, F op) {
+    if (!NDArrayCalc::isBroadcastableTo(expr.shape(), lhs.shape())) {
+        throw ShapesDoNotMatch();
+    }
+
+    const ExpressionShape target(lhs.shape().begin(), lhs.shape().end());
+    auto cursor = expr.cursor(target);
+    auto lhsEnd = lhs.end();
+    for (auto lhsIt = lhs.begin(); lhsIt != lhsEnd; ++lhsIt, cursor.next()) {
+        op(*lhsIt, cursor.value());
+    }
+}
+
+template<NDArrayLike LHS, Expression E>
+inline static void assign(LHS& lhs, const E& expr) {
+    baseAssignWithExpression(lhs, expr, op::Assign{});
+}
+
+template<NDArrayLike LHS, Expression E>
+inline static void addAssign(LHS& lhs, const E& expr) {
+    baseAssignWithExpression(lhs, expr, op::Add{});
+}
+
+template<NDArrayLike LHS, Expression E>
+inline static void subAssign(LHS& lhs, const E& expr) {
+    baseAssignWithExpression(lhs, expr, op::Sub{});
+}
+
+template<NDArrayLike LHS, Expression E>
+inline static void ewMulAssign(LHS& lhs, const E& expr) {
+    baseAssignWithExpression(lhs, expr, op::Mul{});
+}
+
+template<NDArrayLike LHS, Expression E>
+inline static void ewDivAssign(LHS& lhs, const E& expr) {
+    baseAssignWithExpression(lhs, expr, op::Div{});
+}
+
+template<Expression E>
+inline static typename E::MaterialType evaluate(const E& expr) {
+    using Mx = typename E::MaterialType;
+    static_assert(!std::is_void_v<Mx>, "Expression needs at least one array operand to be evaluated");
+
+    Mx result = uninitializedArray<Mx>(NDArrayCalc::convertShape<typename Mx::Shape>(expr.shape()));
+    assign(result, expr);
+    return mmove(result);
+}
+
+}  // namespace nykdtb::nda
+
+#endif
@@ -3,7 +3,13 @@
 
 #include <cmath>
 
+#include "nykdtb/gemm.hpp"
+#include "nykdtb/lu.hpp"
 #include "nykdtb/ndarray.hpp"
+#include "nykdtb/reduction.hpp"
+#include "nykdtb/simd.hpp"
+#include "nykdtb/small_matrix.hpp"
+#include "nykdtb/transpose.hpp"
 
 namespace nykdtb::nda {
 
@@ -11,85 +17,289 @@ NYKDTB_DEFINE_EXCEPTION_CLASS(ShapesDoNotMatch, LogicException)
 NYKDTB_DEFINE_EXCEPTION_CLASS(SizesDoNotMatch, LogicException)
 NYKDTB_DEFINE_EXCEPTION_CLASS(DivisionByZero, RuntimeException)
 
+namespace op {
+
+struct Add {
+    static constexpr simd::BinaryOp simdOp = simd::BinaryOp::Add;
+
+    template<typename L, typename R>
+    static constexpr auto apply(const L& lhs, const R& rhs) {
+        return lhs + rhs;
+    }
+    template<typename L, typename R>
+    constexpr void operator()(L& lhs, const R& rhs) const {
+        lhs += rhs;
+    }
+};
+
+struct Sub {
+    static constexpr simd::BinaryOp simdOp = simd::BinaryOp::Sub;
+
+    template<typename L, typename R>
+    static constexpr auto apply(const L& lhs, const R& rhs) {
+        return lhs - rhs;
+    }
+    template<typename L, typename R>
+    constexpr void operator()(L& lhs, const R& rhs) const {
+        lhs -= rhs;
+    }
+};
+
+struct Mul {
+    static constexpr simd::BinaryOp simdOp = simd::BinaryOp::Mul;
+
+    template<typename L, typename R>
+    static constexpr auto apply(const L& lhs, const R& rhs) {
+        return lhs * rhs;
+    }
+    template<typename L, typename R>
+    constexpr void operator()(L& lhs, const R& rhs) const {
+        lhs *= rhs;
+    }
+};
+
+struct Div {
+    static constexpr simd::BinaryOp simdOp = simd::BinaryOp::Div;
+
+    template<typename L, typename R>
+    static constexpr auto apply(const L& lhs, const R& rhs) {
+        return lhs / rhs;
+    }
+    template<typename L, typename R>
+    constexpr void operator()(L& lhs, const R& rhs) const {
+        lhs /= rhs;
+    }
+};
+
+struct Assign {
+    template<typename L, typename R>
+    constexpr void operator()(L& lhs, const R& rhs) const {
+        lhs = rhs;
+    }
+};
+
+template<typename F, typename T>
+concept SimdDispatchable = simd::Vectorizable<T> && requires { F::simdOp; };
+
+}  // namespace op
+
+// Runs op over count elements of two strided runs. Unit-stride runs of the same vectorizable
+// type go to the SIMD kernels.
+template<typename F, typename L, typename R>
+inline static void applySpan(F op,
+                             L* lhs,
+                             const Index lhsStride,
+                             const R* rhs,
+                             const Index rhsStride,
+                             const Size count) {
+    if constexpr (std::is_same_v<L, R> && op::SimdDispatchable<F, L>) {
+        if (lhsStride == 1 && rhsStride == 1) {
+            simd::apply(F::simdOp, lhs, rhs, count);
+            return;
+        }
+    }
+    for (Index i = 0; i < count; ++i, lhs += lhsStride, rhs += rhsStride) {
+        op(*lhs, *rhs);
+    }
+}
+
+template<typename F, typename L, typename R>
+inline static void applySpanScalar(F op, L* lhs, const Index lhsStride, const R& rhs, const Size count) {
+    if constexpr (std::is_same_v<L, R> && op::SimdDispatchable<F, L>) {
+        if (lhsStride == 1) {
+            simd::applyScalar(F::simdOp, lhs, rhs, count);
+            return;
+        }
+    }
+    for (Index i = 0; i < count; ++i, lhs += lhsStride) {
+        op(*lhs, rhs);
+    }
+}
+
+// Calls f(element) for every element in iteration order, one contiguous run at a time when the
+// array exposes its strided layout
+template<NDArrayLike T, typename F>
+inline static void forEachElement(T& array, F f) {
+    if constexpr (StridedAccessible<T>) {
+        forEachSpan(spanWalker(array), array.size(), [&](auto* data, const Index stride, const Size count) {
+            for (Index i = 0; i < count; ++i, data += stride) {
+                f(*data);
+            }
+        });
+    } else {
+        for (auto& e : array) {
+            f(e);
+        }
+    }
+}
+
+// Calls f(lhsElement, rhsElement) pairwise for arrays of the same size
+template<NDArrayLike LHS, NDArrayLike RHS, typename F>
+inline static void forEachElementPair(LHS& lhs, RHS& rhs, F f) {
+    if constexpr (StridedAccessible<LHS> && StridedAccessible<RHS>) {
+        forEachSpanPair(spanWalker(lhs),
+                        spanWalker(rhs),
+                        lhs.size(),
+                        [&](auto* l, const Index ls, auto* r, const Index rs, const Size count) {
+                            for (Index i = 0; i < count; ++i, l += ls, r += rs) {
+                                f(*l, *r);
+                            }
+                        });
+    } else {
+        auto lhsEnd = lhs.end();
+        auto rhsIt  = rhs.begin();
+        for (auto lhsIt = lhs.begin(); lhsIt != lhsEnd; ++lhsIt, ++rhsIt) {
+            f(*lhsIt, *rhsIt);
+        }
+    }
+}
+
+// True if pred(lhsElement, rhsElement) holds for every pair, stops at the first pair it does not hold for
+template<NDArrayLike LHS, NDArrayLike RHS, typename P>
+inline static bool allElementPairs(LHS& lhs, RHS& rhs, P pred) {
+    if constexpr (StridedAccessible<LHS> && StridedAccessible<RHS>) {
+        auto lhsWalker = spanWalker(lhs);
+        auto rhsWalker = spanWalker(rhs);
+        for (Size done = 0, total = lhs.size(); done < total;) {
+            const Size count = std::min({lhsWalker.remaining(), rhsWalker.remaining(), total - done});
+            auto* l          = lhsWalker.data();
+            auto* r          = rhsWalker.data();
+            for (Index i = 0; i < count; ++i, l += lhsWalker.stride(), r += rhsWalker.stride()) {
+                if (!pred(*l, *r)) {
+                    return false;
+                }
+            }
+            lhsWalker.advance(count);
+            rhsWalker.advance(count);
+            done += count;
+        }
+    } else {
+        auto lhsEnd = lhs.end();
+        auto rhsIt  = rhs.begin();
+        for (auto lhsIt = lhs.begin(); lhsIt != lhsEnd; ++lhsIt, ++rhsIt) {
+            if (!pred(*lhsIt, *rhsIt)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 template<NDArrayLike LHS, NDArrayLike RHS, typename F>
 inline static void baseAssignWithSameShape(LHS& lhs, const RHS& rhs, F op) {
-    auto lhsBegin = lhs.begin();
-    auto lhsEnd   = lhs.end();
-    auto rhsIt    = rhs.begin();
+    if constexpr (StridedAccessible<LHS> && StridedAccessible<const RHS>) {
+        forEachSpanPair(spanWalker(lhs),
+                        spanWalker(rhs),
+                        lhs.size(),
+                        [&](auto* l, const Index ls, const auto* r, const Index rs, const Size count) {
+                            applySpan(op, l, ls, r, rs, count);
+                        });
+    } else {
+        forEachElementPair(lhs, rhs, op);
+    }
+}
+
+template<NDArrayLike LHS, NDArrayLike RHS, typename F>
+inline static void baseAssignWithBroadcast(LHS& lhs, const RHS& rhs, F op) {
+    BroadcastWalker rhsWalker(rhs.shape(), lhs.shape());
+    auto lhsEnd = lhs.end();
+
+    for (auto lhsIt = lhs.begin(); lhsIt != lhsEnd; ++lhsIt, rhsWalker.next()) {
+        op(*lhsIt, rhs[rhsWalker.offset()]);
+    }
+}
 
-    for (auto lhsIt = lhsBegin; lhsIt < lhsEnd; ++lhsIt, ++rhsIt) {
-        op(*lhsIt, *rhsIt);
+// Element-wise op into lhs. rhs must either have the shape of lhs or broadcast to it.
+template<NDArrayLike LHS, NDArrayLike RHS, typename F>
+inline static void baseAssignElementwise(LHS& lhs, const RHS& rhs, F op) {
+    if (NDArrayCalc::equalShapes(lhs.shape(), rhs.shape())) [[likely]] {
+        baseAssignWithSameShape(lhs, rhs, op);
+    } else if (NDArrayCalc::isBroadcastableTo(rhs.shape(), lhs.shape())) {
+        baseAssignWithBroadcast(lhs, rhs, op);
+    } else {
+        throw ShapesDoNotMatch();
+    }
+}
+
+// Element-wise op returning a new value. If lhs itself has to be broadcast to the common shape
+// and is an owning array, it is expanded once into a result of the common shape.
+template<NDArrayLike LHS, NDArrayLike RHS, typename F>
+inline static LHS baseElementwise(LHS lhs, const RHS& rhs, F op) {
+    if constexpr (std::is_same_v<LHS, typename LHS::MaterialType>) {
+        if (!NDArrayCalc::isBroadcastableTo(rhs.shape(), lhs.shape())) {
+            using Dims       = BroadcastWalker::Dims;
+            const auto shape = NDArrayCalc::broadcastShape<Dims>(lhs.shape(), rhs.shape());
+            if (!shape) {
+                throw ShapesDoNotMatch();
+            }
+            LHS expanded = uninitializedArray<LHS>(NDArrayCalc::convertShape<typename LHS::Shape>(*shape));
+            baseAssignWithBroadcast(expanded, lhs, op::Assign{});
+            lhs = mmove(expanded);
+        }
     }
+    baseAssignElementwise(lhs, rhs, op);
+    return mmove(lhs);
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static void addAssign(LHS& lhs, const RHS& rhs) {
-    baseAssignWithSameShape(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs += rhs; });
+    baseAssignElementwise(lhs, rhs, op::Add{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static LHS add(LHS lhs, const RHS& rhs) {
-    addAssign(lhs, rhs);
-    return mmove(lhs);
+    return baseElementwise(mmove(lhs), rhs, op::Add{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static void subAssign(LHS& lhs, const RHS& rhs) {
-    baseAssignWithSameShape(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs -= rhs; });
+    baseAssignElementwise(lhs, rhs, op::Sub{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static LHS sub(LHS lhs, const RHS& rhs) {
-    subAssign(lhs, rhs);
-    return mmove(lhs);
+    return baseElementwise(mmove(lhs), rhs, op::Sub{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static void ewMulAssign(LHS& lhs, const RHS& rhs) {
-    baseAssignWithSameShape(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs *= rhs; });
+    baseAssignElementwise(lhs, rhs, op::Mul{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static LHS ewMul(LHS lhs, const RHS& rhs) {
-    ewMulAssign(lhs, rhs);
-    return mmove(lhs);
+    return baseElementwise(mmove(lhs), rhs, op::Mul{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static void ewDivAssign(LHS& lhs, const RHS& rhs) {
-    baseAssignWithSameShape(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs /= rhs; });
+    baseAssignElementwise(lhs, rhs, op::Div{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static LHS ewDiv(LHS lhs, const RHS& rhs) {
-    ewDivAssign(lhs, rhs);
-    return mmove(lhs);
+    return baseElementwise(mmove(lhs), rhs, op::Div{});
 }
 
 template<NDArrayLike LHS, NDArrayLike RHS>
 inline static void assign(LHS& lhs, const RHS& rhs) {
-    auto lhsBegin = lhs.begin();
-    auto lhsEnd   = lhs.end();
-    auto rhsIt    = rhs.begin();
-
-    for (auto lhsIt = lhsBegin; lhsIt < lhsEnd; ++lhsIt, ++rhsIt) {
-        *lhsIt = *rhsIt;
-    }
+    baseAssignElementwise(lhs, rhs, op::Assign{});
 }
 
 template<NDArrayLike T, typename F>
 inline static void baseAssignWithScalar(T& lhs, const typename T::Type& rhs, F op) {
-    auto lhsBegin = lhs.begin();
-    auto lhsEnd   = lhs.end();
-
-    for (auto lhsIt = lhsBegin; lhsIt < lhsEnd; ++lhsIt) {
-        op(*lhsIt, rhs);
+    if constexpr (StridedAccessible<T>) {
+        forEachSpan(spanWalker(lhs), lhs.size(), [&](auto* data, const Index stride, const Size count) {
+            applySpanScalar(op, data, stride, rhs, count);
+        });
+    } else {
+        forEachElement(lhs, [&](auto& e) { op(e, rhs); });
     }
 }
 
 template<NDArrayLike T>
 inline static void addAssignScalar(T& lhs, const typename T::Type& rhs) {
-    baseAssignWithScalar(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs += rhs; });
+    baseAssignWithScalar(lhs, rhs, op::Add{});
 }
 
 template<NDArrayLike T>
@@ -100,7 +310,7 @@ inline static T addScalar(T lhs, const typename T::Type& rhs) {
 
 template<NDArrayLike T>
 inline static void subAssignScalar(T& lhs, const typename T::Type& rhs) {
-    baseAssignWithScalar(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs -= rhs; });
+    baseAssignWithScalar(lhs, rhs, op::Sub{});
 }
 
 template<NDArrayLike T>
@@ -111,7 +321,7 @@ inline static T subScalar(T lhs, const typename T::Type& rhs) {
 
 template<NDArrayLike T>
 inline static void mulAssignScalar(T& lhs, const typename T::Type& rhs) {
-    baseAssignWithScalar(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs *= rhs; });
+    baseAssignWithScalar(lhs, rhs, op::Mul{});
 }
 
 template<NDArrayLike T>
@@ -122,7 +332,7 @@ inline static T mulScalar(T lhs, const typename T::Type& rhs) {
 
 template<NDArrayLike T>
 inline static void divAssignScalar(T& lhs, const typename T::Type& rhs) {
-    baseAssignWithScalar(lhs, rhs, [](auto& lhs, const auto& rhs) { lhs /= rhs; });
+    baseAssignWithScalar(lhs, rhs, op::Div{});
 }
 
 template<NDArrayLike T>
@@ -134,9 +344,7 @@ inline static T divScalar(T lhs, const typename T::Type& rhs) {
 template<NDArrayLike T>
 inline static typename T::Type magnitude(const T& elem) {
     typename T::Type lengthsq = 0;
-    for (const auto& e : elem) {
-        lengthsq += e * e;
-    }
+    forEachElement(elem, [&](const auto& e) { lengthsq += e * e; });
 
     return std::sqrt(lengthsq);
 }
@@ -148,9 +356,7 @@ inline static void normalize(T& elem) {
         throw DivisionByZero();
     }
     auto mtp = 1.0F / mag;
-    for (auto& e : elem) {
-        e *= mtp;
-    }
+    forEachElement(elem, [&](auto& e) { e *= mtp; });
 }
 
 template<NDArrayLike T>
@@ -167,15 +373,8 @@ inline static typename LHS::Type dot(const LHS& lhs, const RHS& rhs) {
     if (lhs.size() != rhs.size()) {
         throw SizesDoNotMatch();
     }
-    auto lhsBegin = lhs.begin();
-    auto lhsEnd   = lhs.end();
-    auto rhsIt    = rhs.begin();
-
     typename LHS::Type result = 0;
-
-    for (auto lhsIt = lhsBegin; lhsIt < lhsEnd; ++lhsIt, ++rhsIt) {
-        result += (*lhsIt) * (*rhsIt);
-    }
+    forEachElementPair(lhs, rhs, [&](const auto& l, const auto& r) { result += l * r; });
 
     return result;
 }
@@ -186,17 +385,197 @@ inline static bool eq(const LHS& lhs, const RHS& rhs) {
         return false;
     }
 
-    auto lhsBegin = lhs.begin();
-    auto lhsEnd   = lhs.end();
-    auto rhsIt    = rhs.begin();
+    return allElementPairs(lhs, rhs, [](const auto& l, const auto& r) { return l == r; });
+}
 
-    for (auto lhsIt = lhsBegin; lhsIt < lhsEnd; ++lhsIt, ++rhsIt) {
-        if ((*lhsIt) != (*rhsIt)) {
-            return false;
-        }
+// Reduces array along axis with one of the ops in nda::reduction, e.g. reduce(a, 0, reduction::Sum{}).
+// Negative axes count from the back. The result has the shape of array without that axis, {1} for vectors.
+// Large reductions are split across the thread pool, threadCount of 0 uses defaultThreadCount(). Results
+// do not depend on the thread count.
+template<typename F, NDArrayLike T>
+    requires StridedAccessible<const T>
+inline static auto reduce(const T& array, Index axis, F, const Size threadCount = 0) {
+    using Type   = std::remove_cv_t<typename T::Type>;
+    using Result = NDArray<typename F::template Result<Type>>;
+
+    const Size depth = static_cast<Size>(array.shape().size());
+    if (axis < 0) {
+        axis += depth;
+    }
+    if (axis < 0 || axis >= depth) {
+        throw reduction::InvalidAxis();
+    }
+    if (!F::ALLOWS_EMPTY && array.shape(axis) == 0) {
+        throw reduction::EmptyReduction();
     }
 
-    return true;
+    const auto layout = stridedLayout(array);
+    const reduction::Plan<Type> plan(layout, axis);
+    auto shape = NDArrayCalc::convertShape<typename Result::Shape>(plan.outputShape());
+    if (shape.empty()) {
+        shape.push_back(1);
+    }
+    auto result = uninitializedArray<Result>(mmove(shape));
+    reduction::execute<F>(
+        plan,
+        layout.data,
+        [&](const Index output, const auto& acc) { result[output] = F::finish(acc, plan.length()); },
+        threadCount);
+    return mmove(result);
+}
+
+// Reduces all elements of array, see reduce
+template<typename F, NDArrayLike T>
+    requires StridedAccessible<const T>
+inline static auto reduceAll(const T& array, F, const Size threadCount = 0) {
+    using Type = std::remove_cv_t<typename T::Type>;
+    using Acc  = typename F::template Acc<Type>;
+    if (!F::ALLOWS_EMPTY && array.size() == 0) {
+        throw reduction::EmptyReduction();
+    }
+
+    const auto layout = stridedLayout(array);
+    const auto plan   = reduction::Plan<Type>::all(layout);
+    Vec<Acc> runs(std::max<Size>(1, plan.outputCount()), F::template identity<Type>());
+    reduction::execute<F>(
+        plan,
+        layout.data,
+        [&](const Index output, const Acc& acc) {
+            runs[output] = acc;
+            F::offset(runs[output], output * plan.length());
+        },
+        threadCount);
+    return F::finish(reduction::mergeRange<F>(runs.data(), 0, static_cast<Size>(runs.size())), array.size());
+}
+
+template<NDArrayLike T>
+inline static auto sum(const T& array) {
+    return reduceAll(array, reduction::Sum{});
+}
+
+template<NDArrayLike T>
+inline static auto sum(const T& array, const Index axis, const Size threadCount = 0) {
+    return reduce(array, axis, reduction::Sum{}, threadCount);
+}
+
+template<NDArrayLike T>
+inline static auto mean(const T& array) {
+    return reduceAll(array, reduction::Mean{});
+}
+
+template<NDArrayLike T>
+inline static auto mean(const T& array, const Index axis, const Size threadCount = 0) {
+    return reduce(array, axis, reduction::Mean{}, threadCount);
+}
+
+template<NDArrayLike T>
+inline static auto min(const T& array) {
+    return reduceAll(array, reduction::Min{});
+}
+
+template<NDArrayLike T>
+inline static auto min(const T& array, const Index axis, const Size threadCount = 0) {
+    return reduce(array, axis, reduction::Min{}, threadCount);
+}
+
+template<NDArrayLike T>
+inline static auto max(const T& array) {
+    return reduceAll(array, reduction::Max{});
+}
+
+template<NDArrayLike T>
+inline static auto max(const T& array, const Index axis, const Size threadCount = 0) {
+    return reduce(array, axis, reduction::Max{}, threadCount);
+}
+
+// Position of the first maximum: a linear index in iteration order, or indices along the axis
+template<NDArrayLike T>
+inline static Index argmax(const T& array) {
+    return reduceAll(array, reduction::ArgMax{});
+}
+
+template<NDArrayLike T>
+inline static NDArray<Index> argmax(const T& array, const Index axis, const Size threadCount = 0) {
+    return reduce(array, axis, reduction::ArgMax{}, threadCount);
+}
+
+// Euclidean norm, same as magnitude for the whole array. The result has the element type, so
+// integer arrays are left out rather than having their square root truncated.
+template<NDArrayLike T>
+    requires std::is_floating_point_v<std::remove_cv_t<typename T::Type>>
+inline static auto norm(const T& array) {
+    return reduceAll(array, reduction::Norm{});
+}
+
+template<NDArrayLike T>
+    requires std::is_floating_point_v<std::remove_cv_t<typename T::Type>>
+inline static auto norm(const T& array, const Index axis, const Size threadCount = 0) {
+    return reduce(array, axis, reduction::Norm{}, threadCount);
+}
+
+// Dense copy of a strided array or view, such as a slice or a permuted view. The copy is blocked
+// so that both the source and the target are walked in cache sized tiles.
+template<NDArrayLike T>
+    requires StridedAccessible<const T>
+inline static NDArray<std::remove_cv_t<typename T::Type>> materialize(const T& array) {
+    using Result = NDArray<std::remove_cv_t<typename T::Type>>;
+    auto result  = uninitializedArray<Result>(NDArrayCalc::convertShape<typename Result::Shape>(array.shape()));
+    transposition::relayout(stridedLayout(array), result.begin());
+    return mmove(result);
+}
+
+// Same as materialize, spread over the thread pool. threadCount of 0 uses defaultThreadCount().
+template<NDArrayLike T>
+    requires StridedAccessible<const T>
+inline static NDArray<std::remove_cv_t<typename T::Type>> parallelMaterialize(const T& array,
+                                                                              const Size threadCount = 0) {
+    using Result = NDArray<std::remove_cv_t<typename T::Type>>;
+    auto result  = uninitializedArray<Result>(NDArrayCalc::convertShape<typename Result::Shape>(array.shape()));
+    transposition::relayoutParallel(stridedLayout(array), result.begin(), threadCount);
+    return mmove(result);
+}
+
+// The rows [begin, end) of the first dimension of array as a slice
+template<NDArrayLike A>
+inline static NDArraySlice<A> outerSlice(A& array, const Index begin, const Index end) {
+    typename std::remove_cv_t<A>::SliceShape shape;
+    shape.push_back(IndexRange::between(begin, end));
+    for (Index i = 1; i < static_cast<Size>(array.shape().size()); ++i) {
+        shape.push_back(IndexRange::e2e());
+    }
+    return NDArraySlice<A>(array, mmove(shape));
+}
+
+// parallelFor over the first dimension of array. body(blockBegin, rows) gets the rows of each block
+// as a slice of array, blockBegin being the index of its first row.
+template<NDArrayLike A, typename F>
+inline static void parallelForOuter(A& array, F&& body, const Size threadCount = 0, const Size grain = 0) {
+    parallelFor(
+        0,
+        array.shape(0),
+        [&](const Index begin, const Index end) {
+            auto rows = outerSlice(array, begin, end);
+            body(begin, rows);
+        },
+        threadCount,
+        grain);
+}
+
+// parallelReduce over the first dimension of array, reduce(blockBegin, rows) is called as in parallelForOuter
+template<NDArrayLike A, typename T, typename R, typename C>
+inline static T parallelReduceOuter(
+    A& array, T identity, R&& reduce, C&& combine, const Size threadCount = 0, const Size grain = 0) {
+    return parallelReduce(
+        0,
+        array.shape(0),
+        mmove(identity),
+        [&](const Index begin, const Index end) {
+            auto rows = outerSlice(array, begin, end);
+            return reduce(begin, rows);
+        },
+        combine,
+        threadCount,
+        grain);
 }
 
 namespace d2 {
@@ -229,74 +608,160 @@ inline static typename T::MaterialType identity(const typename T::Shape& shape)
     return mmove(result);
 }
 
+// Inverse through an LU factorization with partial pivoting. The factors are computed in the
+// given workspace, which is only grown when a larger matrix comes along.
 template<NDArrayLike T>
-inline static typename T::MaterialType inverse(T input) {
+inline static typename T::MaterialType inverse(const T& input,
+                                               lu::Workspace<std::remove_cv_t<typename T::Type>>& workspace) {
     using Mx = typename T::MaterialType;
+    static_assert(ContiguousNDArray<Mx>, "inverse result must have contiguous storage");
     if (!isSquare<T>(input.shape())) {
         throw Matrix2DError("Only 2D square matrices are invertable");
     }
 
-    Mx result      = identity<T>(input.shape());
     const Size dim = input.shape(0);
+    workspace.reserve(dim);
+    std::copy(input.begin(), input.end(), workspace.factors.begin());
+    if (!lu::factorize(workspace.factors.begin(), dim, dim, workspace.pivots.begin())) {
+        throw Matrix2DError("Matrix is singular");
+    }
 
-    for (Index round = 0; round < 2; ++round) {
-        const bool isBottomTriangle = round == 0;
-        const Index leadingStart    = isBottomTriangle ? 0 : dim - 1;
-        const Index cycleEnd        = isBottomTriangle ? dim : 0;
-        const auto cycleEndCompare  = isBottomTriangle ? [](const Index lhs, const Index rhs) { return lhs < rhs; }
-                                                       : [](const Index lhs, const Index rhs) { return lhs >= rhs; };
-        const auto cycleAdvance     = isBottomTriangle ? [](Index& value) { ++value; } : [](Index& value) { --value; };
-        const Index remainingOffset = isBottomTriangle ? 1 : -1;
-
-        for (Index leading = leadingStart; cycleEndCompare(leading, cycleEnd); cycleAdvance(leading)) {
-            const auto leadingRowSelect = typename T::SliceShape{IR::single(leading), IR::e2e()};
-            NDArraySlice<T> leadInputRow(input, leadingRowSelect);
-            NDArraySlice<T> leadResultRow(result, leadingRowSelect);
-            const typename T::Type leadValue = 1.0 / leadInputRow[{0, leading}];
-            mulAssignScalar(leadInputRow, leadValue);
-            mulAssignScalar(leadResultRow, leadValue);
-
-            for (Index remaining = leading + remainingOffset; cycleEndCompare(remaining, cycleEnd);
-                 cycleAdvance(remaining)) {
-                const auto remainingRowSelect = typename T::SliceShape{IR::single(remaining), IR::e2e()};
-                NDArraySlice<T> remainingInputRow(input, remainingRowSelect);
-                NDArraySlice<T> remainingResultRow(result, remainingRowSelect);
-                const auto remainingValue = remainingInputRow[{0, leading}];
-                subAssign(remainingInputRow, mulScalar(leadInputRow.materialize(), remainingValue));
-                subAssign(remainingResultRow, mulScalar(leadResultRow.materialize(), remainingValue));
-            }
-        }
+    Mx result = uninitializedArray<Mx>(input.shape());
+    lu::invert(workspace.factors.begin(),
+               dim,
+               workspace.pivots.begin(),
+               dim,
+               result.begin(),
+               result.stride(0),
+               workspace.scratch);
+    return mmove(result);
+}
+
+template<NDArrayLike T>
+inline static typename T::MaterialType inverse(const T& input) {
+    return inverse(input, lu::Workspace<std::remove_cv_t<typename T::Type>>::local());
+}
+
+// Closed-form inverse of small static matrices
+template<typename T, typename Params, Size N>
+    requires(N <= small::Limits::MAX_CLOSED_FORM)
+inline static constexpr NDArrayStatic<T, Params, N, N> inverse(const NDArrayStatic<T, Params, N, N>& input) {
+    NDArrayStatic<T, Params, N, N> result;
+    if (!small::invert<T, N>(input.begin(), result.begin())) {
+        throw Matrix2DError("Matrix is singular");
+    }
+    return mmove(result);
+}
+
+template<NDArrayLike T>
+inline static typename T::Type determinant(const T& input,
+                                           lu::Workspace<std::remove_cv_t<typename T::Type>>& workspace) {
+    using Type = std::remove_cv_t<typename T::Type>;
+    if (!isSquare<T>(input.shape())) {
+        throw Matrix2DError("Only 2D square matrices have a determinant");
+    }
+
+    const Size dim = input.shape(0);
+    workspace.reserve(dim);
+    std::copy(input.begin(), input.end(), workspace.factors.begin());
+    if (!lu::factorize(workspace.factors.begin(), dim, dim, workspace.pivots.begin())) {
+        return Type{0};
     }
+    return lu::determinant(workspace.factors.begin(), dim, workspace.pivots.begin(), dim);
+}
+
+template<NDArrayLike T>
+inline static typename T::Type determinant(const T& input) {
+    return determinant(input, lu::Workspace<std::remove_cv_t<typename T::Type>>::local());
+}
+
+template<typename T, typename Params, Size N>
+    requires(N <= small::Limits::MAX_CLOSED_FORM)
+inline static constexpr T determinant(const NDArrayStatic<T, Params, N, N>& input) {
+    return small::determinant<T, N>(input.begin());
+}
 
+// Zero-copy transposed view. matMul reads it in place with the packing order swapped.
+template<NDArrayLike T>
+inline static NDArrayPermuted<T> transpose(T& matrix) {
+    if (!is2d<T>(matrix.shape())) {
+        throw Matrix2DError("Only 2D matrices can be transposed");
+    }
+    return permute(matrix, {1, 0});
+}
+
+// Dense transposed copy
+template<NDArrayLike T>
+inline static auto transposed(const T& matrix) {
+    return materialize(transpose(matrix));
+}
+
+template<typename T, typename Params, Size M, Size N>
+inline static constexpr NDArrayStatic<T, Params, N, M> transposed(const NDArrayStatic<T, Params, M, N>& matrix) {
+    NDArrayStatic<T, Params, N, M> result;
+    small::transpose<T, M, N>(matrix.begin(), result.begin());
     return mmove(result);
 }
 
-template<NDArrayLike LHS, NDArrayLike RHS, Size INTERLEAVE = 4>
-inline static typename LHS::MaterialType matMul(const LHS& lhs, const RHS& rhs) {
+template<NDArrayLike LHS, NDArrayLike RHS>
+inline static typename LHS::MaterialType matMulTarget(const LHS& lhs, const RHS& rhs) {
     if (!is2d<LHS>(lhs.shape()) || !is2d<RHS>(rhs.shape())) {
         throw Matrix2DError("Only 2D matrices are multipliable");
     }
     if (lhs.shape(1) != rhs.shape(0)) {
         throw Matrix2DError("Incorrect shape for matrix multiplication");
     }
+    static_assert(ContiguousNDArray<typename LHS::MaterialType>, "matMul result must have contiguous storage");
 
-    const typename LHS::Shape resultShape{lhs.shape(0), rhs.shape(1)};
-    const auto resultRowCount    = resultShape[0];
-    const auto resultColumnCount = resultShape[1];
-    const auto sourceColumnCount = lhs.shape(1);
-    auto result                  = LHS::MaterialType::zeros(resultShape);
-
-    for (Index resultRow = 0; resultRow < resultRowCount; ++resultRow) {
-        const auto lhsRowOffset    = lhs.stride(0) * resultRow;
-        const auto resultRowOffset = result.stride(0) * resultRow;
-        for (Index resultColumn = 0; resultColumn < resultColumnCount; ++resultColumn) {
-            for (Index sourceColumn = 0; sourceColumn < sourceColumnCount; ++sourceColumn) {
-                const auto lhsValue = lhs[lhsRowOffset + sourceColumn];
-                const auto rhsValue = rhs[rhs.stride(0) * sourceColumn + resultColumn];
-                result[resultRowOffset + resultColumn] += lhsValue * rhsValue;
-            }
-        }
+    return uninitializedArray<typename LHS::MaterialType>(typename LHS::Shape{lhs.shape(0), rhs.shape(1)});
+}
+
+template<NDArrayLike LHS, NDArrayLike RHS>
+inline static typename LHS::MaterialType matMul(const LHS& lhs, const RHS& rhs) {
+    using T     = std::remove_cv_t<typename LHS::Type>;
+    auto result = matMulTarget(lhs, rhs);
+
+    gemm::multiply<T>(gemm::source<T>(lhs),
+                      gemm::source<T>(rhs),
+                      lhs.shape(1),
+                      result.begin(),
+                      result.stride(0),
+                      0,
+                      result.shape(0),
+                      0,
+                      result.shape(1));
+
+    return mmove(result);
+}
+
+// Static operands give a static M x N result. Small products are fully unrolled, larger ones use gemm.
+template<typename T, typename LhsParams, typename RhsParams, Size M, Size K, Size N>
+inline static constexpr NDArrayStatic<T, LhsParams, M, N> matMul(const NDArrayStatic<T, LhsParams, M, K>& lhs,
+                                                                 const NDArrayStatic<T, RhsParams, K, N>& rhs) {
+    NDArrayStatic<T, LhsParams, M, N> result;
+    if constexpr (M * K * N <= small::Limits::MAX_UNROLLED_PRODUCT) {
+        small::multiply<T, M, K, N>(lhs.begin(), rhs.begin(), result.begin());
+    } else {
+        gemm::multiply<T>(gemm::source<T>(lhs), gemm::source<T>(rhs), K, result.begin(), N, 0, M, 0, N);
     }
+    return mmove(result);
+}
+
+// Splits the product across the thread pool. threadCount of 0 uses defaultThreadCount().
+// Products too small to amortize the threading overhead run on the calling thread only.
+template<NDArrayLike LHS, NDArrayLike RHS>
+inline static typename LHS::MaterialType parallelMatMul(const LHS& lhs, const RHS& rhs, const Size threadCount = 0) {
+    using T     = std::remove_cv_t<typename LHS::Type>;
+    auto result = matMulTarget(lhs, rhs);
+
+    gemm::multiplyParallel<T>(gemm::source<T>(lhs),
+                              gemm::source<T>(rhs),
+                              lhs.shape(1),
+                              result.begin(),
+                              result.stride(0),
+                              result.shape(0),
+                              result.shape(1),
+                              threadCount);
 
     return mmove(result);
 }
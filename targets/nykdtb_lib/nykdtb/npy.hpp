@@ -0,0 +1,250 @@
+#ifndef NYKDTB_NPY_HPP
+#define NYKDTB_NPY_HPP
+
+#include <bit>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include "nykdtb/mapped.hpp"
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/ndarray_ops.hpp"
+#include "nykdtb/types.hpp"
+
+// Reading and writing arrays in the NumPy .npy format: a short header describing the element type, the
+// shape and the memory order, followed by the raw elements.
+namespace nykdtb::npy {
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(InvalidFormat, RuntimeException)
+NYKDTB_DEFINE_EXCEPTION_CLASS(FileError, RuntimeException)
+NYKDTB_DEFINE_EXCEPTION_CLASS(DtypeMismatch, LogicException)
+NYKDTB_DEFINE_EXCEPTION_CLASS(LayoutMismatch, LogicException)
+
+using Shape = PSVec<Size, DefaultNDArrayParams::SHAPE_STACK_SIZE>;
+
+// Element types stored as a single NumPy scalar
+template<typename T>
+concept Element = std::is_arithmetic_v<T>;
+
+struct Header {
+    // NumPy type string, byte order followed by kind and size, e.g. "<f4"
+    std::string descr;
+    bool fortranOrder = false;
+    Shape shape;
+    // Bytes before the first element
+    std::size_t dataOffset = 0;
+
+    // True if the elements are stored with the native byte order, or are single bytes
+    bool nativeByteOrder() const;
+};
+
+// Throws InvalidFormat unless the element count of shape, and so every stride, fits Size
+void checkShape(const Shape& shape);
+// Parses the header at the start of a file, throws InvalidFormat if it is not an .npy header
+Header parseHeader(const std::byte* data, std::size_t size);
+Header readHeader(const std::string& path);
+// Magic, version, length and dictionary of header, padded with spaces to at least length bytes and to a
+// multiple of 64 so that the elements are aligned
+std::string formatHeader(const Header& header, std::size_t length = 0);
+
+template<Element T>
+inline static std::string descr() {
+    constexpr char kind = std::is_same_v<T, bool>         ? 'b'
+                          : std::is_floating_point_v<T> ? 'f'
+                          : std::is_signed_v<T>         ? 'i'
+                                                        : 'u';
+    constexpr char order = sizeof(T) == 1 ? '|' : std::endian::native == std::endian::little ? '<' : '>';
+    return std::string{order, kind} + std::to_string(sizeof(T));
+}
+
+// Bytes per element of a type string such as "<f4", 0 if it does not end in a size
+std::size_t descrSize(const std::string& descr);
+
+namespace detail {
+
+// Throws DtypeMismatch unless header stores elements of type T, in any byte order
+void checkDtype(const Header& header, const std::string& expected);
+// Reverses the bytes of count elements of elementSize bytes each
+void swapBytes(void* data, Size count, std::size_t elementSize);
+void readExactly(std::ifstream& stream, void* data, std::size_t bytes, const std::string& path);
+
+template<typename T>
+inline static void writeElements(std::ostream& stream, const T* data, const Size count) {
+    stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+}
+
+// Arrays that are not dense in C order are materialized first
+template<NDArrayLike A>
+inline static void writeElements(std::ostream& stream, const A& array) {
+    if constexpr (ContiguousNDArray<A>) {
+        writeElements(stream, array.begin(), array.size());
+    } else {
+        const auto dense = nda::materialize(array);
+        writeElements(stream, dense.begin(), dense.size());
+    }
+}
+
+}  // namespace detail
+
+// Writes array to path in C order
+template<NDArrayLike A>
+    requires Element<std::remove_cv_t<typename A::Type>>
+inline static void save(const std::string& path, const A& array) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        throw FileError("Cannot create " + path);
+    }
+    const Header header{
+        descr<std::remove_cv_t<typename A::Type>>(), false, Shape(array.shape().begin(), array.shape().end())};
+    stream << formatHeader(header);
+    detail::writeElements(stream, array);
+    if (!stream) {
+        throw FileError("Cannot write " + path);
+    }
+}
+
+// Reads the file at path into a new array. The elements are read straight into the storage of the result,
+// Fortran ordered files are transposed into C order on the way.
+template<NDArrayLike A>
+    requires ContiguousNDArray<A> && Element<typename A::Type>
+inline static A load(const std::string& path) {
+    using T           = typename A::Type;
+    const Header head = readHeader(path);
+    detail::checkDtype(head, descr<T>());
+
+    std::ifstream stream(path, std::ios::binary);
+    stream.seekg(static_cast<std::streamoff>(head.dataOffset));
+    A result           = uninitializedArray<A>(NDArrayCalc::convertShape<typename A::Shape>(head.shape));
+    const Size count   = result.size();
+    const auto reverse = [&](T* data) {
+        if (!head.nativeByteOrder()) {
+            detail::swapBytes(data, count, sizeof(T));
+        }
+    };
+    if (!head.fortranOrder || head.shape.size() < 2) {
+        detail::readExactly(stream, result.begin(), count * sizeof(T), path);
+        reverse(result.begin());
+        return result;
+    }
+
+    PSVec<T, 1, alignof(T)> columnMajor;
+    columnMajor.resizeUninitialized(count);
+    detail::readExactly(stream, columnMajor.begin(), count * sizeof(T), path);
+    reverse(columnMajor.begin());
+    StridedLayout<const T> layout{columnMajor.begin(), head.shape, head.shape};
+    Size stride = 1;
+    for (Index i = 0; i < static_cast<Size>(head.shape.size()); ++i) {
+        layout.strides[i] = stride;
+        stride *= head.shape[i];
+    }
+    nda::transposition::relayout(layout, result.begin());
+    return result;
+}
+
+template<Element T>
+inline static NDArray<T> load(const std::string& path) {
+    return load<NDArray<T>>(path);
+}
+
+// Maps the elements of the file at path without copying them, NDArrayMapped<const T> maps read-only.
+// Throws LayoutMismatch for Fortran order or foreign byte order files, those need load.
+template<typename T, typename Params = DefaultNDArrayParams>
+    requires Element<std::remove_const_t<T>>
+inline static NDArrayMapped<T, Params> map(const std::string& path,
+                                           const MapMode mode = NDArrayMapped<T, Params>::defaultMode) {
+    MappedFile file(path, mode);
+    const Header head = parseHeader(file.data(), file.size());
+    detail::checkDtype(head, descr<std::remove_const_t<T>>());
+    if ((head.fortranOrder && head.shape.size() > 1) || !head.nativeByteOrder()) {
+        throw LayoutMismatch("Only C ordered files in native byte order can be mapped: " + path);
+    }
+    using Mapped = NDArrayMapped<T, Params>;
+    return {mmove(file), NDArrayCalc::convertShape<typename Mapped::Shape>(head.shape), head.dataOffset};
+}
+
+// Streams rows into an .npy file, growing its first dimension. Rows are written as they are appended, only
+// the header is rewritten to record the new row count, by flush and when the writer is closed.
+template<Element T>
+class Writer {
+public:
+    // Rows of rowShape, an empty rowShape writes a vector of single elements
+    Writer(const std::string& path, Shape rowShape)
+        : m_path(path),
+          m_stream(path, std::ios::binary | std::ios::trunc),
+          m_rowShape(mmove(rowShape)),
+          m_rows(0) {
+        if (!m_stream) {
+            throw FileError("Cannot create " + path);
+        }
+        // Sized for the longest row count, so that rewriting it never moves the elements
+        m_headerLength = formatHeader(header(std::numeric_limits<Size>::max())).size();
+        m_stream << formatHeader(header(0), m_headerLength);
+    }
+
+    ~Writer() {
+        // Errors only surface from an explicit close
+        try {
+            close();
+        } catch (const FileError&) {
+        }
+    }
+
+    Writer(const Writer&)            = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // rows is either a single row of the row shape or a block of rows with one more leading dimension
+    template<NDArrayLike A>
+        requires std::is_same_v<std::remove_cv_t<typename A::Type>, T>
+    void append(const A& rows) {
+        const Size rank   = static_cast<Size>(rows.shape().size());
+        const bool single = Shape(rows.shape().begin(), rows.shape().end()) == m_rowShape;
+        if (!single && (rank != static_cast<Size>(m_rowShape.size()) + 1 ||
+                        !std::equal(m_rowShape.begin(), m_rowShape.end(), rows.shape().begin() + 1))) {
+            throw LayoutMismatch("Appended rows do not match the row shape");
+        }
+        detail::writeElements(m_stream, rows);
+        m_rows += single ? 1 : rows.shape(0);
+    }
+
+    // Records the rows appended so far in the header and flushes the file
+    void flush() {
+        const auto end = m_stream.tellp();
+        m_stream.seekp(0);
+        m_stream << formatHeader(header(m_rows), m_headerLength);
+        m_stream.seekp(end);
+        m_stream.flush();
+        if (!m_stream) {
+            throw FileError("Cannot write " + m_path);
+        }
+    }
+
+    void close() {
+        if (m_stream.is_open()) {
+            flush();
+            m_stream.close();
+        }
+    }
+
+    Size rows() const { return m_rows; }
+
+private:
+    Header header(const Size rows) const {
+        Header result{descr<T>(), false, {rows}};
+        for (const Size dim : m_rowShape) {
+            result.shape.push_back(dim);
+        }
+        return result;
+    }
+
+private:
+    std::string m_path;
+    std::ofstream m_stream;
+    Shape m_rowShape;
+    Size m_rows;
+    std::size_t m_headerLength;
+};
+
+}  // namespace nykdtb::npy
+
+#endif
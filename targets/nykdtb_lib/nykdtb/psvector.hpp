@@ -1,16 +1,46 @@
 #ifndef NYKDTB_PSVECTOR_HPP
 #define NYKDTB_PSVECTOR_HPP
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <utility>
 
+#include "nykdtb/allocator.hpp"
 #include "nykdtb/types.hpp"
 
 namespace nykdtb {
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT = alignof(T)>
+// Types whose objects may be moved to another address by copying their bytes, without running the move
+// constructor and the destructor. True for trivially copyable types, specialize it to opt in others.
+template<typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// Capacity policy of PartialStackStorageVector. Outgrowing the capacity reallocates to GROWTH_PERCENT of
+// the required size. Heap storage is only released on shrink_to_fit or once the size dropped to a
+// SHRINK_DIVISOR-th of the capacity, so sizes going back and forth around a boundary do not reallocate.
+template<Size GROWTH_PERCENT = 200, Size SHRINK_DIVISOR = 4>
+struct PSVecGrowth {
+    static_assert(GROWTH_PERCENT > 100 && SHRINK_DIVISOR > 1);
+
+    static constexpr Size grow(const Size required) {
+        const int64_t result = static_cast<int64_t>(required) * GROWTH_PERCENT / 100;
+        return static_cast<Size>(std::clamp<int64_t>(result, required + 1, std::numeric_limits<Size>::max()));
+    }
+
+    static constexpr bool shouldShrink(const Size size, const Size capacity) {
+        return static_cast<int64_t>(size) * SHRINK_DIVISOR <= capacity;
+    }
+};
+
+template<typename T,
+         Size STACK_SIZE,
+         Size ALIGNMENT = alignof(T),
+         AllocatorPolicy ALLOCATOR = MallocAllocator,
+         typename GROWTH = PSVecGrowth<>>
 class PartialStackStorageVector {
 public:
     NYKDTB_DEFINE_EXCEPTION_CLASS(IncorrectSizeAllocation, LogicException)
@@ -31,10 +61,6 @@ public:
     static constexpr auto copyConstruct = [](T& lhs, const T& rhs) { new (&lhs) T{rhs}; };
     static constexpr auto copyAssign    = [](T& lhs, const T& rhs) { lhs = rhs; };
 
-    template<typename P>
-    static constexpr P aaligned(P p) {
-        return mmove(p);
-    }
     static constexpr T* aaligned(T* p) { return std::assume_aligned<ALIGNMENT>(p); }
     static constexpr const T* aaligned(const T* p) { return std::assume_aligned<ALIGNMENT>(p); }
 
@@ -50,7 +76,7 @@ public:
 
     static inline PartialStackStorageVector constructFilled(Size size, const T& input) {
         PartialStackStorageVector result;
-        result.ensureAllocatedSize(size);
+        result.reserve(size);
         result.m_currentSize = size;
         for (auto& value : result) {
             new (&value) T{input};
@@ -58,9 +84,34 @@ public:
         return mmove(result);
     }
 
+    // Heap storage comes from allocateZeroed when the allocator policy has one
+    static inline PartialStackStorageVector constructZeroed(Size size)
+        requires std::is_arithmetic_v<T>
+    {
+        PartialStackStorageVector result;
+        if (size > STACK_SIZE) {
+            result.m_heapStorage   = allocateZeroedMemory(size);
+            result.m_allocatedSize = size;
+        } else if (size > 0) {
+            std::memset(result.stackBegin(), 0, static_cast<std::size_t>(size) * sizeof(T));
+        }
+        result.m_currentSize = size;
+        return mmove(result);
+    }
+
+    // Elements are left uninitialized, for callers that overwrite all of them
+    static inline PartialStackStorageVector constructUninitialized(Size size)
+        requires(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>)
+    {
+        PartialStackStorageVector result;
+        result.reserve(size);
+        result.m_currentSize = size;
+        return mmove(result);
+    }
+
     inline PartialStackStorageVector transformed(std::function<T(T)> transformer) const {
         PartialStackStorageVector result;
-        result.ensureAllocatedSize(size());
+        result.reserve(size());
         result.m_currentSize = size();
         for (Index i = 0; i < size(); ++i) {
             new (&result[i]) T{transformer((*this)[i])};
@@ -87,6 +138,21 @@ public:
     inline ~PartialStackStorageVector();
 
     inline Size size() const { return m_currentSize; }
+    inline Size capacity() const { return onStack() ? STACK_SIZE : m_allocatedSize; }
+
+    // Makes room for capacity elements without further reallocation
+    inline void reserve(const Size capacity) {
+        if (capacity > this->capacity()) {
+            reallocate(capacity);
+        }
+    }
+
+    // Moves the elements back to the stack if they fit, otherwise into a heap block of exactly their size
+    inline void shrink_to_fit() {
+        if (!onStack() && m_currentSize < m_allocatedSize) {
+            reallocate(m_currentSize);
+        }
+    }
 
     inline Pointer begin() {
         if (onStack()) {
@@ -104,8 +170,9 @@ public:
         }
     }
 
-    inline Pointer ptr(const Index idx) { return aaligned(&begin()[idx]); }
-    inline ConstPointer ptr(const Index idx) const { return aaligned(&begin()[idx]); }
+    // Only the storage begins on an ALIGNMENT boundary, the alignment carries over from begin()
+    inline Pointer ptr(const Index idx) { return begin() + idx; }
+    inline ConstPointer ptr(const Index idx) const { return begin() + idx; }
 
     inline Pointer end() { return ptr(m_currentSize); }
     inline ConstPointer end() const { return ptr(m_currentSize); }
@@ -137,17 +204,32 @@ public:
 
         if (oldSize > newSize) {
             m_currentSize = newSize;
-            ensureAllocatedSize(m_currentSize);
+            releaseExcess();
         } else {
-            ensureAllocatedSize(newSize);
+            ensureExactAllocatedSize(newSize);
             m_currentSize = newSize;
         }
 
-        for (Index i = oldSize; i < newSize; ++i) {
+        // Bounded by the capacity, so the compiler does not assume a heap sized fill of the stack
+        const Size filledEnd = std::min(newSize, capacity());
+        for (Index i = oldSize; i < filledEnd; ++i) {
             new (ptr(i)) T{init};
         }
     }
 
+    // Same as resize, but the added elements are left uninitialized
+    inline void resizeUninitialized(Size newSize)
+        requires(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>)
+    {
+        if (m_currentSize > newSize) {
+            m_currentSize = newSize;
+            releaseExcess();
+        } else {
+            ensureExactAllocatedSize(newSize);
+            m_currentSize = newSize;
+        }
+    }
+
     inline Pointer erase(Pointer intervalBegin, Pointer intervalEnd);
     inline Pointer erase(Pointer elementIt) { return erase(elementIt, elementIt + 1); }
 
@@ -182,29 +264,57 @@ private:
     inline Pointer stackBegin() { return aaligned(reinterpret_cast<Pointer>(&m_stackStorage[0])); }
     inline ConstPointer stackBegin() const { return aaligned(reinterpret_cast<ConstPointer>(&m_stackStorage[0])); }
 
-    inline void ensureAllocatedSize(const Size size, const Size mtp = 2) {
+    inline void ensureAllocatedSize(const Size size) {
         if (m_currentSize > size) throw IncorrectSizeAllocation();
 
-        if (onStack()) {
-            if (size > STACK_SIZE) {
-                moveStackToHeapWithAllocatedSize(size * mtp);
-            }
-        } else {
-            if (size > STACK_SIZE) {
-                if (size > m_allocatedSize) {
-                    moveHeapToNewHeapWithAllocatedSize(size * mtp);
-                }
-            } else {
+        if (size > capacity()) {
+            reallocate(GROWTH::grow(size));
+        }
+    }
+
+    // Resizing names the size that is needed, only push and insert grow geometrically
+    inline void ensureExactAllocatedSize(const Size size) {
+        if (size > capacity()) {
+            reallocate(size);
+        }
+    }
+
+    inline void releaseExcess() {
+        if (!onStack() && GROWTH::shouldShrink(m_currentSize, m_allocatedSize)) {
+            reallocate(m_currentSize <= STACK_SIZE ? m_currentSize : GROWTH::grow(m_currentSize));
+        }
+    }
+
+    inline void reallocate(const Size capacity) {
+        if (capacity <= STACK_SIZE) {
+            if (!onStack()) {
                 moveHeapToStack();
             }
+        } else if (onStack()) {
+            moveStackToHeapWithAllocatedSize(capacity);
+        } else {
+            moveHeapToNewHeapWithAllocatedSize(capacity);
         }
     }
 
     static inline Pointer allocateMemory(const Size elemCount) {
-        return reinterpret_cast<Pointer>(std::aligned_alloc(ALIGNMENT, elemCount * sizeof(T)));
+        return static_cast<Pointer>(ALLOCATOR::allocate(elemCount * sizeof(T), ALIGNMENT));
     }
 
-    static inline void free(Pointer ptr) { std::free(ptr); }
+    static inline Pointer allocateZeroedMemory(const Size elemCount) {
+        const std::size_t bytes = static_cast<std::size_t>(elemCount) * sizeof(T);
+        if constexpr (ZeroingAllocatorPolicy<ALLOCATOR>) {
+            return static_cast<Pointer>(ALLOCATOR::allocateZeroed(bytes, ALIGNMENT));
+        } else {
+            Pointer result = allocateMemory(elemCount);
+            std::memset(result, 0, bytes);
+            return result;
+        }
+    }
+
+    static inline void free(Pointer ptr, const Size elemCount) {
+        ALLOCATOR::deallocate(ptr, elemCount * sizeof(T), ALIGNMENT);
+    }
 
     inline void moveStackToHeapWithAllocatedSize(const Size allocatedSize) {
         m_allocatedSize = allocatedSize;
@@ -214,45 +324,76 @@ private:
     }
 
     inline void moveHeapToNewHeapWithAllocatedSize(const Size allocatedSize) {
-        m_allocatedSize = allocatedSize;
-        Pointer newHeap = allocateMemory(m_allocatedSize);
+        Pointer newHeap = allocateMemory(allocatedSize);
         transfer(&m_heapStorage[0], &m_heapStorage[m_currentSize], newHeap, moveConstruct);
-        free(m_heapStorage);
-        m_heapStorage = newHeap;
+        free(m_heapStorage, m_allocatedSize);
+        m_heapStorage   = newHeap;
+        m_allocatedSize = allocatedSize;
     }
 
     inline void moveHeapToStack() {
         transfer(&m_heapStorage[0], &m_heapStorage[m_currentSize], stackBegin(), moveConstruct);
+        free(m_heapStorage, m_allocatedSize);
         m_allocatedSize = STACK_SIZE;
-        free(m_heapStorage);
-        m_heapStorage = nullptr;
+        m_heapStorage   = nullptr;
+    }
+
+    // Transfers that can be done with a memmove: relocating trivially relocatable elements, or any
+    // transfer of trivially copyable ones, between arrays of T
+    template<typename Op, typename Known>
+    static constexpr bool isOp(const Known&) {
+        return std::is_same_v<Op, Known>;
+    }
+
+    template<typename PS, typename PT, typename Op>
+    static constexpr bool isBytewise() {
+        if constexpr (!std::is_pointer_v<PS> || !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<PS>>, T> ||
+                      !std::is_same_v<PT, T*>) {
+            return false;
+        } else if constexpr (std::is_trivially_copyable_v<T>) {
+            return isOp<Op>(moveConstruct) || isOp<Op>(moveAssign) || isOp<Op>(copyConstruct) || isOp<Op>(copyAssign);
+        } else {
+            return IsTriviallyRelocatable<T>::value && isOp<Op>(moveConstruct);
+        }
+    }
+
+    template<typename PS, typename PT, typename Op>
+    static constexpr bool bytewise = isBytewise<PS, PT, Op>();
+
+    template<typename PS>
+    static inline void moveBytes(PS begin, PS end, T* target) {
+        if (end > begin) {
+            std::memmove(static_cast<void*>(target),
+                         static_cast<const void*>(begin),
+                         static_cast<std::size_t>(end - begin) * sizeof(T));
+        }
     }
 
     template<typename PS, typename PT, typename Op>
     inline void transfer(PS begin_, PS end_, PT target_, Op op) {
-        auto begin  = aaligned(begin_);
-        auto end    = aaligned(end_);
-        auto target = aaligned(target_);
-        for (auto i = begin; i < end; ++i) {
+        if constexpr (bytewise<PS, PT, Op>) {
+            moveBytes(begin_, end_, target_);
+            return;
+        }
+        auto target = target_;
+        for (auto i = begin_; i < end_; ++i) {
             op(*(target++), std::move(*i));
         }
     }
 
     template<typename PS, typename PT, typename Op>
     inline void reverseTransfer(PS begin_, PS end_, PT target_, Op op) {
-        auto begin  = aaligned(begin_);
-        auto end    = aaligned(end_);
-        auto target = aaligned(target_);
-        --target;
-        --begin;
-        for (auto i = begin; i >= end; --i) {
+        if constexpr (bytewise<PS, PT, Op>) {
+            moveBytes(end_, begin_, target_ - (begin_ - end_));
+            return;
+        }
+        auto target = target_ - 1;
+        for (auto i = begin_ - 1; i >= end_; --i) {
             op(*(target--), std::move(*i));
         }
     }
 
-    inline void destruct(Pointer begin_, Pointer end_) {
-        auto begin = aaligned(begin_);
-        auto end   = aaligned(end_);
+    inline void destruct(Pointer begin, Pointer end) {
         for (auto it = begin; it < end; ++it) {
             it->~T();
         }
@@ -265,38 +406,42 @@ private:
     T* m_heapStorage;
 };
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::PartialStackStorageVector()
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::PartialStackStorageVector()
     : m_currentSize(0), m_allocatedSize(STACK_SIZE), m_heapStorage(nullptr) {}
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
 template<typename Iter, typename Op>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::PartialStackStorageVector(Iter _begin, Iter _end, Op op)
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::PartialStackStorageVector(
+    Iter _begin, Iter _end, Op op)
     : m_currentSize(0), m_allocatedSize(STACK_SIZE), m_heapStorage(nullptr) {
     const Size targetSize = static_cast<Size>(_end - _begin);
-    ensureAllocatedSize(targetSize);
+    reserve(targetSize);
     transfer(_begin, _end, begin(), op);
     m_currentSize = targetSize;
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::PartialStackStorageVector(std::initializer_list<T> init)
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::PartialStackStorageVector(
+    std::initializer_list<T> init)
     : PartialStackStorageVector(init.begin(), init.end()) {}
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::PartialStackStorageVector(
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::PartialStackStorageVector(
     const PartialStackStorageVector& other)
     : m_currentSize(0), m_allocatedSize(STACK_SIZE), m_heapStorage(nullptr) {
-    ensureAllocatedSize(other.m_currentSize);
+    reserve(other.m_currentSize);
     transfer(other.begin(), other.end(), begin(), copyConstruct);
     m_currentSize = other.m_currentSize;
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::PartialStackStorageVector(PartialStackStorageVector&& other)
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::PartialStackStorageVector(
+    PartialStackStorageVector&& other)
     : m_currentSize(other.m_currentSize), m_allocatedSize(STACK_SIZE), m_heapStorage(nullptr) {
     if (other.onStack()) {
-        transfer(other.begin(), other.end(), begin(), moveConstruct);
+        // Bounded by STACK_SIZE, so the compiler does not assume a heap sized copy into the stack
+        transfer(other.stackBegin(), other.stackBegin() + std::min(m_currentSize, STACK_SIZE), begin(), moveConstruct);
     } else {
         m_heapStorage   = other.m_heapStorage;
         m_allocatedSize = other.m_allocatedSize;
@@ -306,23 +451,25 @@ inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::PartialStackStorageV
     other.m_allocatedSize = 0;
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>&
-PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::operator=(const PartialStackStorageVector& other) {
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>&
+PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::operator=(
+    const PartialStackStorageVector& other) {
     const Size commonPartSize = std::min(m_currentSize, other.m_currentSize);
 
-    ensureAllocatedSize(other.m_currentSize);
+    reserve(other.m_currentSize);
     transfer(other.begin(), other.ptr(commonPartSize), begin(), copyAssign);
     destruct(ptr(commonPartSize), ptr(m_currentSize));
     transfer(other.ptr(commonPartSize), other.ptr(other.m_currentSize), ptr(commonPartSize), copyConstruct);
 
     m_currentSize = other.m_currentSize;
+    releaseExcess();
     return *this;
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>&
-PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::operator=(PartialStackStorageVector&& other) {
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>&
+PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::operator=(PartialStackStorageVector&& other) {
     if (other.onStack()) {
         const Size commonPartSize = std::min(m_currentSize, other.m_currentSize);
         if (m_currentSize < other.m_currentSize) {
@@ -333,7 +480,9 @@ PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::operator=(PartialStackStora
         transfer(other.ptr(commonPartSize), other.ptr(other.m_currentSize), ptr(commonPartSize), moveConstruct);
     } else {
         destruct(begin(), end());
-        free(m_heapStorage);
+        if (!onStack()) {
+            free(m_heapStorage, m_allocatedSize);
+        }
         m_heapStorage   = other.m_heapStorage;
         m_allocatedSize = other.m_allocatedSize;
     }
@@ -344,34 +493,45 @@ PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::operator=(PartialStackStora
     return *this;
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::~PartialStackStorageVector() {
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::~PartialStackStorageVector() {
     destruct(begin(), end());
     if (!onStack()) {
-        free(m_heapStorage);
+        free(m_heapStorage, m_allocatedSize);
     }
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
-inline typename PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::Pointer
-PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::erase(Pointer intervalBegin, Pointer intervalEnd) {
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
+inline typename PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::Pointer
+PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::erase(
+    Pointer intervalBegin, Pointer intervalEnd) {
+    Pointer originalBegin        = this->begin();
     Pointer originalEnd          = this->end();
     Size erasedElemCount         = static_cast<Size>(intervalEnd - intervalBegin);
     Pointer endIteratorAfterMove = originalEnd - erasedElemCount;
 
-    transfer(intervalEnd, intervalEnd + erasedElemCount, intervalBegin, moveAssign);
-    transfer(intervalEnd + erasedElemCount, originalEnd, intervalEnd, moveConstruct);
-    destruct(endIteratorAfterMove, originalEnd);
+    if constexpr (bytewise<Pointer, Pointer, std::remove_cv_t<decltype(moveConstruct)>>) {
+        // Relocation leaves the vacated slots as raw bytes, so only the erased elements are destroyed
+        destruct(intervalBegin, intervalEnd);
+        moveBytes(intervalEnd, originalEnd, intervalBegin);
+    } else {
+        // The elements behind the interval are assigned into it, the remaining ones are moved down
+        const Size assignedCount = std::min(erasedElemCount, static_cast<Size>(originalEnd - intervalEnd));
+        transfer(intervalEnd, intervalEnd + assignedCount, intervalBegin, moveAssign);
+        transfer(intervalEnd + assignedCount, originalEnd, intervalBegin + assignedCount, moveConstruct);
+        destruct(endIteratorAfterMove, originalEnd);
+    }
 
     m_currentSize -= erasedElemCount;
-    ensureAllocatedSize(m_currentSize);
-    return intervalBegin;
+    releaseExcess();
+    return begin() + (intervalBegin - originalBegin);
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT>
+template<typename T, Size STACK_SIZE, Size ALIGNMENT, AllocatorPolicy ALLOCATOR, typename GROWTH>
 template<typename SIter>
-inline typename PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::Pointer
-PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::insert(Pointer before, SIter first, SIter last) {
+inline typename PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::Pointer
+PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>::insert(
+    Pointer before, SIter first, SIter last) {
     Size insertedElemCount = static_cast<Size>(last - first);
     Index beforeIndex      = before - begin();
     ensureAllocatedSize(m_currentSize + insertedElemCount);
@@ -385,8 +545,12 @@ PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>::insert(Pointer before, SIte
     return before;
 }
 
-template<typename T, Size STACK_SIZE, Size ALIGNMENT = alignof(T)>
-using PSVec = PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT>;
+template<typename T,
+         Size STACK_SIZE,
+         Size ALIGNMENT = alignof(T),
+         AllocatorPolicy ALLOCATOR = MallocAllocator,
+         typename GROWTH = PSVecGrowth<>>
+using PSVec = PartialStackStorageVector<T, STACK_SIZE, ALIGNMENT, ALLOCATOR, GROWTH>;
 
 template<typename T>
 using PSVec8 = PSVec<T, 8>;
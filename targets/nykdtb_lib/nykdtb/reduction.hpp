@@ -0,0 +1,483 @@
+#ifndef NYKDTB_REDUCTION_HPP
+#define NYKDTB_REDUCTION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/simd.hpp"
+#include "nykdtb/threadpool.hpp"
+
+namespace nykdtb::nda::reduction {
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(InvalidAxis, LogicException)
+NYKDTB_DEFINE_EXCEPTION_CLASS(EmptyReduction, LogicException)
+
+struct Blocking {
+    // Contiguous runs are reduced in blocks of this many elements, the blocks are combined pairwise
+    static constexpr Size PAIRWISE_BLOCK = 1024;
+    // Rows folded into per-lane accumulators before the partial results are combined pairwise
+    static constexpr Size PAIRWISE_ROWS = 64;
+    // Output lanes reduced together when the reduced axis is the outer one in memory
+    static constexpr Size LANE_BLOCK = 256;
+    // Elements handled by one task. Task boundaries only depend on the shape, so the result is
+    // the same for every thread count.
+    static constexpr Size TASK_ELEMENTS = 1 << 16;
+};
+
+template<typename T, typename F>
+concept SimdReducible = simd::Vectorizable<T> && requires { F::SIMD_OP; };
+
+// Sum of a run, pairwise over PAIRWISE_BLOCK sized blocks. Blocks of unit stride vectorizable
+// runs go to the SIMD kernels.
+template<typename F, typename T>
+inline static T pairwiseRun(const T* data, const Index stride, const Size count) {
+    if (count <= Blocking::PAIRWISE_BLOCK) {
+        if constexpr (SimdReducible<T, F>) {
+            if (stride == 1) {
+                return simd::reduce(F::SIMD_OP, data, count);
+            }
+        }
+        T result = T{0};
+        for (Index i = 0; i < count; ++i, data += stride) {
+            result += F::square(*data);
+        }
+        return result;
+    }
+    const Size blocks = (count + Blocking::PAIRWISE_BLOCK - 1) / Blocking::PAIRWISE_BLOCK;
+    const Size half   = (blocks + 1) / 2 * Blocking::PAIRWISE_BLOCK;
+    return pairwiseRun<F>(data, stride, half) + pairwiseRun<F>(data + half * stride, stride, count - half);
+}
+
+// Ops fold elements into an accumulator. Accumulators of consecutive ranges are merged in order
+// and finish turns the accumulator of count elements into the result. run reduces a whole run
+// and foldRow folds one row into a block of per-lane accumulators.
+struct Sum {
+    template<typename T>
+    using Acc = T;
+    template<typename T>
+    using Result                            = T;
+    static constexpr bool ALLOWS_EMPTY      = true;
+    static constexpr simd::ReduceOp SIMD_OP = simd::ReduceOp::Sum;
+
+    template<typename T>
+    static T square(const T value) {
+        return value;
+    }
+    template<typename T>
+    static T identity() {
+        return T{0};
+    }
+    template<typename T>
+    static T run(const T* data, const Index stride, const Size count, Index) {
+        return pairwiseRun<Sum>(data, stride, count);
+    }
+    template<typename T>
+    static void foldRow(T* acc, const T* row, const Index laneStride, const Size lanes, Index) {
+        if constexpr (simd::Vectorizable<T>) {
+            if (laneStride == 1) {
+                simd::accumulate(SIMD_OP, acc, row, lanes);
+                return;
+            }
+        }
+        for (Index j = 0; j < lanes; ++j, row += laneStride) {
+            acc[j] += *row;
+        }
+    }
+    template<typename T>
+    static void merge(T& acc, const T& next) {
+        acc += next;
+    }
+    template<typename T>
+    static void offset(T&, Index) {}
+    template<typename T>
+    static T finish(const T& acc, Size) {
+        return acc;
+    }
+};
+
+struct Mean : Sum {
+    static constexpr bool ALLOWS_EMPTY = false;
+
+    template<typename T>
+    static T finish(const T& acc, const Size count) {
+        return acc / static_cast<T>(count);
+    }
+};
+
+// Euclidean norm of the reduced elements, for floating point types only
+struct Norm : Sum {
+    static constexpr simd::ReduceOp SIMD_OP = simd::ReduceOp::SumSquares;
+
+    template<typename T>
+    static T square(const T value) {
+        return value * value;
+    }
+    template<typename T>
+    static T run(const T* data, const Index stride, const Size count, Index) {
+        return pairwiseRun<Norm>(data, stride, count);
+    }
+    template<typename T>
+    static void foldRow(T* acc, const T* row, const Index laneStride, const Size lanes, Index) {
+        if constexpr (simd::Vectorizable<T>) {
+            if (laneStride == 1) {
+                simd::accumulate(SIMD_OP, acc, row, lanes);
+                return;
+            }
+        }
+        for (Index j = 0; j < lanes; ++j, row += laneStride) {
+            acc[j] += *row * *row;
+        }
+    }
+    template<typename T>
+    static T finish(const T& acc, Size) {
+        static_assert(std::is_floating_point_v<T>, "The norm of integers would be truncated");
+        return std::sqrt(acc);
+    }
+};
+
+template<bool IS_MIN>
+struct Extreme {
+    template<typename T>
+    using Acc = T;
+    template<typename T>
+    using Result                            = T;
+    static constexpr bool ALLOWS_EMPTY      = false;
+    static constexpr simd::ReduceOp SIMD_OP = IS_MIN ? simd::ReduceOp::Min : simd::ReduceOp::Max;
+
+    template<typename T>
+    static T identity() {
+        if constexpr (std::numeric_limits<T>::has_infinity) {
+            return IS_MIN ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+        } else {
+            return IS_MIN ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+        }
+    }
+    template<typename T>
+    static T run(const T* data, const Index stride, const Size count, Index) {
+        if constexpr (simd::Vectorizable<T>) {
+            if (stride == 1) {
+                return simd::reduce(SIMD_OP, data, count);
+            }
+        }
+        T result = identity<T>();
+        for (Index i = 0; i < count; ++i, data += stride) {
+            merge(result, *data);
+        }
+        return result;
+    }
+    template<typename T>
+    static void foldRow(T* acc, const T* row, const Index laneStride, const Size lanes, Index) {
+        if constexpr (simd::Vectorizable<T>) {
+            if (laneStride == 1) {
+                simd::accumulate(SIMD_OP, acc, row, lanes);
+                return;
+            }
+        }
+        for (Index j = 0; j < lanes; ++j, row += laneStride) {
+            merge(acc[j], *row);
+        }
+    }
+    // NaN propagates, the same as in the SIMD kernels
+    template<typename T>
+    static void merge(T& acc, const T& next) {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (std::isnan(next)) {
+                acc = next;
+                return;
+            }
+        }
+        if (IS_MIN ? next < acc : acc < next) {
+            acc = next;
+        }
+    }
+    template<typename T>
+    static void offset(T&, Index) {}
+    template<typename T>
+    static T finish(const T& acc, Size) {
+        return acc;
+    }
+};
+
+using Min = Extreme<true>;
+using Max = Extreme<false>;
+
+// Index of the first maximum along the axis, or the logical linear index for full reductions
+struct ArgMax {
+    template<typename T>
+    struct Acc {
+        T value;
+        Index index;
+    };
+    template<typename T>
+    using Result                       = Index;
+    static constexpr bool ALLOWS_EMPTY = false;
+
+    template<typename T>
+    static Acc<T> identity() {
+        return {Max::identity<T>(), -1};
+    }
+    // Contiguous runs find the maximum with the SIMD kernel first, then search for its first position
+    template<typename T>
+    static Acc<T> run(const T* data, const Index stride, const Size count, const Index indexBase) {
+        if constexpr (simd::Vectorizable<T>) {
+            if (stride == 1) {
+                const T maximum = simd::reduce(simd::ReduceOp::Max, data, count);
+                const T* found  = std::find(data, data + count, maximum);
+                if (found != data + count) {
+                    return {maximum, indexBase + static_cast<Index>(found - data)};
+                }
+            }
+        }
+        Acc<T> result = identity<T>();
+        for (Index i = 0; i < count; ++i, data += stride) {
+            merge(result, Acc<T>{*data, indexBase + i});
+        }
+        return result;
+    }
+    template<typename T>
+    static void foldRow(Acc<T>* acc, const T* row, const Index laneStride, const Size lanes, const Index index) {
+        for (Index j = 0; j < lanes; ++j, row += laneStride) {
+            merge(acc[j], Acc<T>{*row, index});
+        }
+    }
+    template<typename T>
+    static void merge(Acc<T>& acc, const Acc<T>& next) {
+        if (acc.index < 0 || acc.value < next.value) {
+            acc = next;
+        }
+    }
+    template<typename T>
+    static void offset(Acc<T>& acc, const Index offset) {
+        acc.index += offset;
+    }
+    template<typename T>
+    static Index finish(const Acc<T>& acc, Size) {
+        return acc.index;
+    }
+};
+
+// A reduction of a strided array along one axis. The remaining dimensions are the outputs, the
+// last of them is walked as lanes. When the lanes are denser in memory than the reduced axis, rows
+// of lanes are folded at once (vertical mode), otherwise each lane reduces its own run.
+template<typename T>
+class Plan {
+public:
+    using Dims = typename StridedLayout<const T>::Dims;
+
+public:
+    Plan(const StridedLayout<const T>& layout, const Index axis) {
+        const Size depth = static_cast<Size>(layout.shape.size());
+        m_length         = layout.shape[axis];
+        m_axisStride     = layout.strides[axis];
+        for (Index i = 0; i < depth; ++i) {
+            if (i != axis) {
+                m_outputShape.push_back(layout.shape[i]);
+                m_outputStrides.push_back(layout.strides[i]);
+            }
+        }
+        initialize();
+    }
+
+    // Reduction over all elements: dimensions that are contiguous in logical order are merged and
+    // the last one is reduced. The outputs then hold the partial results of consecutive runs.
+    static Plan all(const StridedLayout<const T>& layout) {
+        Dims shape;
+        Dims strides;
+        for (Index i = 0; i < static_cast<Size>(layout.shape.size()); ++i) {
+            const Size size = layout.shape[i];
+            if (size == 1) {
+                continue;
+            }
+            const Index last = static_cast<Size>(shape.size()) - 1;
+            if (last >= 0 && strides[last] == layout.strides[i] * size) {
+                shape[last] *= size;
+                strides[last] = layout.strides[i];
+            } else {
+                shape.push_back(size);
+                strides.push_back(layout.strides[i]);
+            }
+        }
+        if (shape.empty()) {
+            shape.push_back(1);
+            strides.push_back(1);
+        }
+        return Plan(StridedLayout<const T>{layout.data, mmove(shape), mmove(strides)},
+                    static_cast<Size>(shape.size()) - 1);
+    }
+
+    const Dims& outputShape() const { return m_outputShape; }
+    Size outputCount() const { return m_outerCount * m_lanes; }
+    Size length() const { return m_length; }
+    Index axisStride() const { return m_axisStride; }
+    Size lanes() const { return m_lanes; }
+    Index laneStride() const { return m_laneStride; }
+    bool vertical() const { return m_vertical; }
+
+    Size chunkLength() const { return m_chunkLength; }
+    Size chunkCount() const { return m_chunkCount; }
+    Size laneBlock() const { return m_laneBlock; }
+    Size laneBlockCount() const { return m_laneBlockCount; }
+    Size taskCount() const { return m_outerCount * m_laneBlockCount * m_chunkCount; }
+
+    // Offset of the first lane of the outer-th row of outputs
+    Index outerOffset(Index outer) const {
+        Index result = 0;
+        for (Index i = static_cast<Size>(m_outputShape.size()) - 2; i >= 0; --i) {
+            result += (outer % m_outputShape[i]) * m_outputStrides[i];
+            outer /= m_outputShape[i];
+        }
+        return result;
+    }
+
+private:
+    void initialize() {
+        const Index last = static_cast<Size>(m_outputShape.size()) - 1;
+        m_lanes          = last >= 0 ? m_outputShape[last] : 1;
+        m_laneStride     = last >= 0 ? m_outputStrides[last] : 0;
+        m_outerCount     = 1;
+        for (Index i = 0; i < last; ++i) {
+            m_outerCount *= m_outputShape[i];
+        }
+        m_vertical = m_lanes > 1 && std::abs(m_laneStride) < std::abs(m_axisStride);
+
+        const Size length = std::max<Size>(1, m_length);
+        if (m_vertical) {
+            m_laneBlock   = std::min(m_lanes, Blocking::LANE_BLOCK);
+            m_chunkLength = std::max(Blocking::PAIRWISE_ROWS, Blocking::TASK_ELEMENTS / m_laneBlock);
+        } else {
+            m_chunkLength = Blocking::TASK_ELEMENTS;
+            m_laneBlock   = std::max<Size>(1, Blocking::TASK_ELEMENTS / std::min(length, Blocking::TASK_ELEMENTS));
+        }
+        m_chunkCount     = (length + m_chunkLength - 1) / m_chunkLength;
+        m_laneBlockCount = (m_lanes + m_laneBlock - 1) / m_laneBlock;
+    }
+
+private:
+    Dims m_outputShape;
+    Dims m_outputStrides;
+    Size m_length;
+    Index m_axisStride;
+    Size m_lanes;
+    Index m_laneStride;
+    Size m_outerCount;
+    bool m_vertical;
+    Size m_chunkLength;
+    Size m_chunkCount;
+    Size m_laneBlock;
+    Size m_laneBlockCount;
+};
+
+// acc[0, lanes) = reduction of rows [begin, end) where row k starts at data + k * axisStride.
+// Blocks of PAIRWISE_ROWS rows are folded in order and combined pairwise, scratch needs room for
+// lanes accumulators per recursion level.
+template<typename F, typename T, typename A>
+inline static void reduceRows(const T* data,
+                              const Index axisStride,
+                              const Index laneStride,
+                              const Size lanes,
+                              const Index begin,
+                              const Index end,
+                              A* acc,
+                              A* scratch) {
+    if (end - begin <= Blocking::PAIRWISE_ROWS) {
+        std::fill(acc, acc + lanes, F::template identity<T>());
+        for (Index k = begin; k < end; ++k) {
+            F::foldRow(acc, data + k * axisStride, laneStride, lanes, k);
+        }
+        return;
+    }
+    const Size blocks  = (end - begin + Blocking::PAIRWISE_ROWS - 1) / Blocking::PAIRWISE_ROWS;
+    const Index middle = begin + (blocks + 1) / 2 * Blocking::PAIRWISE_ROWS;
+    reduceRows<F>(data, axisStride, laneStride, lanes, begin, middle, acc, scratch + lanes);
+    reduceRows<F>(data, axisStride, laneStride, lanes, middle, end, scratch, scratch + lanes);
+    for (Index j = 0; j < lanes; ++j) {
+        F::merge(acc[j], scratch[j]);
+    }
+}
+
+// Merges the accumulators of consecutive ranges [begin, end) pairwise
+template<typename F, typename A>
+inline static A mergeRange(const A* partials, const Index begin, const Index end) {
+    if (end - begin == 1) {
+        return partials[begin];
+    }
+    const Index middle = begin + (end - begin) / 2;
+    A result           = mergeRange<F>(partials, begin, middle);
+    F::merge(result, mergeRange<F>(partials, middle, end));
+    return result;
+}
+
+// Runs the plan and calls store(output, accumulator) once for every output. Each output is
+// computed by a fixed sequence of tasks and merges, independent of the thread count.
+template<typename F, typename T, typename Store>
+inline static void execute(const Plan<T>& plan, const T* data, Store store, const Size threadCount) {
+    using A = typename F::template Acc<T>;
+    if (plan.outputCount() == 0) {
+        return;
+    }
+    if (plan.length() == 0) {
+        for (Index o = 0; o < plan.outputCount(); ++o) {
+            store(o, F::template identity<T>());
+        }
+        return;
+    }
+
+    const Size chunks = plan.chunkCount();
+    Vec<A> partials(chunks > 1 ? plan.outputCount() * chunks : 0);
+    const auto emit = [&](const Index output, const Index chunk, const A& acc) {
+        if (chunks > 1) {
+            partials[output * chunks + chunk] = acc;
+        } else {
+            store(output, acc);
+        }
+    };
+
+    // Recursion depth of reduceRows on a chunk, each level keeps one block of lane accumulators
+    Size levels = 1;
+    for (Size blocks = (plan.chunkLength() + Blocking::PAIRWISE_ROWS - 1) / Blocking::PAIRWISE_ROWS; blocks > 1;
+         blocks      = (blocks + 1) / 2) {
+        ++levels;
+    }
+    parallelRun(
+        plan.taskCount(),
+        [&](const Index task) {
+            const Index chunk     = task % chunks;
+            const Index laneBlock = (task / chunks) % plan.laneBlockCount();
+            const Index outer     = task / chunks / plan.laneBlockCount();
+            const Index laneBegin = laneBlock * plan.laneBlock();
+            const Size lanes      = std::min(plan.laneBlock(), plan.lanes() - laneBegin);
+            const Index begin     = chunk * plan.chunkLength();
+            const Index end       = std::min(plan.length(), begin + plan.chunkLength());
+            const T* base         = data + plan.outerOffset(outer) + laneBegin * plan.laneStride();
+            const Index output    = outer * plan.lanes() + laneBegin;
+
+            if (plan.vertical()) {
+                // Lane accumulators of every recursion level, allocated once per thread
+                thread_local Vec<A> acc;
+                acc.resize(lanes * (levels + 1));
+                reduceRows<F>(
+                    base, plan.axisStride(), plan.laneStride(), lanes, begin, end, acc.data(), acc.data() + lanes);
+                for (Index j = 0; j < lanes; ++j) {
+                    emit(output + j, chunk, acc[j]);
+                }
+            } else {
+                for (Index j = 0; j < lanes; ++j) {
+                    const T* run = base + j * plan.laneStride() + begin * plan.axisStride();
+                    emit(output + j, chunk, F::run(run, plan.axisStride(), end - begin, begin));
+                }
+            }
+        },
+        plan.outputCount() * plan.length() < Blocking::TASK_ELEMENTS ? 1 : threadCount);
+
+    if (chunks > 1) {
+        for (Index o = 0; o < plan.outputCount(); ++o) {
+            store(o, mergeRange<F>(partials.data() + o * chunks, 0, chunks));
+        }
+    }
+}
+
+}  // namespace nykdtb::nda::reduction
+
+#endif
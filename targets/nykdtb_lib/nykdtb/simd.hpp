@@ -0,0 +1,62 @@
+#ifndef NYKDTB_SIMD_HPP
+#define NYKDTB_SIMD_HPP
+
+#include <type_traits>
+
+#include "nykdtb/types.hpp"
+
+// Kernels for several instruction sets live side by side, each function compiled with NYKDTB_TARGET
+// for its own set and only called after runtime dispatch picked it
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define NYKDTB_SIMD_X86 1
+#define NYKDTB_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace nykdtb::simd {
+
+enum class Level { Scalar, SSE41, AVX2, AVX512 };
+enum class BinaryOp { Add, Sub, Mul, Div };
+enum class ReduceOp { Sum, SumSquares, Min, Max };
+
+template<typename T>
+concept Vectorizable = std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, int32_t>;
+
+// Best instruction set supported by the running CPU
+Level detectedLevel();
+// Instruction set the kernels currently dispatch to
+Level activeLevel();
+// Caps dispatch at the given level (clamped to detectedLevel()). Mostly useful for testing.
+void setMaxLevel(Level level);
+
+// dst[i] = dst[i] op src[i] for i in [0, count)
+void apply(BinaryOp op, float* dst, const float* src, Size count);
+void apply(BinaryOp op, double* dst, const double* src, Size count);
+void apply(BinaryOp op, int32_t* dst, const int32_t* src, Size count);
+
+// dst[i] = dst[i] op value for i in [0, count)
+void applyScalar(BinaryOp op, float* dst, float value, Size count);
+void applyScalar(BinaryOp op, double* dst, double value, Size count);
+void applyScalar(BinaryOp op, int32_t* dst, int32_t value, Size count);
+
+// Reduction of count contiguous values with several independent vector accumulators. Sums are
+// accumulated in a fixed order for a given level, callers add pairwise blocking on top for accuracy.
+// Min and Max need count > 0 and return NaN when any value is NaN, on every level.
+float reduce(ReduceOp op, const float* src, Size count);
+double reduce(ReduceOp op, const double* src, Size count);
+int32_t reduce(ReduceOp op, const int32_t* src, Size count);
+
+// Folds a row into per-lane accumulators: dst[i] = dst[i] op src[i] for i in [0, count). SumSquares
+// adds src[i] * src[i].
+void accumulate(ReduceOp op, float* dst, const float* src, Size count);
+void accumulate(ReduceOp op, double* dst, const double* src, Size count);
+void accumulate(ReduceOp op, int32_t* dst, const int32_t* src, Size count);
+
+// dst[c * dstStride + r] = src[r * srcStride + c] for r in [0, rows), c in [0, cols).
+// Full 4x4 (SSE4.1) or 8x8 / 4x4 double (AVX2 and up) tiles are transposed in registers.
+void transpose(const float* src, Index srcStride, float* dst, Index dstStride, Size rows, Size cols);
+void transpose(const double* src, Index srcStride, double* dst, Index dstStride, Size rows, Size cols);
+void transpose(const int32_t* src, Index srcStride, int32_t* dst, Index dstStride, Size rows, Size cols);
+
+}  // namespace nykdtb::simd
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef NYKDTB_SMALL_MATRIX_HPP
+#define NYKDTB_SMALL_MATRIX_HPP
+
+#include <type_traits>
+#include <utility>
+
+#include "nykdtb/types.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE__)
+#define NYKDTB_SMALL_MATRIX_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace nykdtb::nda::small {
+
+// Fully unrolled kernels on dense row-major matrices whose dimensions are known at compile time.
+// Everything is constexpr, the SIMD paths are only taken outside of constant evaluation.
+
+struct Limits {
+    // Products with more multiply-adds than this are left to gemm instead of being unrolled
+    static constexpr Size MAX_UNROLLED_PRODUCT = 4 * 4 * 4;
+    // Largest matrices with a closed-form determinant and inverse
+    static constexpr Size MAX_CLOSED_FORM = 4;
+};
+
+// Calls f(std::integral_constant<Index, I>{}) for I in [0, COUNT)
+template<Size COUNT, typename F>
+inline static constexpr void unroll(F&& f) {
+    [&]<Index... I>(std::integer_sequence<Index, I...>) {
+        (f(std::integral_constant<Index, I>{}), ...);
+    }(std::make_integer_sequence<Index, COUNT>{});
+}
+
+#ifdef NYKDTB_SMALL_MATRIX_SSE
+inline static void multiply4x4(const float* a, const float* b, float* c) {
+    const __m128 b0 = _mm_loadu_ps(b);
+    const __m128 b1 = _mm_loadu_ps(b + 4);
+    const __m128 b2 = _mm_loadu_ps(b + 8);
+    const __m128 b3 = _mm_loadu_ps(b + 12);
+    for (Index i = 0; i < 4; ++i) {
+        const float* row = a + i * 4;
+        __m128 result    = _mm_mul_ps(_mm_set1_ps(row[0]), b0);
+        result           = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[1]), b1));
+        result           = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[2]), b2));
+        result           = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[3]), b3));
+        _mm_storeu_ps(c + i * 4, result);
+    }
+}
+#endif
+
+// c = a * b with a being M x K and b being K x N. c must not alias the operands.
+template<typename T, Size M, Size K, Size N>
+inline static constexpr void multiply(const T* a, const T* b, T* c) {
+#ifdef NYKDTB_SMALL_MATRIX_SSE
+    if constexpr (std::is_same_v<T, float> && M == 4 && K == 4 && N == 4) {
+        if (!std::is_constant_evaluated()) {
+            multiply4x4(a, b, c);
+            return;
+        }
+    }
+#endif
+    unroll<M>([&](auto i) {
+        unroll<N>([&](auto j) {
+            T sum = a[i * K] * b[j];
+            unroll<K - 1>([&](auto k) { sum += a[i * K + k + 1] * b[(k + 1) * N + j]; });
+            c[i * N + j] = sum;
+        });
+    });
+}
+
+// out = a^T with a being M x N
+template<typename T, Size M, Size N>
+inline static constexpr void transpose(const T* a, T* out) {
+    unroll<M>([&](auto i) { unroll<N>([&](auto j) { out[j * M + i] = a[i * N + j]; }); });
+}
+
+template<typename T>
+inline static constexpr T det2(const T a, const T b, const T c, const T d) {
+    return a * d - b * c;
+}
+
+template<typename T, Size N>
+inline static constexpr T determinant(const T* a) {
+    static_assert(N >= 1 && N <= Limits::MAX_CLOSED_FORM, "No closed-form determinant for this size");
+    if constexpr (N == 1) {
+        return a[0];
+    } else if constexpr (N == 2) {
+        return det2(a[0], a[1], a[2], a[3]);
+    } else if constexpr (N == 3) {
+        return a[0] * det2(a[4], a[5], a[7], a[8]) - a[1] * det2(a[3], a[5], a[6], a[8]) +
+               a[2] * det2(a[3], a[4], a[6], a[7]);
+    } else {
+        // Laplace expansion along the two top and the two bottom rows
+        const T s0 = det2(a[0], a[1], a[4], a[5]);
+        const T s1 = det2(a[0], a[2], a[4], a[6]);
+        const T s2 = det2(a[0], a[3], a[4], a[7]);
+        const T s3 = det2(a[1], a[2], a[5], a[6]);
+        const T s4 = det2(a[1], a[3], a[5], a[7]);
+        const T s5 = det2(a[2], a[3], a[6], a[7]);
+        const T c0 = det2(a[8], a[9], a[12], a[13]);
+        const T c1 = det2(a[8], a[10], a[12], a[14]);
+        const T c2 = det2(a[8], a[11], a[12], a[15]);
+        const T c3 = det2(a[9], a[10], a[13], a[14]);
+        const T c4 = det2(a[9], a[11], a[13], a[15]);
+        const T c5 = det2(a[10], a[11], a[14], a[15]);
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+// out = a^-1 through the adjugate. Returns false if a is singular, out is left untouched then.
+template<typename T, Size N>
+inline static constexpr bool invert(const T* a, T* out) {
+    static_assert(N >= 1 && N <= Limits::MAX_CLOSED_FORM, "No closed-form inverse for this size");
+    if constexpr (N == 1) {
+        if (a[0] == T{0}) {
+            return false;
+        }
+        out[0] = T{1} / a[0];
+    } else if constexpr (N == 2) {
+        const T det = determinant<T, 2>(a);
+        if (det == T{0}) {
+            return false;
+        }
+        const T inv = T{1} / det;
+        out[0]      = a[3] * inv;
+        out[1]      = -a[1] * inv;
+        out[2]      = -a[2] * inv;
+        out[3]      = a[0] * inv;
+    } else if constexpr (N == 3) {
+        const T c00 = det2(a[4], a[5], a[7], a[8]);
+        const T c01 = -det2(a[3], a[5], a[6], a[8]);
+        const T c02 = det2(a[3], a[4], a[6], a[7]);
+        const T det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+        if (det == T{0}) {
+            return false;
+        }
+        const T inv = T{1} / det;
+        out[0]      = c00 * inv;
+        out[1]      = -det2(a[1], a[2], a[7], a[8]) * inv;
+        out[2]      = det2(a[1], a[2], a[4], a[5]) * inv;
+        out[3]      = c01 * inv;
+        out[4]      = det2(a[0], a[2], a[6], a[8]) * inv;
+        out[5]      = -det2(a[0], a[2], a[3], a[5]) * inv;
+        out[6]      = c02 * inv;
+        out[7]      = -det2(a[0], a[1], a[6], a[7]) * inv;
+        out[8]      = det2(a[0], a[1], a[3], a[4]) * inv;
+    } else {
+        const T s0  = det2(a[0], a[1], a[4], a[5]);
+        const T s1  = det2(a[0], a[2], a[4], a[6]);
+        const T s2  = det2(a[0], a[3], a[4], a[7]);
+        const T s3  = det2(a[1], a[2], a[5], a[6]);
+        const T s4  = det2(a[1], a[3], a[5], a[7]);
+        const T s5  = det2(a[2], a[3], a[6], a[7]);
+        const T c0  = det2(a[8], a[9], a[12], a[13]);
+        const T c1  = det2(a[8], a[10], a[12], a[14]);
+        const T c2  = det2(a[8], a[11], a[12], a[15]);
+        const T c3  = det2(a[9], a[10], a[13], a[14]);
+        const T c4  = det2(a[9], a[11], a[13], a[15]);
+        const T c5  = det2(a[10], a[11], a[14], a[15]);
+        const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (det == T{0}) {
+            return false;
+        }
+        const T inv = T{1} / det;
+        out[0]      = (a[5] * c5 - a[6] * c4 + a[7] * c3) * inv;
+        out[1]      = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * inv;
+        out[2]      = (a[13] * s5 - a[14] * s4 + a[15] * s3) * inv;
+        out[3]      = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * inv;
+        out[4]      = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * inv;
+        out[5]      = (a[0] * c5 - a[2] * c2 + a[3] * c1) * inv;
+        out[6]      = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv;
+        out[7]      = (a[8] * s5 - a[10] * s2 + a[11] * s1) * inv;
+        out[8]      = (a[4] * c4 - a[5] * c2 + a[7] * c0) * inv;
+        out[9]      = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * inv;
+        out[10]     = (a[12] * s4 - a[13] * s2 + a[15] * s0) * inv;
+        out[11]     = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * inv;
+        out[12]     = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * inv;
+        out[13]     = (a[0] * c3 - a[1] * c1 + a[2] * c0) * inv;
+        out[14]     = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv;
+        out[15]     = (a[8] * s3 - a[9] * s1 + a[10] * s0) * inv;
+    }
+    return true;
+}
+
+}  // namespace nykdtb::nda::small
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef NYKDTB_THREADPOOL_HPP
+#define NYKDTB_THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "nykdtb/types.hpp"
+
+namespace nykdtb {
+
+Size defaultThreadCount();
+void setDefaultThreadCount(Size threadCount);
+
+// Work-stealing pool. Every worker owns a deque of task index ranges. A thread working on a range
+// keeps splitting off its upper half onto the bottom of its own deque and runs the lower half, idle
+// workers steal the oldest, largest ranges from the top of the other deques. Threads that are not
+// workers of the pool share one extra deque.
+class ThreadPool final {
+public:
+    using Task = std::function<void(Index)>;
+
+    static constexpr Size MAX_WORKERS = 256;
+
+public:
+    explicit ThreadPool(Size workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    Size workerCount() const;
+    // Starts workers until there are workerCount of them, at most MAX_WORKERS
+    void ensureWorkerCount(Size workerCount);
+
+    // Runs task(i) for every i in [0, taskCount) and returns when all of them finished.
+    // The calling thread takes part, so at most threadCount threads work on the tasks.
+    // The first exception thrown by a task is rethrown here.
+    void run(Size taskCount, const Task& task, Size threadCount);
+
+    // Created on first use without workers, they are started when a run first needs them
+    static ThreadPool& global();
+
+private:
+    struct Job;
+    struct Range;
+    struct Queue;
+
+    Queue& localQueue();
+    void push(Queue& queue, const Range& range);
+    Optional<Range> take(Queue& queue, const Job* job, bool newest);
+    Optional<Range> steal(const Queue& self, const Job* job);
+    void process(Range range, Queue& queue);
+    void help(Job& job, Queue& queue);
+    void workerLoop(Index self);
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    // MAX_WORKERS worker deques followed by the one shared by outside threads
+    UniquePtr<Queue[]> m_queues;
+    Vec<std::thread> m_workers;
+    std::atomic<Size> m_workerCount;
+    std::atomic<Size> m_sleeping;
+    std::atomic<uint64_t> m_epoch;
+    bool m_stopping;
+};
+
+inline static void parallelRun(Size taskCount, const ThreadPool::Task& task, Size threadCount = 0) {
+    if (threadCount <= 0) {
+        threadCount = defaultThreadCount();
+    }
+    if (threadCount <= 1 || taskCount <= 1) {
+        for (Index i = 0; i < taskCount; ++i) {
+            task(i);
+        }
+        return;
+    }
+    ThreadPool::global().run(taskCount, task, threadCount);
+}
+
+// Index ranges are cut into blocks of grain consecutive indices, the units the pool distributes.
+// A grain of 0 gives every thread several blocks to balance uneven work.
+inline static Size parallelGrain(const Size count, const Size threadCount, const Size grain) {
+    constexpr Size BLOCKS_PER_THREAD = 8;
+    if (grain > 0) {
+        return grain;
+    }
+    const Size blocks = std::max<Size>(1, threadCount * BLOCKS_PER_THREAD);
+    return std::max<Size>(1, (count + blocks - 1) / blocks);
+}
+
+// Calls body(blockBegin, blockEnd) for consecutive blocks covering [begin, end).
+// threadCount of 0 uses defaultThreadCount().
+template<typename F>
+inline static void parallelFor(
+    const Index begin, const Index end, F&& body, Size threadCount = 0, const Size grain = 0) {
+    if (end <= begin) {
+        return;
+    }
+    if (threadCount <= 0) {
+        threadCount = defaultThreadCount();
+    }
+    const Size block = parallelGrain(end - begin, threadCount, grain);
+    parallelRun(
+        (end - begin + block - 1) / block,
+        [&](const Index i) {
+            const Index blockBegin = begin + i * block;
+            body(blockBegin, std::min<Index>(end, blockBegin + block));
+        },
+        threadCount);
+}
+
+// Folds reduce(blockBegin, blockEnd) of every block of [begin, end) into identity with combine. The
+// partial results are combined in block order, so the result only depends on the blocking: it is the
+// same for every run with the same thread count, or with the same explicit grain.
+template<typename T, typename R, typename C>
+inline static T parallelReduce(const Index begin,
+                               const Index end,
+                               T identity,
+                               R&& reduce,
+                               C&& combine,
+                               Size threadCount = 0,
+                               const Size grain = 0) {
+    if (end <= begin) {
+        return identity;
+    }
+    if (threadCount <= 0) {
+        threadCount = defaultThreadCount();
+    }
+    const Size block = parallelGrain(end - begin, threadCount, grain);
+    Vec<Optional<T>> partials((end - begin + block - 1) / block);
+    parallelRun(
+        static_cast<Size>(partials.size()),
+        [&](const Index i) {
+            const Index blockBegin = begin + i * block;
+            partials[i].emplace(reduce(blockBegin, std::min<Index>(end, blockBegin + block)));
+        },
+        threadCount);
+
+    T result = mmove(identity);
+    for (auto& partial : partials) {
+        result = combine(mmove(result), mmove(*partial));
+    }
+    return result;
+}
+
+}  // namespace nykdtb
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef NYKDTB_TRANSFORMS_HPP
+#define NYKDTB_TRANSFORMS_HPP
+
+#include <type_traits>
+
+#include "nykdtb/ndarray.hpp"
+
+namespace nykdtb::nda::transforms {
+
+NYKDTB_DEFINE_EXCEPTION_CLASS(TransformShapeError, RuntimeException)
+
+// Batches of count row-major dim x dim matrices, dim being 3 or 4. Items are regrouped into SoA
+// lane blocks, so each element of the results is computed for a full SIMD register of items at once.
+// A stride of 0 repeats the same matrix for every item.
+namespace kernels {
+
+// dst[i] = lhs[i] * rhs[i]
+void compose(const float* lhs, Index lhsStride, const float* rhs, Index rhsStride, float* dst, Size dim, Size count);
+void compose(
+    const double* lhs, Index lhsStride, const double* rhs, Index rhsStride, double* dst, Size dim, Size count);
+
+// dst[i] = transforms[i] * points[i] on 3D points. 4x4 transforms are affine, their last row is ignored.
+void apply(const float* transforms, Index transformStride, const float* points, float* dst, Size dim, Size count);
+void apply(const double* transforms, Index transformStride, const double* points, double* dst, Size dim, Size count);
+
+// dst[i] = 3x3 rotation by angles[i] around the unit axis axes[i]
+void axisAngle(const float* axes, const float* angles, float* dst, Size count);
+void axisAngle(const double* axes, const double* angles, double* dst, Size count);
+
+}  // namespace kernels
+
+template<typename T>
+concept TransformElement = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+// Number of matrices in a {N, dim, dim} batch
+template<NDArrayLike A>
+inline static Size batchCount(const A& batch, const Size dim) {
+    if (batch.shape().size() != 3 || batch.shape(1) != dim || batch.shape(2) != dim) {
+        throw TransformShapeError("Transform batches must have shape {N, 3, 3} or {N, 4, 4}");
+    }
+    return batch.shape(0);
+}
+
+// Batch size of two operands where a batch of 1 is repeated for every item of the other
+inline static Size broadcastCount(const Size lhs, const Size rhs) {
+    if (lhs != rhs && lhs != 1 && rhs != 1) {
+        throw TransformShapeError("Transform batch sizes do not match");
+    }
+    return lhs == 1 ? rhs : lhs;
+}
+
+// result[i] = lhs[i] * rhs[i] on {N, 3, 3} or {N, 4, 4} batches. Either side may hold a single matrix.
+template<ContiguousNDArray LHS, ContiguousNDArray RHS>
+    requires TransformElement<typename LHS::Type> && std::is_same_v<typename LHS::Type, typename RHS::Type>
+inline static NDArray<typename LHS::Type> compose(const LHS& lhs, const RHS& rhs) {
+    using Result   = NDArray<typename LHS::Type>;
+    const Size dim = lhs.shape().size() == 3 ? lhs.shape(2) : 0;
+    if (dim != 3 && dim != 4) {
+        throw TransformShapeError("Transform batches must have shape {N, 3, 3} or {N, 4, 4}");
+    }
+    const Size lhsCount = batchCount(lhs, dim);
+    const Size rhsCount = batchCount(rhs, dim);
+    const Size count    = broadcastCount(lhsCount, rhsCount);
+
+    auto result = uninitializedArray<Result>({count, dim, dim});
+    kernels::compose(lhs.begin(),
+                     lhsCount == 1 ? 0 : dim * dim,
+                     rhs.begin(),
+                     rhsCount == 1 ? 0 : dim * dim,
+                     result.begin(),
+                     dim,
+                     count);
+    return mmove(result);
+}
+
+// Transforms the {N, 3} points by a {N, dim, dim} batch or by a single {1, dim, dim} transform
+template<ContiguousNDArray TR, ContiguousNDArray P>
+    requires TransformElement<typename P::Type> && std::is_same_v<typename TR::Type, typename P::Type>
+inline static NDArray<typename P::Type> apply(const TR& transforms, const P& points) {
+    using Result   = NDArray<typename P::Type>;
+    const Size dim = transforms.shape().size() == 3 ? transforms.shape(2) : 0;
+    if (dim != 3 && dim != 4) {
+        throw TransformShapeError("Transform batches must have shape {N, 3, 3} or {N, 4, 4}");
+    }
+    if (points.shape().size() != 2 || points.shape(1) != 3) {
+        throw TransformShapeError("Point sets must have shape {N, 3}");
+    }
+    const Size transformCount = batchCount(transforms, dim);
+    if (transformCount != 1 && transformCount != points.shape(0)) {
+        throw TransformShapeError("Transform and point batch sizes do not match");
+    }
+
+    auto result = uninitializedArray<Result>({points.shape(0), 3});
+    kernels::apply(
+        transforms.begin(), transformCount == 1 ? 0 : dim * dim, points.begin(), result.begin(), dim, points.shape(0));
+    return mmove(result);
+}
+
+// {N, 3, 3} rotation matrices from {N, 3} unit axes and {N} angles in radians
+template<ContiguousNDArray AX, ContiguousNDArray AN>
+    requires TransformElement<typename AX::Type> && std::is_same_v<typename AX::Type, typename AN::Type>
+inline static NDArray<typename AX::Type> axisAngle(const AX& axes, const AN& angles) {
+    using Result = NDArray<typename AX::Type>;
+    if (axes.shape().size() != 2 || axes.shape(1) != 3) {
+        throw TransformShapeError("Rotation axes must have shape {N, 3}");
+    }
+    if (angles.shape().size() != 1 || angles.shape(0) != axes.shape(0)) {
+        throw TransformShapeError("Rotation angles must have shape {N}");
+    }
+
+    auto result = uninitializedArray<Result>({axes.shape(0), 3, 3});
+    kernels::axisAngle(axes.begin(), angles.begin(), result.begin(), axes.shape(0));
+    return mmove(result);
+}
+
+}  // namespace nykdtb::nda::transforms
+
+#endif
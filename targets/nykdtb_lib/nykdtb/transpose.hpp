@@ -0,0 +1,215 @@
+#ifndef NYKDTB_TRANSPOSE_HPP
+#define NYKDTB_TRANSPOSE_HPP
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "nykdtb/ndarray.hpp"
+#include "nykdtb/simd.hpp"
+#include "nykdtb/threadpool.hpp"
+
+namespace nykdtb::nda::transposition {
+
+template<typename T>
+struct Blocking {
+    // Blocks up to LEAF x LEAF elements are small enough for source and target lines to stay in L1
+    static constexpr Size LEAF = 64;
+    // Rows of the source handed to one task in the parallel mode
+    static constexpr Size PARALLEL_ROWS = 256;
+    // Below this many elements per thread the pool overhead dominates
+    static constexpr Size PARALLEL_ELEMENTS_PER_THREAD = 1 << 16;
+};
+
+// Copy of a strided source into a dense target with the same logical shape. Dimensions that are
+// contiguous in both are merged, size 1 dimensions are dropped. What remains is walked as a batch
+// of 2D blocks: the innermost target dimension against the dimension the source is densest in.
+template<typename T>
+class Plan {
+public:
+    using Dims = typename StridedLayout<const T>::Dims;
+
+public:
+    explicit Plan(const StridedLayout<const T>& source) {
+        const auto denseStrides = NDArrayCalc::calculateStrides<Dims, Dims>(source.shape);
+        for (Index i = 0; i < static_cast<Size>(source.shape.size()); ++i) {
+            const Size size = source.shape[i];
+            if (size == 1) {
+                continue;
+            }
+            const Index last = static_cast<Size>(m_shape.size()) - 1;
+            if (last >= 0 && m_srcStrides[last] == source.strides[i] * size &&
+                m_dstStrides[last] == denseStrides[i] * size) {
+                m_shape[last] *= size;
+                m_srcStrides[last] = source.strides[i];
+                m_dstStrides[last] = denseStrides[i];
+            } else {
+                m_shape.push_back(size);
+                m_srcStrides.push_back(source.strides[i]);
+                m_dstStrides.push_back(denseStrides[i]);
+            }
+        }
+
+        m_inner = static_cast<Size>(m_shape.size()) - 1;
+        m_outer = -1;
+        for (Index i = 0; i < m_inner; ++i) {
+            if (m_outer < 0 || std::abs(m_srcStrides[i]) < std::abs(m_srcStrides[m_outer])) {
+                m_outer = i;
+            }
+        }
+        m_batchCount = 1;
+        for (Index i = 0; i < m_inner; ++i) {
+            if (i != m_outer) {
+                m_batchCount *= m_shape[i];
+            }
+        }
+    }
+
+    // Target is filled row by row when the source is already dense along the target's inner dimension
+    bool isCopy() const { return m_inner < 0 || m_srcStrides[m_inner] == 1; }
+    Size batchCount() const { return m_batchCount; }
+
+    // Extent and strides of the 2D block: rows run along the target's inner dimension
+    Size rows() const { return m_inner < 0 ? 1 : m_shape[m_inner]; }
+    Size cols() const { return m_outer < 0 ? 1 : m_shape[m_outer]; }
+    Index srcRowStride() const { return m_inner < 0 ? 0 : m_srcStrides[m_inner]; }
+    Index srcColStride() const { return m_outer < 0 ? 0 : m_srcStrides[m_outer]; }
+    Index dstColStride() const { return m_outer < 0 ? 0 : m_dstStrides[m_outer]; }
+
+    // Offsets of the batch-th 2D block in the source and the target
+    void batchOffsets(Index batch, Index& srcOffset, Index& dstOffset) const {
+        srcOffset = 0;
+        dstOffset = 0;
+        for (Index i = m_inner - 1; i >= 0; --i) {
+            if (i == m_outer) {
+                continue;
+            }
+            const Index pos = batch % m_shape[i];
+            batch /= m_shape[i];
+            srcOffset += pos * m_srcStrides[i];
+            dstOffset += pos * m_dstStrides[i];
+        }
+    }
+
+private:
+    Dims m_shape;
+    Dims m_srcStrides;
+    Dims m_dstStrides;
+    Index m_inner;
+    Index m_outer;
+    Size m_batchCount;
+};
+
+// dst[r + c * dstColStride] = src[r * srcRowStride + c * srcColStride] on a rows x cols block
+template<typename T>
+inline static void leafBlock(const T* src,
+                             const Index srcRowStride,
+                             const Index srcColStride,
+                             T* dst,
+                             const Index dstColStride,
+                             const Size rows,
+                             const Size cols) {
+    if constexpr (simd::Vectorizable<T>) {
+        if (srcColStride == 1) {
+            simd::transpose(src, srcRowStride, dst, dstColStride, rows, cols);
+            return;
+        }
+    }
+    for (Index c = 0; c < cols; ++c) {
+        const T* in = src + c * srcColStride;
+        T* out      = dst + c * dstColStride;
+        for (Index r = 0; r < rows; ++r) {
+            out[r] = in[r * srcRowStride];
+        }
+    }
+}
+
+// Cache-oblivious recursion: the longer side is halved until the block fits a leaf
+template<typename T>
+inline static void recursiveBlock(const T* src,
+                                  const Index srcRowStride,
+                                  const Index srcColStride,
+                                  T* dst,
+                                  const Index dstColStride,
+                                  const Size rows,
+                                  const Size cols) {
+    constexpr Size LEAF = Blocking<T>::LEAF;
+    if (rows <= LEAF && cols <= LEAF) {
+        leafBlock(src, srcRowStride, srcColStride, dst, dstColStride, rows, cols);
+    } else if (rows >= cols) {
+        const Size half = std::max<Size>(8, (rows / 2) & ~Size{7});
+        recursiveBlock(src, srcRowStride, srcColStride, dst, dstColStride, half, cols);
+        recursiveBlock(
+            src + half * srcRowStride, srcRowStride, srcColStride, dst + half, dstColStride, rows - half, cols);
+    } else {
+        const Size half = std::max<Size>(8, (cols / 2) & ~Size{7});
+        recursiveBlock(src, srcRowStride, srcColStride, dst, dstColStride, rows, half);
+        recursiveBlock(src + half * srcColStride,
+                       srcRowStride,
+                       srcColStride,
+                       dst + half * dstColStride,
+                       dstColStride,
+                       rows,
+                       cols - half);
+    }
+}
+
+// Fills rows [rowBegin, rowEnd) of the batch-th block
+template<typename T>
+inline static void runBlock(
+    const Plan<T>& plan, const T* src, T* dst, const Index batch, const Index rowBegin, const Index rowEnd) {
+    Index srcOffset = 0;
+    Index dstOffset = 0;
+    plan.batchOffsets(batch, srcOffset, dstOffset);
+    src += srcOffset + rowBegin * plan.srcRowStride();
+    dst += dstOffset + rowBegin;
+
+    const Size rows = rowEnd - rowBegin;
+    if (plan.isCopy()) {
+        for (Index c = 0; c < plan.cols(); ++c) {
+            const T* in = src + c * plan.srcColStride();
+            std::copy(in, in + rows, dst + c * plan.dstColStride());
+        }
+    } else {
+        recursiveBlock(src, plan.srcRowStride(), plan.srcColStride(), dst, plan.dstColStride(), rows, plan.cols());
+    }
+}
+
+// Writes the elements of source into dense storage at dst in row-major order of the source shape
+template<typename T>
+inline static void relayout(const StridedLayout<const T>& source, T* dst) {
+    const Plan<T> plan(source);
+    for (Index batch = 0; batch < plan.batchCount(); ++batch) {
+        runBlock(plan, source.data, dst, batch, 0, plan.rows());
+    }
+}
+
+// Same as relayout, with the blocks and row ranges of large blocks spread over the thread pool
+template<typename T>
+inline static void relayoutParallel(const StridedLayout<const T>& source, T* dst, Size threadCount) {
+    using B = Blocking<T>;
+    if (threadCount <= 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    const Plan<T> plan(source);
+    const Size elements = plan.batchCount() * plan.rows() * plan.cols();
+    threadCount         = std::min(threadCount, std::max<Size>(1, elements / B::PARALLEL_ELEMENTS_PER_THREAD));
+    if (threadCount <= 1) {
+        relayout(source, dst);
+        return;
+    }
+
+    const Size rowBlocks = (plan.rows() + B::PARALLEL_ROWS - 1) / B::PARALLEL_ROWS;
+    parallelRun(
+        plan.batchCount() * rowBlocks,
+        [&](const Index task) {
+            const Index rowBegin = (task % rowBlocks) * B::PARALLEL_ROWS;
+            const Index rowEnd   = std::min(plan.rows(), rowBegin + B::PARALLEL_ROWS);
+            runBlock(plan, source.data, dst, task / rowBlocks, rowBegin, rowEnd);
+        },
+        threadCount);
+}
+
+}  // namespace nykdtb::nda::transposition
+
+#endif
@@ -20,13 +20,15 @@ static constexpr bool betweenCO(const T& lhs, const T& val, const T& rhs) {
     return lhs <= val && val < rhs;
 }
 
+// Half-open range [begin, end) of a dimension, visited every step elements. A negative step walks
+// the range backwards starting from its last element, so between(2, 8).withStep(-2) selects 7, 5, 3.
 class IndexRange {
 public:
     enum Endpoint { E };
     using EndElement = std::variant<Index, Endpoint>;
 
     constexpr IndexRange()
-        : m_begin(0), m_end(0) {}
+        : m_begin(0), m_end(0), m_step(1) {}
 
     static constexpr IndexRange e2e() { return IndexRange{0, E}; }
     static constexpr IndexRange none() { return IndexRange{0, 0}; }
@@ -34,15 +36,25 @@ public:
     static constexpr IndexRange after(Index begin) { return IndexRange{begin, E}; }
     static constexpr IndexRange between(Index begin, EndElement end) { return IndexRange{begin, end}; }
     static constexpr IndexRange single(Index elem) { return IndexRange{elem, elem + 1}; }
+    static constexpr IndexRange reversed() { return IndexRange{0, E, -1}; }
 
-    inline Size effectiveSize(Size maxValue) const { return end(maxValue) - begin(); }
+    constexpr IndexRange withStep(Index step) const { return IndexRange{m_begin, m_end, step}; }
+    // Same selection with the end endpoint replaced by maxValue
+    constexpr IndexRange resolved(Size maxValue) const { return IndexRange{m_begin, end(maxValue), m_step}; }
 
-    inline Index begin() const { return m_begin; }
-    inline Index end(Size maxValue) const {
+    inline Size effectiveSize(Size maxValue) const {
+        const Size length  = end(maxValue) - begin();
+        const Size absStep = m_step < 0 ? -m_step : m_step;
+        return length > 0 ? (length + absStep - 1) / absStep : 0;
+    }
+
+    inline constexpr Index begin() const { return m_begin; }
+    inline constexpr Index step() const { return m_step; }
+    inline constexpr Index end(Size maxValue) const {
         return std::visit(
             [maxValue](auto&& arg) -> Index {
                 using T = std::decay_t<decltype(arg)>;
-                if (std::is_same_v<T, Index>) {
+                if constexpr (std::is_same_v<T, Index>) {
                     return arg;
                 } else {
                     return maxValue;
@@ -51,13 +63,22 @@ public:
             m_end);
     }
 
+    // Index of the pos-th selected element. Ranges with a negative step must be resolved first.
+    inline Index at(Index pos) const {
+        if (m_step > 0) [[likely]] {
+            return m_begin + pos * m_step;
+        }
+        return std::get<Index>(m_end) - 1 + pos * m_step;
+    }
+
 private:
     Index m_begin;
     EndElement m_end;
+    Index m_step;
 
 private:
-    constexpr IndexRange(Index _begin, EndElement _end)
-        : m_begin{_begin}, m_end{_end} {}
+    constexpr IndexRange(Index _begin, EndElement _end, Index _step = 1)
+        : m_begin{_begin}, m_end{_end}, m_step{_step} {}
 };
 
 using IR = IndexRange;
@@ -0,0 +1,212 @@
+#include "nykdtb/allocator.hpp"
+
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define NYKDTB_ALLOCATOR_MMAP 1
+#endif
+
+namespace nykdtb {
+
+namespace {
+
+thread_local Arena* currentArena = nullptr;
+
+constexpr std::size_t ARENA_BLOCK_ALIGNMENT = 4096;
+
+std::size_t alignUp(const std::size_t value, const std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr Size POOL_CLASS_COUNT =
+    std::countr_zero(PoolAllocator::MAX_CLASS) - std::countr_zero(PoolAllocator::MIN_CLASS) + 1;
+
+// mmap returns page aligned blocks, larger alignments go through aligned_alloc
+constexpr std::size_t MAP_ALIGNMENT = 4096;
+
+bool mapped(const std::size_t bytes, const std::size_t alignment) {
+#ifdef NYKDTB_ALLOCATOR_MMAP
+    return bytes >= MallocAllocator::MAP_THRESHOLD && alignment <= MAP_ALIGNMENT;
+#else
+    (void)bytes;
+    (void)alignment;
+    return false;
+#endif
+}
+
+struct PoolCache {
+    Vec<void*> freeLists[POOL_CLASS_COUNT];
+
+    void trim() {
+        for (auto& list : freeLists) {
+            const std::size_t bytes = PoolAllocator::MIN_CLASS << (&list - freeLists);
+            for (void* block : list) {
+                MallocAllocator::deallocate(block, bytes, PoolAllocator::MIN_CLASS);
+            }
+            list.clear();
+        }
+    }
+
+    ~PoolCache();
+};
+
+thread_local PoolCache poolCache;
+// Trivially destructible, so it can still be read while other thread locals or statics are destroyed
+thread_local bool poolCacheDestroyed = false;
+
+PoolCache::~PoolCache() {
+    trim();
+    poolCacheDestroyed = true;
+}
+
+bool pooled(const std::size_t bytes, const std::size_t alignment) {
+    return bytes <= PoolAllocator::MAX_CLASS && alignment <= PoolAllocator::MIN_CLASS;
+}
+
+Index poolClass(const std::size_t bytes) {
+    return std::countr_zero(std::bit_ceil(std::max(bytes, PoolAllocator::MIN_CLASS))) -
+           std::countr_zero(PoolAllocator::MIN_CLASS);
+}
+
+}  // namespace
+
+void* MallocAllocator::allocate(const std::size_t bytes, std::size_t alignment) {
+#ifdef NYKDTB_ALLOCATOR_MMAP
+    if (mapped(bytes, alignment)) {
+        void* result = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (result == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return result;
+    }
+#endif
+    alignment = std::max(alignment, sizeof(void*));
+    // aligned_alloc only accepts sizes that are multiples of the alignment
+    void* result = std::aligned_alloc(alignment, std::max<std::size_t>(1, alignUp(bytes, alignment)));
+    if (result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void* MallocAllocator::allocateZeroed(const std::size_t bytes, const std::size_t alignment) {
+    void* result = allocate(bytes, alignment);
+    // Fresh anonymous mappings are zero already
+    if (!mapped(bytes, alignment)) {
+        std::memset(result, 0, bytes);
+    }
+    return result;
+}
+
+void MallocAllocator::deallocate(void* ptr, const std::size_t bytes, const std::size_t alignment) {
+#ifdef NYKDTB_ALLOCATOR_MMAP
+    if (mapped(bytes, alignment)) {
+        munmap(ptr, bytes);
+        return;
+    }
+#endif
+    std::free(ptr);
+}
+
+Arena::Scope::Scope(Arena& arena)
+    : m_previous(currentArena) {
+    currentArena = &arena;
+}
+
+Arena::Scope::~Scope() { currentArena = m_previous; }
+
+Arena::Arena(const std::size_t blockSize)
+    : m_current(-1), m_offset(0), m_blockSize(alignUp(blockSize, ARENA_BLOCK_ALIGNMENT)), m_used(0), m_reserved(0) {}
+
+Arena::~Arena() {
+    for (const auto& block : m_blocks) {
+        MallocAllocator::deallocate(block.begin, block.size, ARENA_BLOCK_ALIGNMENT);
+    }
+}
+
+bool Arena::fits(const Block& block, const std::size_t bytes, const std::size_t alignment) const {
+    const auto address       = reinterpret_cast<std::uintptr_t>(block.begin);
+    const std::size_t offset = alignUp(address + m_offset, alignment) - address;
+    return offset + bytes <= block.size;
+}
+
+void* Arena::allocate(const std::size_t bytes, std::size_t alignment) {
+    alignment = std::max<std::size_t>(alignment, 1);
+    if (m_current < 0 || !fits(m_blocks[m_current], bytes, alignment)) {
+        // Continue in the next block kept from before a reset, or insert a new one large enough
+        m_offset = 0;
+        ++m_current;
+        if (m_current == static_cast<Size>(m_blocks.size()) || !fits(m_blocks[m_current], bytes, alignment)) {
+            const std::size_t size = std::max(m_blockSize, alignUp(bytes + alignment, ARENA_BLOCK_ALIGNMENT));
+            auto* begin            = static_cast<std::byte*>(MallocAllocator::allocate(size, ARENA_BLOCK_ALIGNMENT));
+            m_blocks.insert(m_blocks.begin() + m_current, Block{begin, size});
+            m_reserved += size;
+        }
+    }
+
+    const Block& block       = m_blocks[m_current];
+    const auto address       = reinterpret_cast<std::uintptr_t>(block.begin);
+    const std::size_t offset = alignUp(address + m_offset, alignment) - address;
+    m_used += offset + bytes - m_offset;
+    m_offset = offset + bytes;
+    return block.begin + offset;
+}
+
+void Arena::reset() {
+    m_current = m_blocks.empty() ? -1 : 0;
+    m_offset  = 0;
+    m_used    = 0;
+}
+
+Arena* Arena::current() { return currentArena; }
+
+void* PoolAllocator::allocate(const std::size_t bytes, const std::size_t alignment) {
+    if (!pooled(bytes, alignment)) {
+        return MallocAllocator::allocate(bytes, alignment);
+    }
+    const Index index = poolClass(bytes);
+    if (!poolCacheDestroyed) {
+        auto& list = poolCache.freeLists[index];
+        if (!list.empty()) {
+            void* result = list.back();
+            list.pop_back();
+            return result;
+        }
+    }
+    return MallocAllocator::allocate(MIN_CLASS << index, MIN_CLASS);
+}
+
+void* PoolAllocator::allocateZeroed(const std::size_t bytes, const std::size_t alignment) {
+    if (!pooled(bytes, alignment)) {
+        return MallocAllocator::allocateZeroed(bytes, alignment);
+    }
+    void* result = allocate(bytes, alignment);
+    std::memset(result, 0, bytes);
+    return result;
+}
+
+void PoolAllocator::deallocate(void* ptr, const std::size_t bytes, const std::size_t alignment) {
+    if (pooled(bytes, alignment) && !poolCacheDestroyed) {
+        auto& list = poolCache.freeLists[poolClass(bytes)];
+        if (static_cast<Size>(list.size()) < MAX_CACHED) {
+            list.push_back(ptr);
+            return;
+        }
+    }
+    if (pooled(bytes, alignment)) {
+        MallocAllocator::deallocate(ptr, MIN_CLASS << poolClass(bytes), MIN_CLASS);
+    } else {
+        MallocAllocator::deallocate(ptr, bytes, alignment);
+    }
+}
+
+void PoolAllocator::trim() {
+    if (!poolCacheDestroyed) {
+        poolCache.trim();
+    }
+}
+
+}  // namespace nykdtb
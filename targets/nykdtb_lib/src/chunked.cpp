@@ -0,0 +1,547 @@
+#include "nykdtb/chunked.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string_view>
+
+#include "nykdtb/threadpool.hpp"
+
+namespace nykdtb::chunked {
+
+namespace {
+
+constexpr std::string_view MAGIC = "\x89NYKDCH\n";
+constexpr uint8_t VERSION        = 1;
+
+// LZ77 block codec in the style of LZ4: a sequence of literal runs each followed by a back reference of at
+// least MIN_MATCH bytes within the last MAX_OFFSET bytes. A sequence is a token holding the literal count
+// and the match length in its nibbles, extended by bytes of 255 when they do not fit, the literals, and
+// the offset as two little-endian bytes. The last sequence has literals only.
+constexpr std::size_t MIN_MATCH  = 4;
+constexpr std::size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS          = 14;
+// Literal runs longer than 1 << SKIP_SHIFT bytes start skipping positions, incompressible data is
+// passed over quickly
+constexpr int SKIP_SHIFT = 6;
+
+uint32_t read32(const uint8_t* data) {
+    uint32_t result;
+    std::memcpy(&result, data, sizeof(result));
+    return result;
+}
+
+std::size_t hash(const uint32_t value) { return (value * 2654435761U) >> (32 - HASH_BITS); }
+
+class BlockWriter {
+public:
+    BlockWriter(uint8_t* data, const std::size_t capacity)
+        : m_data(data), m_capacity(capacity), m_used(0) {}
+
+    // A matchLength of 0 writes the final sequence, false if the capacity is exceeded
+    bool sequence(const uint8_t* literals, const std::size_t literalCount, const std::size_t offset,
+                  const std::size_t matchLength) {
+        const std::size_t matchCode = matchLength == 0 ? 0 : matchLength - MIN_MATCH;
+        const std::size_t worst     = 1 + literalCount / 255 + 1 + literalCount + 2 + matchCode / 255 + 1;
+        if (m_capacity - m_used < worst) {
+            return false;
+        }
+        m_data[m_used++] = static_cast<uint8_t>((std::min<std::size_t>(literalCount, 15) << 4) |
+                                                std::min<std::size_t>(matchCode, 15));
+        if (literalCount >= 15) {
+            length(literalCount - 15);
+        }
+        std::memcpy(m_data + m_used, literals, literalCount);
+        m_used += literalCount;
+        if (matchLength > 0) {
+            m_data[m_used++] = static_cast<uint8_t>(offset & 0xFF);
+            m_data[m_used++] = static_cast<uint8_t>(offset >> 8);
+            if (matchCode >= 15) {
+                length(matchCode - 15);
+            }
+        }
+        return true;
+    }
+
+    std::size_t used() const { return m_used; }
+
+private:
+    void length(std::size_t value) {
+        for (; value >= 255; value -= 255) {
+            m_data[m_used++] = 255;
+        }
+        m_data[m_used++] = static_cast<uint8_t>(value);
+    }
+
+private:
+    uint8_t* m_data;
+    std::size_t m_capacity;
+    std::size_t m_used;
+};
+
+void corrupt() { throw InvalidFormat("Corrupt chunk"); }
+
+std::size_t readLength(const uint8_t* input, std::size_t& position, const std::size_t size) {
+    std::size_t result = 0;
+    uint8_t byte       = 255;
+    while (byte == 255) {
+        if (position >= size) {
+            corrupt();
+        }
+        byte = input[position++];
+        result += byte;
+    }
+    return result;
+}
+
+void shuffle(const std::byte* input, std::byte* output, const std::size_t count, const std::size_t elementSize) {
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t b = 0; b < elementSize; ++b) {
+            output[b * count + i] = input[i * elementSize + b];
+        }
+    }
+}
+
+void unshuffle(const std::byte* input, std::byte* output, const std::size_t count, const std::size_t elementSize) {
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t b = 0; b < elementSize; ++b) {
+            output[i * elementSize + b] = input[b * count + i];
+        }
+    }
+}
+
+template<typename U>
+void deltaEncode(std::byte* data, const std::size_t count) {
+    U previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        U value;
+        std::memcpy(&value, data + i * sizeof(U), sizeof(U));
+        const U difference = static_cast<U>(value - previous);
+        std::memcpy(data + i * sizeof(U), &difference, sizeof(U));
+        previous = value;
+    }
+}
+
+template<typename U>
+void deltaDecode(std::byte* data, const std::size_t count) {
+    U previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        U value;
+        std::memcpy(&value, data + i * sizeof(U), sizeof(U));
+        previous = static_cast<U>(previous + value);
+        std::memcpy(data + i * sizeof(U), &previous, sizeof(U));
+    }
+}
+
+// Other element sizes take the differences of every byte lane separately
+void delta(std::byte* data, const std::size_t size, const std::size_t elementSize, const bool encode) {
+    const std::size_t count = size / elementSize;
+    switch (elementSize) {
+        case 1:
+            return encode ? deltaEncode<uint8_t>(data, count) : deltaDecode<uint8_t>(data, count);
+        case 2:
+            return encode ? deltaEncode<uint16_t>(data, count) : deltaDecode<uint16_t>(data, count);
+        case 4:
+            return encode ? deltaEncode<uint32_t>(data, count) : deltaDecode<uint32_t>(data, count);
+        case 8:
+            return encode ? deltaEncode<uint64_t>(data, count) : deltaDecode<uint64_t>(data, count);
+        default:
+            break;
+    }
+    auto* bytes = reinterpret_cast<uint8_t*>(data);
+    if (encode) {
+        for (std::size_t i = size; i-- > elementSize;) {
+            bytes[i] = static_cast<uint8_t>(bytes[i] - bytes[i - elementSize]);
+        }
+    } else {
+        for (std::size_t i = elementSize; i < size; ++i) {
+            bytes[i] = static_cast<uint8_t>(bytes[i] + bytes[i - elementSize]);
+        }
+    }
+}
+
+bool shuffles(const Filter filter) { return filter == Filter::Shuffle || filter == Filter::DeltaShuffle; }
+
+bool deltas(const Filter filter) { return filter == Filter::Delta || filter == Filter::DeltaShuffle; }
+
+void writeLittleEndian(std::string& out, const uint64_t value, const std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// Bounds checked little-endian reads from the mapped file
+class FileReader {
+public:
+    FileReader(const std::byte* data, const std::size_t size, const std::size_t position)
+        : m_data(data), m_size(size), m_position(position) {}
+
+    uint64_t read(const std::size_t bytes) {
+        if (m_size - m_position < bytes) {
+            throw InvalidFormat("Truncated file");
+        }
+        uint64_t result = 0;
+        for (std::size_t i = 0; i < bytes; ++i) {
+            result |= static_cast<uint64_t>(m_data[m_position + i]) << (8 * i);
+        }
+        m_position += bytes;
+        return result;
+    }
+
+    std::string string(const std::size_t length) {
+        if (m_size - m_position < length) {
+            throw InvalidFormat("Truncated file");
+        }
+        std::string result(reinterpret_cast<const char*>(m_data + m_position), length);
+        m_position += length;
+        return result;
+    }
+
+    std::size_t position() const { return m_position; }
+
+private:
+    const std::byte* m_data;
+    std::size_t m_size;
+    std::size_t m_position;
+};
+
+// Uninitialized bytes for filtering and decompression, only reallocated to grow
+class ScratchBuffer {
+public:
+    std::byte* get(const std::size_t size) {
+        if (size > m_size) {
+            m_data = std::make_unique_for_overwrite<std::byte[]>(size);
+            m_size = size;
+        }
+        return m_data.get();
+    }
+
+private:
+    UniquePtr<std::byte[]> m_data;
+    std::size_t m_size = 0;
+};
+
+std::size_t rowBytes(const Header& header) {
+    std::size_t result = header.elementSize;
+    for (Index i = 1; i < static_cast<Size>(header.shape.size()); ++i) {
+        result *= static_cast<std::size_t>(header.shape[i]);
+    }
+    return result;
+}
+
+Size countChunks(const Header& header) {
+    return static_cast<Size>((int64_t{header.shape[0]} + header.chunkRows - 1) / header.chunkRows);
+}
+
+// End of the chunk starting at rowBegin, chunkRows may reach past the last row
+Index chunkRowEnd(const Header& header, const Index rowBegin) {
+    return rowBegin + std::min(header.chunkRows, header.shape[0] - rowBegin);
+}
+
+}  // namespace
+
+namespace detail {
+
+std::size_t compress(const std::byte* input, const std::size_t size, std::byte* output, const std::size_t capacity) {
+    const auto* in = reinterpret_cast<const uint8_t*>(input);
+    BlockWriter out(reinterpret_cast<uint8_t*>(output), capacity);
+    // Positions plus one, 0 marks an empty slot
+    Vec<std::size_t> table(std::size_t{1} << HASH_BITS, 0);
+    std::size_t anchor = 0;
+    for (std::size_t i = 0; size >= MIN_MATCH && i <= size - MIN_MATCH;) {
+        const uint32_t value        = read32(in + i);
+        std::size_t& slot           = table[hash(value)];
+        const std::size_t candidate = slot;
+        slot                        = i + 1;
+        if (candidate == 0 || i - (candidate - 1) > MAX_OFFSET || read32(in + candidate - 1) != value) {
+            i += 1 + ((i - anchor) >> SKIP_SHIFT);
+            continue;
+        }
+        const std::size_t match = candidate - 1;
+        std::size_t length      = MIN_MATCH;
+        while (i + length < size && in[match + length] == in[i + length]) {
+            ++length;
+        }
+        if (!out.sequence(in + anchor, i - anchor, i - match, length)) {
+            return 0;
+        }
+        i += length;
+        anchor = i;
+    }
+    if (!out.sequence(in + anchor, size - anchor, 0, 0)) {
+        return 0;
+    }
+    return out.used();
+}
+
+void decompress(const std::byte* input, const std::size_t size, std::byte* output, const std::size_t rawSize) {
+    const auto* in       = reinterpret_cast<const uint8_t*>(input);
+    auto* out            = reinterpret_cast<uint8_t*>(output);
+    std::size_t position = 0;
+    std::size_t written  = 0;
+    for (;;) {
+        if (position >= size) {
+            corrupt();
+        }
+        const uint8_t token  = in[position++];
+        std::size_t literals = token >> 4;
+        if (literals == 15) {
+            literals += readLength(in, position, size);
+        }
+        if (size - position < literals || rawSize - written < literals) {
+            corrupt();
+        }
+        std::memcpy(out + written, in + position, literals);
+        position += literals;
+        written += literals;
+        if (position == size) {
+            break;
+        }
+
+        if (size - position < 2) {
+            corrupt();
+        }
+        const std::size_t offset = in[position] | (static_cast<std::size_t>(in[position + 1]) << 8);
+        position += 2;
+        std::size_t length = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15) {
+            length += readLength(in, position, size);
+        }
+        if (offset == 0 || offset > written || rawSize - written < length) {
+            corrupt();
+        }
+        uint8_t* target = out + written;
+        if (offset >= length) {
+            std::memcpy(target, target - offset, length);
+        } else {
+            // The match overlaps the bytes it produces, runs repeat with the period of offset
+            for (std::size_t i = 0; i < length; ++i) {
+                target[i] = target[i - offset];
+            }
+        }
+        written += length;
+    }
+    if (written != rawSize) {
+        corrupt();
+    }
+}
+
+void applyFilter(
+    const Filter filter, std::byte* data, std::byte* scratch, const std::size_t size, const std::size_t elementSize) {
+    if (deltas(filter)) {
+        delta(data, size, elementSize, true);
+    }
+    if (shuffles(filter)) {
+        shuffle(data, scratch, size / elementSize, elementSize);
+        std::memcpy(data, scratch, size);
+    }
+}
+
+void reverseFilter(
+    const Filter filter, std::byte* data, std::byte* scratch, const std::size_t size, const std::size_t elementSize) {
+    if (shuffles(filter)) {
+        unshuffle(data, scratch, size / elementSize, elementSize);
+        std::memcpy(data, scratch, size);
+    }
+    if (deltas(filter)) {
+        delta(data, size, elementSize, false);
+    }
+}
+
+void write(const std::string& path, const Header& source, const std::byte* data, const WriteOptions& options) {
+    Header header             = source;
+    const std::size_t rowSize = rowBytes(header);
+    const std::size_t rows    = options.chunkBytes / std::max<std::size_t>(1, rowSize);
+    header.chunkRows          = static_cast<Size>(std::clamp<std::size_t>(rows, 1, std::numeric_limits<Size>::max()));
+    const Size chunks         = countChunks(header);
+    const Size threadCount    = options.threadCount > 0 ? options.threadCount : defaultThreadCount();
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        throw FileError("Cannot create " + path);
+    }
+    std::string head(MAGIC);
+    head.push_back(static_cast<char>(VERSION));
+    head.push_back(static_cast<char>(header.filter));
+    head.push_back(static_cast<char>(header.elementSize));
+    head.push_back(static_cast<char>(header.descr.size()));
+    head += header.descr;
+    head.push_back(static_cast<char>(header.shape.size()));
+    for (const Size dim : header.shape) {
+        writeLittleEndian(head, static_cast<uint64_t>(dim), 8);
+    }
+    writeLittleEndian(head, static_cast<uint64_t>(header.chunkRows), 8);
+    stream << head;
+
+    // Chunks are compressed in batches, a few per thread, and written in order
+    const Size batch = std::max<Size>(1, threadCount * 2);
+    Vec<ScratchBuffer> buffers(static_cast<std::size_t>(std::min(batch, chunks)));
+    Vec<std::pair<const std::byte*, std::size_t>> encoded(buffers.size());
+    std::string index;
+    std::size_t offset = head.size();
+    for (Index first = 0; first < chunks; first += batch) {
+        const Size count = std::min(batch, chunks - first);
+        parallelRun(
+            count,
+            [&](const Index i) {
+                const Index rowBegin      = (first + i) * header.chunkRows;
+                const Index rowEnd        = chunkRowEnd(header, rowBegin);
+                const std::byte* raw      = data + static_cast<std::size_t>(rowBegin) * rowSize;
+                const std::size_t rawSize = static_cast<std::size_t>(rowEnd - rowBegin) * rowSize;
+                // The filtered chunk, then the compressed chunk, which reuses the room of the shuffle scratch
+                const std::size_t filteredBytes   = header.filter != Filter::None ? rawSize : 0;
+                const std::size_t compressedBytes = rawSize > 0 ? rawSize - 1 : 0;
+                const std::size_t scratchBytes    = shuffles(header.filter) ? rawSize : 0;
+                std::byte* buffer         = buffers[i].get(filteredBytes + std::max(scratchBytes, compressedBytes));
+                const std::byte* filtered = raw;
+                std::byte* compressed     = buffer + filteredBytes;
+                if (header.filter != Filter::None) {
+                    std::memcpy(buffer, raw, rawSize);
+                    applyFilter(header.filter, buffer, compressed, rawSize, header.elementSize);
+                    filtered = buffer;
+                }
+                // Chunks that do not shrink are stored as they are, recognized by their raw size
+                const std::size_t size = rawSize > 0 ? compress(filtered, rawSize, compressed, compressedBytes) : 0;
+                encoded[i]             = size > 0 ? std::pair{compressed, size} : std::pair{raw, rawSize};
+            },
+            threadCount);
+        for (Index i = 0; i < count; ++i) {
+            const auto [chunk, size] = encoded[i];
+            stream.write(reinterpret_cast<const char*>(chunk), static_cast<std::streamsize>(size));
+            writeLittleEndian(index, offset, 8);
+            writeLittleEndian(index, size, 8);
+            offset += size;
+        }
+    }
+    stream << index;
+    std::string trailer;
+    writeLittleEndian(trailer, offset, 8);
+    stream << trailer;
+    if (!stream) {
+        throw FileError("Cannot write " + path);
+    }
+}
+
+}  // namespace detail
+
+Reader::Reader(const std::string& path)
+    : m_file(path, MapMode::ReadOnly) {
+    const std::size_t size = m_file.size();
+    if (size < MAGIC.size() + 8 || std::memcmp(m_file.data(), MAGIC.data(), MAGIC.size()) != 0) {
+        throw InvalidFormat("Not a chunked array file: " + path);
+    }
+    FileReader reader(m_file.data(), size, MAGIC.size());
+    if (reader.read(1) != VERSION) {
+        throw InvalidFormat("Unsupported version of " + path);
+    }
+    m_header.filter      = static_cast<Filter>(reader.read(1));
+    m_header.elementSize = reader.read(1);
+    m_header.descr       = reader.string(reader.read(1));
+    const auto rank      = reader.read(1);
+    // Dimensions are stored in 64 bits, those that do not fit Size are rejected before the cast
+    const auto readSize = [&] {
+        const uint64_t value = reader.read(8);
+        if (value > static_cast<uint64_t>(std::numeric_limits<Size>::max())) {
+            throw InvalidFormat("Dimension " + std::to_string(value) + " too large in " + path);
+        }
+        return static_cast<Size>(value);
+    };
+    for (uint64_t i = 0; i < rank; ++i) {
+        m_header.shape.push_back(readSize());
+    }
+    m_header.chunkRows       = readSize();
+    const std::size_t chunks = reader.position();
+    if (m_header.filter > Filter::DeltaShuffle || m_header.elementSize == 0 ||
+        m_header.elementSize != npy::descrSize(m_header.descr) || rank == 0 || m_header.chunkRows <= 0) {
+        throw InvalidFormat("Invalid header in " + path);
+    }
+    npy::checkShape(m_header.shape);
+
+    FileReader trailer(m_file.data(), size, size - 8);
+    const std::size_t indexOffset = trailer.read(8);
+    const Size count              = countChunks(m_header);
+    if (indexOffset < chunks || indexOffset > size - 8 ||
+        size - 8 - indexOffset != static_cast<std::size_t>(count) * 16) {
+        throw InvalidFormat("Invalid chunk index in " + path);
+    }
+    FileReader index(m_file.data(), size, indexOffset);
+    const std::size_t rowSize = rowBytes(m_header);
+    for (Index i = 0; i < count; ++i) {
+        const Chunk chunk{index.read(8), index.read(8)};
+        const Index rowBegin = i * m_header.chunkRows;
+        const Index rowEnd   = chunkRowEnd(m_header, rowBegin);
+        const auto rawSize   = static_cast<std::size_t>(rowEnd - rowBegin) * rowSize;
+        if (chunk.offset < chunks || chunk.offset > indexOffset || indexOffset - chunk.offset < chunk.size ||
+            chunk.size > rawSize) {
+            throw InvalidFormat("Invalid chunk index in " + path);
+        }
+        m_index.push_back(chunk);
+    }
+}
+
+std::size_t Reader::storedBytes() const {
+    std::size_t result = 0;
+    for (const Chunk& chunk : m_index) {
+        result += chunk.size;
+    }
+    return result;
+}
+
+void Reader::checkDtype(const std::string& expected, const std::size_t elementSize) const {
+    if (m_header.descr != expected || m_header.elementSize != elementSize) {
+        throw DtypeMismatch("File holds " + m_header.descr + " elements, expected " + expected);
+    }
+}
+
+void Reader::readRows(const Index begin,
+                      const Index end,
+                      std::byte* output,
+                      const std::size_t outputBytes,
+                      const Size threadCount) const {
+    if (begin == end) {
+        return;
+    }
+    const std::size_t rowSize = rowBytes(m_header);
+    if (rowSize > 0 && outputBytes / rowSize < static_cast<std::size_t>(end - begin)) {
+        throw InvalidFormat("Rows [" + std::to_string(begin) + ", " + std::to_string(end) + ") do not fit " +
+                            std::to_string(outputBytes) + " bytes");
+    }
+    const Size chunkRows      = m_header.chunkRows;
+    const Index firstChunk    = begin / chunkRows;
+    parallelRun(
+        (end - 1) / chunkRows - firstChunk + 1,
+        [&](const Index i) {
+            const Index chunk         = firstChunk + i;
+            const Index chunkBegin    = chunk * chunkRows;
+            const Index chunkEnd      = chunkRowEnd(m_header, chunkBegin);
+            const Index from          = std::max(begin, chunkBegin);
+            const Index to            = std::min(end, chunkEnd);
+            const std::size_t rawSize = static_cast<std::size_t>(chunkEnd - chunkBegin) * rowSize;
+            const std::byte* stored   = m_file.data() + m_index[chunk].offset;
+            std::byte* target         = output + static_cast<std::size_t>(from - begin) * rowSize;
+            const std::size_t skipped = static_cast<std::size_t>(from - chunkBegin) * rowSize;
+            const std::size_t bytes   = static_cast<std::size_t>(to - from) * rowSize;
+
+            if (m_index[chunk].size == rawSize) {
+                std::memcpy(target, stored + skipped, bytes);
+                return;
+            }
+            // Whole chunks are decompressed in place, partial ones into a buffer followed by the shuffle scratch
+            const bool whole               = from == chunkBegin && to == chunkEnd;
+            const std::size_t decodedBytes = whole ? 0 : rawSize;
+            const std::size_t scratchBytes = shuffles(m_header.filter) ? rawSize : 0;
+            ScratchBuffer buffer;
+            std::byte* scratch = buffer.get(decodedBytes + scratchBytes);
+            std::byte* decoded = whole ? target : scratch;
+            scratch += decodedBytes;
+            detail::decompress(stored, m_index[chunk].size, decoded, rawSize);
+            detail::reverseFilter(m_header.filter, decoded, scratch, rawSize, m_header.elementSize);
+            if (!whole) {
+                std::memcpy(target, decoded + skipped, bytes);
+            }
+        },
+        threadCount);
+}
+
+}  // namespace nykdtb::chunked
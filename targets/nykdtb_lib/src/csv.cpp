@@ -0,0 +1,111 @@
+#include "nykdtb/csv.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define NYKDTB_CSV_POSIX 1
+#endif
+
+namespace nykdtb::csv::detail {
+
+Vec<Chunk> split(const std::string_view text, const Size count, const std::size_t minBytes) {
+    Vec<Chunk> result;
+    if (text.empty()) {
+        return result;
+    }
+    const char* end       = text.data() + text.size();
+    const std::size_t cut = std::max(minBytes, (text.size() + count - 1) / std::max<Size>(1, count));
+    for (const char* begin = text.data(); begin != end;) {
+        // Every chunk but the last one ends after the first newline following its nominal size
+        const char* next = static_cast<std::size_t>(end - begin) <= cut ? end : lineEnd(begin + cut, end);
+        next             = next == end ? end : next + 1;
+        result.push_back({begin, next});
+        begin = next;
+    }
+    return result;
+}
+
+Size countRows(const Chunk& chunk, const char delimiter) {
+    Size result = 0;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* end = lineEnd(line, chunk.end);
+        result += skipBlanks(line, end, delimiter) != end ? 1 : 0;
+        line = end == chunk.end ? end : end + 1;
+    }
+    return result;
+}
+
+Size countColumns(const std::string_view text, const char delimiter) {
+    const char* end = text.data() + text.size();
+    for (const char* line = text.data(); line < end;) {
+        const char* lineStop = lineEnd(line, end);
+        if (skipBlanks(line, lineStop, delimiter) != lineStop) {
+            return 1 + static_cast<Size>(std::count(line, lineStop, delimiter));
+        }
+        line = lineStop == end ? end : lineStop + 1;
+    }
+    return 0;
+}
+
+std::string_view skipLines(std::string_view text, Size lines) {
+    for (; lines > 0 && !text.empty(); --lines) {
+        const auto newline = text.find('\n');
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+    }
+    return text;
+}
+
+#ifdef NYKDTB_CSV_POSIX
+
+void writeAll(const int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw WriteError(std::string("Cannot write: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+int createFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw WriteError("Cannot create " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+bool closeFile(const int fd) { return close(fd) == 0; }
+
+#else
+
+void writeAll(int, const char*, std::size_t) {
+    throw WriteError("File descriptors are not supported on this platform");
+}
+
+int createFile(const std::string&) { throw WriteError("File descriptors are not supported on this platform"); }
+
+bool closeFile(int) { return false; }
+
+#endif
+
+}  // namespace nykdtb::csv::detail
+
+namespace nykdtb::csv {
+
+Formatter::Formatter(const WriteOptions& options, const std::size_t bufferBytes)
+    : m_options(options),
+      m_capacity(std::max(bufferBytes, 2 * VALUE_RESERVE)),
+      m_used(0) {
+    m_buffer.reset(new char[m_capacity]);
+}
+
+}  // namespace nykdtb::csv
@@ -0,0 +1,177 @@
+#include "nykdtb/mapped.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NYKDTB_MAPPED_POSIX 1
+#endif
+
+namespace nykdtb {
+
+namespace {
+
+#ifdef NYKDTB_MAPPED_POSIX
+
+std::string failure(const std::string& what, const std::string& path) {
+    return " " + what + " " + path + ": " + std::strerror(errno);
+}
+
+int openFlags(const MapMode mode) { return mode == MapMode::ReadWrite ? O_RDWR : O_RDONLY; }
+
+int protection(const MapMode mode) { return mode == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE; }
+
+int sharing(const MapMode mode) { return mode == MapMode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED; }
+
+int adviceFlag(const MapAdvice advice) {
+    switch (advice) {
+        case MapAdvice::Sequential:
+            return MADV_SEQUENTIAL;
+        case MapAdvice::Random:
+            return MADV_RANDOM;
+        case MapAdvice::WillNeed:
+            return MADV_WILLNEED;
+        case MapAdvice::DontNeed:
+            return MADV_DONTNEED;
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+// Maps size bytes of fd, an empty file is left unmapped
+std::byte* mapFile(const int fd, const std::size_t size, const MapMode mode, const std::string& path) {
+    if (size == 0) {
+        return nullptr;
+    }
+    void* result = mmap(nullptr, size, protection(mode), sharing(mode), fd, 0);
+    if (result == MAP_FAILED) {
+        const std::string message = failure("Cannot map", path);
+        close(fd);
+        throw MappingFailed(message);
+    }
+    return static_cast<std::byte*>(result);
+}
+
+#endif
+
+}  // namespace
+
+MappedFile::MappedFile()
+    : m_fd(-1), m_data(nullptr), m_size(0), m_mode(MapMode::ReadOnly) {}
+
+#ifdef NYKDTB_MAPPED_POSIX
+
+MappedFile::MappedFile(const std::string& path, const MapMode mode)
+    : MappedFile() {
+    const int fd = open(path.c_str(), openFlags(mode) | O_CLOEXEC);
+    if (fd < 0) {
+        throw MappingFailed(failure("Cannot open", path));
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        const std::string message = failure("Cannot stat", path);
+        close(fd);
+        throw MappingFailed(message);
+    }
+    const auto size = static_cast<std::size_t>(status.st_size);
+    m_data          = mapFile(fd, size, mode, path);
+    m_fd            = fd;
+    m_size          = size;
+    m_mode          = mode;
+}
+
+MappedFile MappedFile::create(const std::string& path, const std::size_t size) {
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw MappingFailed(failure("Cannot create", path));
+    }
+    // The file is extended with zeros, without writing them
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const std::string message = failure("Cannot resize", path);
+        close(fd);
+        throw MappingFailed(message);
+    }
+    MappedFile result;
+    result.m_data = mapFile(fd, size, MapMode::ReadWrite, path);
+    result.m_fd   = fd;
+    result.m_size = size;
+    result.m_mode = MapMode::ReadWrite;
+    return result;
+}
+
+void MappedFile::advise(const MapAdvice advice, const std::size_t offset, const std::size_t length) const {
+    if (m_data == nullptr || offset >= m_size) {
+        return;
+    }
+    const auto page        = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t from = offset / page * page;
+    const std::size_t to   = std::min(m_size, offset + std::min(length, m_size - offset));
+    madvise(m_data + from, to - from, adviceFlag(advice));
+}
+
+void MappedFile::sync() const {
+    if (m_data == nullptr || m_mode != MapMode::ReadWrite) {
+        return;
+    }
+    if (msync(m_data, m_size, MS_SYNC) != 0) {
+        throw MappingFailed(failure("Cannot sync", "mapping"));
+    }
+}
+
+void MappedFile::release() {
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+    m_fd   = -1;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string&, const MapMode)
+    : MappedFile() {
+    throw MappingFailed("File mapping is not supported on this platform");
+}
+
+MappedFile MappedFile::create(const std::string&, const std::size_t) {
+    throw MappingFailed("File mapping is not supported on this platform");
+}
+
+void MappedFile::advise(const MapAdvice, const std::size_t, const std::size_t) const {}
+
+void MappedFile::sync() const {}
+
+void MappedFile::release() {}
+
+#endif
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& other)
+    : m_fd(other.m_fd), m_data(other.m_data), m_size(other.m_size), m_mode(other.m_mode) {
+    other.m_fd   = -1;
+    other.m_data = nullptr;
+    other.m_size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+    if (this != &other) {
+        release();
+        std::swap(m_fd, other.m_fd);
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_mode, other.m_mode);
+    }
+    return *this;
+}
+
+}  // namespace nykdtb
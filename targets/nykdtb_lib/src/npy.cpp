@@ -0,0 +1,294 @@
+#include "nykdtb/npy.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+namespace nykdtb::npy {
+
+namespace {
+
+constexpr std::string_view MAGIC          = "\x93NUMPY";
+constexpr std::size_t PREAMBLE_V1         = 10;
+constexpr std::size_t PREAMBLE_V2         = 12;
+constexpr std::size_t HEADER_ALIGNMENT    = 64;
+constexpr std::size_t MAX_V1_HEADER_BYTES = 65535;
+
+std::size_t readLittleEndian(const std::byte* data, const std::size_t bytes) {
+    std::size_t result = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        result |= static_cast<std::size_t>(data[i]) << (8 * i);
+    }
+    return result;
+}
+
+void writeLittleEndian(std::string& out, const std::size_t value, const std::size_t bytes) {
+    for (std::size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+// Minimal reader of the Python dict literal NumPy writes as the header
+class DictParser {
+public:
+    explicit DictParser(std::string_view text)
+        : m_text(text) {}
+
+    // Positions the parser after the ':' following key
+    void seek(const std::string_view key) {
+        for (const char quote : {'\'', '"'}) {
+            const std::string quoted = std::string{quote} + std::string(key) + quote;
+            const auto found         = m_text.find(quoted);
+            if (found != std::string_view::npos) {
+                m_position = found + quoted.size();
+                skipSpaces();
+                expect(':');
+                return;
+            }
+        }
+        throw InvalidFormat("Header has no " + std::string(key));
+    }
+
+    std::string string() {
+        skipSpaces();
+        const char quote = next();
+        if (quote != '\'' && quote != '"') {
+            throw InvalidFormat("Expected a string in the header");
+        }
+        const auto end = m_text.find(quote, m_position);
+        if (end == std::string_view::npos) {
+            throw InvalidFormat("Unterminated string in the header");
+        }
+        std::string result(m_text.substr(m_position, end - m_position));
+        m_position = end + 1;
+        return result;
+    }
+
+    bool boolean() {
+        skipSpaces();
+        if (m_text.substr(m_position, 4) == "True") {
+            m_position += 4;
+            return true;
+        }
+        if (m_text.substr(m_position, 5) == "False") {
+            m_position += 5;
+            return false;
+        }
+        throw InvalidFormat("Expected True or False in the header");
+    }
+
+    Shape tuple() {
+        skipSpaces();
+        expect('(');
+        Shape result;
+        for (;;) {
+            skipSpaces();
+            if (peek() == ')') {
+                ++m_position;
+                return result;
+            }
+            Size value        = 0;
+            const char* begin = m_text.data() + m_position;
+            const auto parsed = std::from_chars(begin, m_text.data() + m_text.size(), value);
+            if (parsed.ec != std::errc{} || value < 0) {
+                throw InvalidFormat("Invalid shape in the header");
+            }
+            result.push_back(value);
+            m_position += static_cast<std::size_t>(parsed.ptr - begin);
+            skipSpaces();
+            if (peek() == ',') {
+                ++m_position;
+            }
+        }
+    }
+
+private:
+    void skipSpaces() {
+        while (m_position < m_text.size() && m_text[m_position] == ' ') {
+            ++m_position;
+        }
+    }
+
+    char peek() const {
+        if (m_position >= m_text.size()) {
+            throw InvalidFormat("Truncated header");
+        }
+        return m_text[m_position];
+    }
+
+    char next() {
+        const char result = peek();
+        ++m_position;
+        return result;
+    }
+
+    void expect(const char c) {
+        if (next() != c) {
+            throw InvalidFormat(std::string("Expected '") + c + "' in the header");
+        }
+    }
+
+private:
+    std::string_view m_text;
+    std::size_t m_position = 0;
+};
+
+}  // namespace
+
+bool Header::nativeByteOrder() const {
+    if (descr.empty()) {
+        return true;
+    }
+    switch (descr[0]) {
+        case '<':
+            return std::endian::native == std::endian::little;
+        case '>':
+            return std::endian::native == std::endian::big;
+        default:
+            return true;
+    }
+}
+
+std::size_t descrSize(const std::string& descr) {
+    std::size_t result = 0;
+    const char* end    = descr.data() + descr.size();
+    if (descr.size() < 3) {
+        return 0;
+    }
+    const auto parsed = std::from_chars(descr.data() + 2, end, result);
+    return parsed.ec == std::errc{} && parsed.ptr == end ? result : 0;
+}
+
+void checkShape(const Shape& shape) {
+    Size count = 1;
+    for (const Size dim : shape) {
+        if (dim < 0 || (dim > 0 && count > std::numeric_limits<Size>::max() / dim)) {
+            throw InvalidFormat("Shape has more elements than fit Size");
+        }
+        // Empty dimensions still leave the strides of the others to compute
+        count *= std::max<Size>(dim, 1);
+    }
+}
+
+Header parseHeader(const std::byte* data, const std::size_t size) {
+    if (size < PREAMBLE_V1 || std::memcmp(data, MAGIC.data(), MAGIC.size()) != 0) {
+        throw InvalidFormat("Missing .npy magic");
+    }
+    const auto major = static_cast<int>(data[6]);
+    if (major < 1 || major > 3) {
+        throw InvalidFormat("Unsupported .npy version " + std::to_string(major));
+    }
+    const std::size_t preamble    = major == 1 ? PREAMBLE_V1 : PREAMBLE_V2;
+    const std::size_t lengthBytes = preamble - MAGIC.size() - 2;
+    if (size < preamble) {
+        throw InvalidFormat("Truncated header");
+    }
+    const std::size_t headerLength = readLittleEndian(data + MAGIC.size() + 2, lengthBytes);
+    if (size < preamble + headerLength) {
+        throw InvalidFormat("Truncated header");
+    }
+
+    DictParser parser({reinterpret_cast<const char*>(data + preamble), headerLength});
+    Header result;
+    parser.seek("descr");
+    result.descr = parser.string();
+    parser.seek("fortran_order");
+    result.fortranOrder = parser.boolean();
+    parser.seek("shape");
+    result.shape = parser.tuple();
+    checkShape(result.shape);
+    // Scalars have an empty shape, they are read as a single element vector
+    if (result.shape.empty()) {
+        result.shape.push_back(1);
+    }
+    result.dataOffset = preamble + headerLength;
+    return result;
+}
+
+Header readHeader(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        throw FileError("Cannot open " + path);
+    }
+    std::byte preamble[PREAMBLE_V2] = {};
+    stream.read(reinterpret_cast<char*>(preamble), PREAMBLE_V2);
+    const auto available = static_cast<std::size_t>(stream.gcount());
+    if (available < PREAMBLE_V1 || std::memcmp(preamble, MAGIC.data(), MAGIC.size()) != 0) {
+        throw InvalidFormat("Missing .npy magic in " + path);
+    }
+    const std::size_t size = static_cast<int>(preamble[6]) == 1
+                                 ? PREAMBLE_V1 + readLittleEndian(preamble + MAGIC.size() + 2, 2)
+                                 : PREAMBLE_V2 + readLittleEndian(preamble + MAGIC.size() + 2, 4);
+    // The length is read from the file, check it against the file before allocating for it
+    stream.clear();
+    stream.seekg(0, std::ios::end);
+    if (size > static_cast<std::size_t>(stream.tellg())) {
+        throw InvalidFormat("Truncated header in " + path);
+    }
+    Vec<std::byte> buffer(size);
+    stream.seekg(0);
+    detail::readExactly(stream, buffer.data(), size, path);
+    return parseHeader(buffer.data(), size);
+}
+
+std::string formatHeader(const Header& header, const std::size_t length) {
+    std::string dict = "{'descr': '" + header.descr + "', 'fortran_order': ";
+    dict += header.fortranOrder ? "True, 'shape': (" : "False, 'shape': (";
+    for (Index i = 0; i < static_cast<Size>(header.shape.size()); ++i) {
+        dict += (i == 0 ? "" : ", ") + std::to_string(header.shape[i]);
+    }
+    // Python spells one element tuples with a trailing comma
+    dict += header.shape.size() == 1 ? ",), }" : "), }";
+
+    // The dictionary ends in a newline, the padding goes before it
+    const auto padded = [&](const std::size_t prefix) {
+        const std::size_t total = std::max(length, prefix + dict.size() + 1);
+        return (total + HEADER_ALIGNMENT - 1) / HEADER_ALIGNMENT * HEADER_ALIGNMENT;
+    };
+    // Version 2 only widens the length field, it is used when the length does not fit 16 bits
+    const bool v1            = padded(PREAMBLE_V1) - PREAMBLE_V1 <= MAX_V1_HEADER_BYTES;
+    const std::size_t prefix = v1 ? PREAMBLE_V1 : PREAMBLE_V2;
+    const std::size_t total  = padded(prefix);
+
+    std::string result(MAGIC);
+    result.push_back(static_cast<char>(v1 ? 1 : 2));
+    result.push_back(0);
+    writeLittleEndian(result, total - prefix, v1 ? 2 : 4);
+    result += dict;
+    result.append(total - result.size() - 1, ' ');
+    result.push_back('\n');
+    return result;
+}
+
+namespace detail {
+
+void checkDtype(const Header& header, const std::string& expected) {
+    // Byte order aside, the kind and the size must match
+    const auto stripped = [](const std::string& descr) {
+        const bool unordered = descr.empty() || std::isalpha(static_cast<unsigned char>(descr[0]));
+        return std::string_view(descr).substr(unordered ? 0 : 1);
+    };
+    if (stripped(header.descr) != stripped(expected)) {
+        throw DtypeMismatch("File holds " + header.descr + " elements, expected " + expected);
+    }
+}
+
+void swapBytes(void* data, const Size count, const std::size_t elementSize) {
+    auto* bytes = static_cast<std::byte*>(data);
+    for (Index i = 0; i < count; ++i, bytes += elementSize) {
+        std::reverse(bytes, bytes + elementSize);
+    }
+}
+
+void readExactly(std::ifstream& stream, void* data, const std::size_t bytes, const std::string& path) {
+    stream.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+    if (static_cast<std::size_t>(stream.gcount()) != bytes) {
+        throw InvalidFormat("Unexpected end of " + path);
+    }
+}
+
+}  // namespace detail
+
+}  // namespace nykdtb::npy
@@ -0,0 +1,681 @@
+#include "nykdtb/simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <type_traits>
+
+#ifdef NYKDTB_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace nykdtb::simd {
+
+namespace {
+
+template<BinaryOp OP, typename T>
+inline T scalarOp(const T lhs, const T rhs) {
+    if constexpr (OP == BinaryOp::Add) {
+        return lhs + rhs;
+    } else if constexpr (OP == BinaryOp::Sub) {
+        return lhs - rhs;
+    } else if constexpr (OP == BinaryOp::Mul) {
+        return lhs * rhs;
+    } else {
+        return lhs / rhs;
+    }
+}
+
+template<typename T, BinaryOp OP>
+void scalarLoop(T* dst, const T* src, Size count) {
+    for (Index i = 0; i < count; ++i) {
+        dst[i] = scalarOp<OP>(dst[i], src[i]);
+    }
+}
+
+template<typename T, BinaryOp OP>
+void scalarLoopScalar(T* dst, const T value, Size count) {
+    for (Index i = 0; i < count; ++i) {
+        dst[i] = scalarOp<OP>(dst[i], value);
+    }
+}
+
+template<typename T>
+inline bool isNan(const T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::isnan(value);
+    } else {
+        return false;
+    }
+}
+
+// Min and Max propagate NaN: a NaN accumulator stays, a NaN value replaces it
+template<ReduceOp OP, typename T>
+inline T scalarFold(const T acc, const T value) {
+    if constexpr (OP == ReduceOp::Sum) {
+        return acc + value;
+    } else if constexpr (OP == ReduceOp::SumSquares) {
+        return acc + value * value;
+    } else if constexpr (OP == ReduceOp::Min) {
+        return value < acc || isNan(value) ? value : acc;
+    } else {
+        return acc < value || isNan(value) ? value : acc;
+    }
+}
+
+// Combines two partial results. Partial sums of squares are plain sums.
+template<ReduceOp OP, typename T>
+inline T scalarMerge(const T lhs, const T rhs) {
+    return scalarFold<OP == ReduceOp::SumSquares ? ReduceOp::Sum : OP>(lhs, rhs);
+}
+
+// Accumulator a reduction starts from: zero for sums, the first value otherwise
+template<ReduceOp OP, typename T>
+inline T scalarInit(const T* src) {
+    return (OP == ReduceOp::Sum || OP == ReduceOp::SumSquares) ? T{0} : src[0];
+}
+
+// Four independent accumulators, combined pairwise at the end
+template<typename T, ReduceOp OP>
+T scalarReduce(const T* src, Size count) {
+    if (count <= 0) {
+        return T{0};
+    }
+    T acc[4] = {scalarInit<OP>(src), scalarInit<OP>(src), scalarInit<OP>(src), scalarInit<OP>(src)};
+    Index i  = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (Index j = 0; j < 4; ++j) {
+            acc[j] = scalarFold<OP>(acc[j], src[i + j]);
+        }
+    }
+    for (; i < count; ++i) {
+        acc[0] = scalarFold<OP>(acc[0], src[i]);
+    }
+    return scalarMerge<OP>(scalarMerge<OP>(acc[0], acc[1]), scalarMerge<OP>(acc[2], acc[3]));
+}
+
+template<typename T, ReduceOp OP>
+void scalarAccumulate(T* dst, const T* src, Size count) {
+    for (Index i = 0; i < count; ++i) {
+        dst[i] = scalarFold<OP>(dst[i], src[i]);
+    }
+}
+
+template<typename T>
+void scalarTransposeEdges(
+    const T* src, Index srcStride, T* dst, Index dstStride, Index rowBegin, Size rows, Index colBegin, Size cols) {
+    for (Index r = rowBegin; r < rows; ++r) {
+        for (Index c = colBegin; c < cols; ++c) {
+            dst[c * dstStride + r] = src[r * srcStride + c];
+        }
+    }
+}
+
+template<typename T>
+void scalarTranspose(const T* src, Index srcStride, T* dst, Index dstStride, Size rows, Size cols) {
+    scalarTransposeEdges(src, srcStride, dst, dstStride, 0, rows, 0, cols);
+}
+
+template<typename T>
+using TransposeKernel = void (*)(const T*, Index, T*, Index, Size, Size);
+
+// Runs TILE x TILE blocks through the in-register kernel and the ragged edges through scalar code
+template<Size TILE, typename T, typename Tile>
+inline void tiledTranspose(const T* src, Index srcStride, T* dst, Index dstStride, Size rows, Size cols, Tile tile) {
+    const Size fullRows = rows - rows % TILE;
+    const Size fullCols = cols - cols % TILE;
+    for (Index r = 0; r < fullRows; r += TILE) {
+        for (Index c = 0; c < fullCols; c += TILE) {
+            tile(src + r * srcStride + c, srcStride, dst + c * dstStride + r, dstStride);
+        }
+    }
+    scalarTransposeEdges(src, srcStride, dst, dstStride, 0, fullRows, fullCols, cols);
+    scalarTransposeEdges(src, srcStride, dst, dstStride, fullRows, rows, 0, cols);
+}
+
+template<typename T>
+struct KernelTable {
+    using ArrayKernel  = void (*)(T*, const T*, Size);
+    using ScalarKernel = void (*)(T*, T, Size);
+
+    ArrayKernel array[4];
+    ScalarKernel scalar[4];
+};
+
+template<typename T>
+struct ReduceTable {
+    using ReduceKernel     = T (*)(const T*, Size);
+    using AccumulateKernel = void (*)(T*, const T*, Size);
+
+    ReduceKernel reduce[4];
+    AccumulateKernel accumulate[4];
+};
+
+template<typename T>
+constexpr ReduceTable<T> scalarReduceTable() {
+    return {{scalarReduce<T, ReduceOp::Sum>,
+             scalarReduce<T, ReduceOp::SumSquares>,
+             scalarReduce<T, ReduceOp::Min>,
+             scalarReduce<T, ReduceOp::Max>},
+            {scalarAccumulate<T, ReduceOp::Sum>,
+             scalarAccumulate<T, ReduceOp::SumSquares>,
+             scalarAccumulate<T, ReduceOp::Min>,
+             scalarAccumulate<T, ReduceOp::Max>}};
+}
+
+template<typename T>
+constexpr KernelTable<T> scalarTable() {
+    return {{scalarLoop<T, BinaryOp::Add>,
+             scalarLoop<T, BinaryOp::Sub>,
+             scalarLoop<T, BinaryOp::Mul>,
+             scalarLoop<T, BinaryOp::Div>},
+            {scalarLoopScalar<T, BinaryOp::Add>,
+             scalarLoopScalar<T, BinaryOp::Sub>,
+             scalarLoopScalar<T, BinaryOp::Mul>,
+             scalarLoopScalar<T, BinaryOp::Div>}};
+}
+
+#ifdef NYKDTB_SIMD_X86
+
+// Wraps one instruction set / element type pair. Expressions may refer to p (pointer), v (vector),
+// x (scalar) and a, b (operands). Integer types have no vector division, DIV is never dispatched
+// for them and only has to compile. Floating point MIN / MAX propagate NaN like scalarFold: the
+// instructions return b when either operand is NaN, lanes where a is NaN keep a. The AVX-512
+// integer min / max use the full-mask forms, the plain ones trip a false maybe-uninitialized
+// warning in GCC 12.
+#define NYKDTB_SIMD_OPS(NAME, ISA, TYPE, VEC, WIDTH, LOAD, STORE, SET1, ADD, SUB, MUL, DIV, MIN, MAX) \
+    struct NAME {                                                                                     \
+        using T                     = TYPE;                                                           \
+        using V                     = VEC;                                                            \
+        static constexpr Size width = WIDTH;                                                          \
+                                                                                                      \
+        NYKDTB_TARGET(ISA) static inline V load(const T* p) { return LOAD; }                          \
+        NYKDTB_TARGET(ISA) static inline void store(T* p, V v) { STORE; }                             \
+        NYKDTB_TARGET(ISA) static inline V set1(T x) { return SET1; }                                 \
+                                                                                                      \
+        template<BinaryOp OP>                                                                         \
+        NYKDTB_TARGET(ISA) static inline V op(V a, V b) {                                             \
+            if constexpr (OP == BinaryOp::Add) {                                                      \
+                return ADD;                                                                           \
+            } else if constexpr (OP == BinaryOp::Sub) {                                               \
+                return SUB;                                                                           \
+            } else if constexpr (OP == BinaryOp::Mul) {                                               \
+                return MUL;                                                                           \
+            } else {                                                                                  \
+                return DIV;                                                                           \
+            }                                                                                         \
+        }                                                                                             \
+                                                                                                      \
+        /* acc op value, as in scalarFold */                                                          \
+        template<ReduceOp OP>                                                                         \
+        NYKDTB_TARGET(ISA) static inline V fold(V a, V b) {                                           \
+            if constexpr (OP == ReduceOp::Sum) {                                                      \
+                return ADD;                                                                           \
+            } else if constexpr (OP == ReduceOp::SumSquares) {                                        \
+                return op<BinaryOp::Add>(a, op<BinaryOp::Mul>(b, b));                                 \
+            } else if constexpr (OP == ReduceOp::Min) {                                               \
+                return MIN;                                                                           \
+            } else {                                                                                  \
+                return MAX;                                                                           \
+            }                                                                                         \
+        }                                                                                             \
+    };
+
+// Stamps out the loops for one instruction set. The main loop is unrolled twice to keep two
+// independent vectors in flight; the tail is finished with scalar code.
+#define NYKDTB_SIMD_LOOPS(PREFIX, ISA)                                                                         \
+    template<typename Ops, BinaryOp OP>                                                                        \
+    NYKDTB_TARGET(ISA) void PREFIX##Loop(typename Ops::T* dst, const typename Ops::T* src, Size count) {       \
+        constexpr Size W = Ops::width;                                                                         \
+        Index i          = 0;                                                                                  \
+        for (; i + 2 * W <= count; i += 2 * W) {                                                               \
+            const auto r0 = Ops::template op<OP>(Ops::load(dst + i), Ops::load(src + i));                      \
+            const auto r1 = Ops::template op<OP>(Ops::load(dst + i + W), Ops::load(src + i + W));              \
+            Ops::store(dst + i, r0);                                                                           \
+            Ops::store(dst + i + W, r1);                                                                       \
+        }                                                                                                      \
+        for (; i + W <= count; i += W) {                                                                       \
+            Ops::store(dst + i, Ops::template op<OP>(Ops::load(dst + i), Ops::load(src + i)));                 \
+        }                                                                                                      \
+        for (; i < count; ++i) {                                                                               \
+            dst[i] = scalarOp<OP>(dst[i], src[i]);                                                             \
+        }                                                                                                      \
+    }                                                                                                          \
+                                                                                                               \
+    template<typename Ops, BinaryOp OP>                                                                        \
+    NYKDTB_TARGET(ISA) void PREFIX##LoopScalar(typename Ops::T* dst, typename Ops::T value, Size count) {      \
+        constexpr Size W  = Ops::width;                                                                        \
+        const auto vector = Ops::set1(value);                                                                  \
+        Index i           = 0;                                                                                 \
+        for (; i + 2 * W <= count; i += 2 * W) {                                                               \
+            const auto r0 = Ops::template op<OP>(Ops::load(dst + i), vector);                                  \
+            const auto r1 = Ops::template op<OP>(Ops::load(dst + i + W), vector);                              \
+            Ops::store(dst + i, r0);                                                                           \
+            Ops::store(dst + i + W, r1);                                                                       \
+        }                                                                                                      \
+        for (; i + W <= count; i += W) {                                                                       \
+            Ops::store(dst + i, Ops::template op<OP>(Ops::load(dst + i), vector));                             \
+        }                                                                                                      \
+        for (; i < count; ++i) {                                                                               \
+            dst[i] = scalarOp<OP>(dst[i], value);                                                              \
+        }                                                                                                      \
+    }                                                                                                          \
+                                                                                                               \
+    template<typename Ops, ReduceOp OP>                                                                        \
+    NYKDTB_TARGET(ISA) typename Ops::T PREFIX##Reduce(const typename Ops::T* src, Size count) {                \
+        using T          = typename Ops::T;                                                                    \
+        constexpr Size W = Ops::width;                                                                         \
+        if (count < 4 * W) {                                                                                   \
+            return scalarReduce<T, OP>(src, count);                                                            \
+        }                                                                                                      \
+        const auto init = Ops::set1(scalarInit<OP>(src));                                                      \
+        typename Ops::V acc[4] = {init, init, init, init};                                                     \
+        Index i                = 0;                                                                            \
+        for (; i + 4 * W <= count; i += 4 * W) {                                                               \
+            for (Index j = 0; j < 4; ++j) {                                                                    \
+                acc[j] = Ops::template fold<OP>(acc[j], Ops::load(src + i + j * W));                           \
+            }                                                                                                  \
+        }                                                                                                      \
+        T lanes[4][W];                                                                                         \
+        for (Index j = 0; j < 4; ++j) {                                                                        \
+            Ops::store(lanes[j], acc[j]);                                                                      \
+        }                                                                                                      \
+        T result = lanes[0][0];                                                                                \
+        for (Index l = 1; l < W; ++l) {                                                                        \
+            result = scalarMerge<OP>(result, lanes[0][l]);                                                     \
+        }                                                                                                      \
+        for (Index j = 1; j < 4; ++j) {                                                                        \
+            for (Index l = 0; l < W; ++l) {                                                                    \
+                result = scalarMerge<OP>(result, lanes[j][l]);                                                 \
+            }                                                                                                  \
+        }                                                                                                      \
+        for (; i < count; ++i) {                                                                               \
+            result = scalarFold<OP>(result, src[i]);                                                           \
+        }                                                                                                      \
+        return result;                                                                                         \
+    }                                                                                                          \
+                                                                                                               \
+    template<typename Ops, ReduceOp OP>                                                                        \
+    NYKDTB_TARGET(ISA) void PREFIX##Accumulate(typename Ops::T* dst, const typename Ops::T* src, Size count) { \
+        constexpr Size W = Ops::width;                                                                         \
+        Index i          = 0;                                                                                  \
+        for (; i + W <= count; i += W) {                                                                       \
+            Ops::store(dst + i, Ops::template fold<OP>(Ops::load(dst + i), Ops::load(src + i)));               \
+        }                                                                                                      \
+        for (; i < count; ++i) {                                                                               \
+            dst[i] = scalarFold<OP>(dst[i], src[i]);                                                           \
+        }                                                                                                      \
+    }
+
+NYKDTB_SIMD_OPS(Sse41Float, "sse4.1", float, __m128, 4,
+                _mm_loadu_ps(p), _mm_storeu_ps(p, v), _mm_set1_ps(x),
+                _mm_add_ps(a, b), _mm_sub_ps(a, b), _mm_mul_ps(a, b), _mm_div_ps(a, b),
+                _mm_blendv_ps(_mm_min_ps(a, b), a, _mm_cmpunord_ps(a, a)),
+                _mm_blendv_ps(_mm_max_ps(a, b), a, _mm_cmpunord_ps(a, a)))
+NYKDTB_SIMD_OPS(Sse41Double, "sse4.1", double, __m128d, 2,
+                _mm_loadu_pd(p), _mm_storeu_pd(p, v), _mm_set1_pd(x),
+                _mm_add_pd(a, b), _mm_sub_pd(a, b), _mm_mul_pd(a, b), _mm_div_pd(a, b),
+                _mm_blendv_pd(_mm_min_pd(a, b), a, _mm_cmpunord_pd(a, a)),
+                _mm_blendv_pd(_mm_max_pd(a, b), a, _mm_cmpunord_pd(a, a)))
+NYKDTB_SIMD_OPS(Sse41Int32, "sse4.1", int32_t, __m128i, 4,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)),
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v), _mm_set1_epi32(x),
+                _mm_add_epi32(a, b), _mm_sub_epi32(a, b), _mm_mullo_epi32(a, b), a,
+                _mm_min_epi32(a, b), _mm_max_epi32(a, b))
+
+NYKDTB_SIMD_OPS(Avx2Float, "avx2", float, __m256, 8,
+                _mm256_loadu_ps(p), _mm256_storeu_ps(p, v), _mm256_set1_ps(x),
+                _mm256_add_ps(a, b), _mm256_sub_ps(a, b), _mm256_mul_ps(a, b), _mm256_div_ps(a, b),
+                _mm256_blendv_ps(_mm256_min_ps(a, b), a, _mm256_cmp_ps(a, a, _CMP_UNORD_Q)),
+                _mm256_blendv_ps(_mm256_max_ps(a, b), a, _mm256_cmp_ps(a, a, _CMP_UNORD_Q)))
+NYKDTB_SIMD_OPS(Avx2Double, "avx2", double, __m256d, 4,
+                _mm256_loadu_pd(p), _mm256_storeu_pd(p, v), _mm256_set1_pd(x),
+                _mm256_add_pd(a, b), _mm256_sub_pd(a, b), _mm256_mul_pd(a, b), _mm256_div_pd(a, b),
+                _mm256_blendv_pd(_mm256_min_pd(a, b), a, _mm256_cmp_pd(a, a, _CMP_UNORD_Q)),
+                _mm256_blendv_pd(_mm256_max_pd(a, b), a, _mm256_cmp_pd(a, a, _CMP_UNORD_Q)))
+NYKDTB_SIMD_OPS(Avx2Int32, "avx2", int32_t, __m256i, 8,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)),
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v), _mm256_set1_epi32(x),
+                _mm256_add_epi32(a, b), _mm256_sub_epi32(a, b), _mm256_mullo_epi32(a, b), a,
+                _mm256_min_epi32(a, b), _mm256_max_epi32(a, b))
+
+NYKDTB_SIMD_OPS(Avx512Float, "avx512f", float, __m512, 16,
+                _mm512_loadu_ps(p), _mm512_storeu_ps(p, v), _mm512_set1_ps(x),
+                _mm512_add_ps(a, b), _mm512_sub_ps(a, b), _mm512_mul_ps(a, b), _mm512_div_ps(a, b),
+                _mm512_mask_min_ps(a, _mm512_cmp_ps_mask(a, a, _CMP_ORD_Q), a, b),
+                _mm512_mask_max_ps(a, _mm512_cmp_ps_mask(a, a, _CMP_ORD_Q), a, b))
+NYKDTB_SIMD_OPS(Avx512Double, "avx512f", double, __m512d, 8,
+                _mm512_loadu_pd(p), _mm512_storeu_pd(p, v), _mm512_set1_pd(x),
+                _mm512_add_pd(a, b), _mm512_sub_pd(a, b), _mm512_mul_pd(a, b), _mm512_div_pd(a, b),
+                _mm512_mask_min_pd(a, _mm512_cmp_pd_mask(a, a, _CMP_ORD_Q), a, b),
+                _mm512_mask_max_pd(a, _mm512_cmp_pd_mask(a, a, _CMP_ORD_Q), a, b))
+NYKDTB_SIMD_OPS(Avx512Int32, "avx512f", int32_t, __m512i, 16,
+                _mm512_loadu_si512(p), _mm512_storeu_si512(p, v), _mm512_set1_epi32(x),
+                _mm512_add_epi32(a, b), _mm512_sub_epi32(a, b), _mm512_mullo_epi32(a, b), a,
+                _mm512_mask_min_epi32(a, 0xFFFF, a, b), _mm512_mask_max_epi32(a, 0xFFFF, a, b))
+
+NYKDTB_SIMD_LOOPS(sse41, "sse4.1")
+NYKDTB_SIMD_LOOPS(avx2, "avx2")
+NYKDTB_SIMD_LOOPS(avx512, "avx512f")
+
+// In-register transposes. 32 bit element types share the float shuffles, the loads and stores only
+// move bits.
+template<typename T>
+NYKDTB_TARGET("sse4.1") inline void sse41Tile4x4(const T* src, Index srcStride, T* dst, Index dstStride) {
+    static_assert(sizeof(T) == sizeof(float));
+    __m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(src));
+    __m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(src + srcStride));
+    __m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(src + 2 * srcStride));
+    __m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(src + 3 * srcStride));
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(reinterpret_cast<float*>(dst), r0);
+    _mm_storeu_ps(reinterpret_cast<float*>(dst + dstStride), r1);
+    _mm_storeu_ps(reinterpret_cast<float*>(dst + 2 * dstStride), r2);
+    _mm_storeu_ps(reinterpret_cast<float*>(dst + 3 * dstStride), r3);
+}
+
+NYKDTB_TARGET("sse4.1") inline void sse41Tile2x2(const double* src, Index srcStride, double* dst, Index dstStride) {
+    const __m128d r0 = _mm_loadu_pd(src);
+    const __m128d r1 = _mm_loadu_pd(src + srcStride);
+    _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+    _mm_storeu_pd(dst + dstStride, _mm_unpackhi_pd(r0, r1));
+}
+
+template<typename T>
+NYKDTB_TARGET("avx2") inline void avx2Tile8x8(const T* src, Index srcStride, T* dst, Index dstStride) {
+    static_assert(sizeof(T) == sizeof(float));
+    __m256 r[8];
+    for (Index i = 0; i < 8; ++i) {
+        r[i] = _mm256_loadu_ps(reinterpret_cast<const float*>(src + i * srcStride));
+    }
+    const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(u0, u4, 0x20);
+    r[1] = _mm256_permute2f128_ps(u1, u5, 0x20);
+    r[2] = _mm256_permute2f128_ps(u2, u6, 0x20);
+    r[3] = _mm256_permute2f128_ps(u3, u7, 0x20);
+    r[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+    r[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+    r[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+    r[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+    for (Index i = 0; i < 8; ++i) {
+        _mm256_storeu_ps(reinterpret_cast<float*>(dst + i * dstStride), r[i]);
+    }
+}
+
+NYKDTB_TARGET("avx2") inline void avx2Tile4x4(const double* src, Index srcStride, double* dst, Index dstStride) {
+    const __m256d r0 = _mm256_loadu_pd(src);
+    const __m256d r1 = _mm256_loadu_pd(src + srcStride);
+    const __m256d r2 = _mm256_loadu_pd(src + 2 * srcStride);
+    const __m256d r3 = _mm256_loadu_pd(src + 3 * srcStride);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + dstStride, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * dstStride, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * dstStride, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+template<typename T>
+NYKDTB_TARGET("sse4.1")
+void sse41Transpose(const T* src, Index srcStride, T* dst, Index dstStride, Size rows, Size cols) {
+    if constexpr (sizeof(T) == sizeof(float)) {
+        tiledTranspose<4>(src, srcStride, dst, dstStride, rows, cols, sse41Tile4x4<T>);
+    } else {
+        tiledTranspose<2>(src, srcStride, dst, dstStride, rows, cols, sse41Tile2x2);
+    }
+}
+
+template<typename T>
+NYKDTB_TARGET("avx2")
+void avx2Transpose(const T* src, Index srcStride, T* dst, Index dstStride, Size rows, Size cols) {
+    if constexpr (sizeof(T) == sizeof(float)) {
+        tiledTranspose<8>(src, srcStride, dst, dstStride, rows, cols, avx2Tile8x8<T>);
+    } else {
+        tiledTranspose<4>(src, srcStride, dst, dstStride, rows, cols, avx2Tile4x4);
+    }
+}
+
+// AVX-512 has no wider transpose worth the extra shuffles, that level reuses the AVX2 tiles
+template<typename T>
+const TransposeKernel<T>* transposeKernels() {
+    static const TransposeKernel<T> result[] = {
+        scalarTranspose<T>, sse41Transpose<T>, avx2Transpose<T>, avx2Transpose<T>};
+    return result;
+}
+
+#define NYKDTB_SIMD_REDUCE_TABLE(PREFIX, OPS)                \
+    ReduceTable<OPS::T> {                                    \
+        {PREFIX##Reduce<OPS, ReduceOp::Sum>,                 \
+         PREFIX##Reduce<OPS, ReduceOp::SumSquares>,          \
+         PREFIX##Reduce<OPS, ReduceOp::Min>,                 \
+         PREFIX##Reduce<OPS, ReduceOp::Max>},                \
+        {PREFIX##Accumulate<OPS, ReduceOp::Sum>,             \
+         PREFIX##Accumulate<OPS, ReduceOp::SumSquares>,      \
+         PREFIX##Accumulate<OPS, ReduceOp::Min>,             \
+         PREFIX##Accumulate<OPS, ReduceOp::Max>},            \
+    }
+
+template<typename T>
+const ReduceTable<T>* reduceTables();
+
+template<>
+const ReduceTable<float>* reduceTables<float>() {
+    static const ReduceTable<float> result[] = {scalarReduceTable<float>(),
+                                                NYKDTB_SIMD_REDUCE_TABLE(sse41, Sse41Float),
+                                                NYKDTB_SIMD_REDUCE_TABLE(avx2, Avx2Float),
+                                                NYKDTB_SIMD_REDUCE_TABLE(avx512, Avx512Float)};
+    return result;
+}
+
+template<>
+const ReduceTable<double>* reduceTables<double>() {
+    static const ReduceTable<double> result[] = {scalarReduceTable<double>(),
+                                                 NYKDTB_SIMD_REDUCE_TABLE(sse41, Sse41Double),
+                                                 NYKDTB_SIMD_REDUCE_TABLE(avx2, Avx2Double),
+                                                 NYKDTB_SIMD_REDUCE_TABLE(avx512, Avx512Double)};
+    return result;
+}
+
+template<>
+const ReduceTable<int32_t>* reduceTables<int32_t>() {
+    static const ReduceTable<int32_t> result[] = {scalarReduceTable<int32_t>(),
+                                                  NYKDTB_SIMD_REDUCE_TABLE(sse41, Sse41Int32),
+                                                  NYKDTB_SIMD_REDUCE_TABLE(avx2, Avx2Int32),
+                                                  NYKDTB_SIMD_REDUCE_TABLE(avx512, Avx512Int32)};
+    return result;
+}
+
+// Integer division has no vector instruction and always uses the scalar loop
+#define NYKDTB_SIMD_TABLE(PREFIX, OPS)                                         \
+    KernelTable<OPS::T> {                                                      \
+        {PREFIX##Loop<OPS, BinaryOp::Add>,                                     \
+         PREFIX##Loop<OPS, BinaryOp::Sub>,                                     \
+         PREFIX##Loop<OPS, BinaryOp::Mul>,                                     \
+         std::is_integral_v<OPS::T> ? scalarLoop<OPS::T, BinaryOp::Div>        \
+                                    : PREFIX##Loop<OPS, BinaryOp::Div>},       \
+        {PREFIX##LoopScalar<OPS, BinaryOp::Add>,                               \
+         PREFIX##LoopScalar<OPS, BinaryOp::Sub>,                               \
+         PREFIX##LoopScalar<OPS, BinaryOp::Mul>,                               \
+         std::is_integral_v<OPS::T> ? scalarLoopScalar<OPS::T, BinaryOp::Div>  \
+                                    : PREFIX##LoopScalar<OPS, BinaryOp::Div>}, \
+    }
+
+template<typename T>
+const KernelTable<T>* tables();
+
+template<>
+const KernelTable<float>* tables<float>() {
+    static const KernelTable<float> result[] = {scalarTable<float>(),
+                                                NYKDTB_SIMD_TABLE(sse41, Sse41Float),
+                                                NYKDTB_SIMD_TABLE(avx2, Avx2Float),
+                                                NYKDTB_SIMD_TABLE(avx512, Avx512Float)};
+    return result;
+}
+
+template<>
+const KernelTable<double>* tables<double>() {
+    static const KernelTable<double> result[] = {scalarTable<double>(),
+                                                 NYKDTB_SIMD_TABLE(sse41, Sse41Double),
+                                                 NYKDTB_SIMD_TABLE(avx2, Avx2Double),
+                                                 NYKDTB_SIMD_TABLE(avx512, Avx512Double)};
+    return result;
+}
+
+template<>
+const KernelTable<int32_t>* tables<int32_t>() {
+    static const KernelTable<int32_t> result[] = {scalarTable<int32_t>(),
+                                                  NYKDTB_SIMD_TABLE(sse41, Sse41Int32),
+                                                  NYKDTB_SIMD_TABLE(avx2, Avx2Int32),
+                                                  NYKDTB_SIMD_TABLE(avx512, Avx512Int32)};
+    return result;
+}
+
+Level detect() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return Level::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Level::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Level::SSE41;
+    }
+    return Level::Scalar;
+}
+
+#else
+
+template<typename T>
+const KernelTable<T>* tables() {
+    static const KernelTable<T> result[] = {scalarTable<T>()};
+    return result;
+}
+
+template<typename T>
+const TransposeKernel<T>* transposeKernels() {
+    static const TransposeKernel<T> result[] = {scalarTranspose<T>};
+    return result;
+}
+
+template<typename T>
+const ReduceTable<T>* reduceTables() {
+    static const ReduceTable<T> result[] = {scalarReduceTable<T>()};
+    return result;
+}
+
+Level detect() { return Level::Scalar; }
+
+#endif
+
+std::atomic<Level>& activeLevelStorage() {
+    static std::atomic<Level> level{detectedLevel()};
+    return level;
+}
+
+template<typename T>
+inline const KernelTable<T>& activeTable() {
+    return tables<T>()[static_cast<int>(activeLevelStorage().load(std::memory_order_relaxed))];
+}
+
+template<typename T>
+inline TransposeKernel<T> activeTranspose() {
+    return transposeKernels<T>()[static_cast<int>(activeLevelStorage().load(std::memory_order_relaxed))];
+}
+
+template<typename T>
+inline const ReduceTable<T>& activeReduceTable() {
+    return reduceTables<T>()[static_cast<int>(activeLevelStorage().load(std::memory_order_relaxed))];
+}
+
+}  // namespace
+
+Level detectedLevel() {
+    static const Level level = detect();
+    return level;
+}
+
+Level activeLevel() { return activeLevelStorage().load(std::memory_order_relaxed); }
+
+void setMaxLevel(Level level) {
+    activeLevelStorage().store(std::min(level, detectedLevel()), std::memory_order_relaxed);
+}
+
+void apply(BinaryOp op, float* dst, const float* src, Size count) {
+    activeTable<float>().array[static_cast<int>(op)](dst, src, count);
+}
+
+void apply(BinaryOp op, double* dst, const double* src, Size count) {
+    activeTable<double>().array[static_cast<int>(op)](dst, src, count);
+}
+
+void apply(BinaryOp op, int32_t* dst, const int32_t* src, Size count) {
+    activeTable<int32_t>().array[static_cast<int>(op)](dst, src, count);
+}
+
+void applyScalar(BinaryOp op, float* dst, float value, Size count) {
+    activeTable<float>().scalar[static_cast<int>(op)](dst, value, count);
+}
+
+void applyScalar(BinaryOp op, double* dst, double value, Size count) {
+    activeTable<double>().scalar[static_cast<int>(op)](dst, value, count);
+}
+
+void applyScalar(BinaryOp op, int32_t* dst, int32_t value, Size count) {
+    activeTable<int32_t>().scalar[static_cast<int>(op)](dst, value, count);
+}
+
+float reduce(ReduceOp op, const float* src, Size count) {
+    return activeReduceTable<float>().reduce[static_cast<int>(op)](src, count);
+}
+
+double reduce(ReduceOp op, const double* src, Size count) {
+    return activeReduceTable<double>().reduce[static_cast<int>(op)](src, count);
+}
+
+int32_t reduce(ReduceOp op, const int32_t* src, Size count) {
+    return activeReduceTable<int32_t>().reduce[static_cast<int>(op)](src, count);
+}
+
+void accumulate(ReduceOp op, float* dst, const float* src, Size count) {
+    activeReduceTable<float>().accumulate[static_cast<int>(op)](dst, src, count);
+}
+
+void accumulate(ReduceOp op, double* dst, const double* src, Size count) {
+    activeReduceTable<double>().accumulate[static_cast<int>(op)](dst, src, count);
+}
+
+void accumulate(ReduceOp op, int32_t* dst, const int32_t* src, Size count) {
+    activeReduceTable<int32_t>().accumulate[static_cast<int>(op)](dst, src, count);
+}
+
+void transpose(const float* src, Index srcStride, float* dst, Index dstStride, Size rows, Size cols) {
+    activeTranspose<float>()(src, srcStride, dst, dstStride, rows, cols);
+}
+
+void transpose(const double* src, Index srcStride, double* dst, Index dstStride, Size rows, Size cols) {
+    activeTranspose<double>()(src, srcStride, dst, dstStride, rows, cols);
+}
+
+void transpose(const int32_t* src, Index srcStride, int32_t* dst, Index dstStride, Size rows, Size cols) {
+    activeTranspose<int32_t>()(src, srcStride, dst, dstStride, rows, cols);
+}
+
+}  // namespace nykdtb::simd
@@ -0,0 +1,251 @@
+#include "nykdtb/threadpool.hpp"
+
+#include <deque>
+#include <exception>
+
+namespace nykdtb {
+
+namespace {
+
+Size hardwareThreadCount() {
+    return std::max<Size>(1, static_cast<Size>(std::thread::hardware_concurrency()));
+}
+
+std::atomic<Size>& defaultThreadCountStorage() {
+    static std::atomic<Size> storage{hardwareThreadCount()};
+    return storage;
+}
+
+// Pool and deque index of the calling thread if it is a pool worker
+struct WorkerIdentity {
+    const ThreadPool* pool = nullptr;
+    Index index            = 0;
+};
+
+thread_local WorkerIdentity currentWorker;
+
+}  // namespace
+
+Size defaultThreadCount() { return defaultThreadCountStorage().load(std::memory_order_relaxed); }
+
+void setDefaultThreadCount(Size threadCount) {
+    defaultThreadCountStorage().store(threadCount > 0 ? threadCount : hardwareThreadCount(), std::memory_order_relaxed);
+}
+
+// One call of run. It lives on the stack of the calling thread, which only returns once every task
+// finished and every helper left. Helpers take one of the free slots before touching any range.
+struct ThreadPool::Job {
+    const Task& task;
+    const Size taskCount;
+    const Size helperLimit;
+    std::atomic<Size> freeSlots;
+    std::atomic<Size> finished{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+
+    Job(const Task& _task, Size _taskCount, Size _helperLimit)
+        : task(_task), taskCount(_taskCount), helperLimit(_helperLimit), freeSlots(_helperLimit) {}
+
+    bool join() {
+        Size slots = freeSlots.load();
+        while (slots > 0 && !freeSlots.compare_exchange_weak(slots, slots - 1)) {
+        }
+        return slots > 0;
+    }
+
+    void leave() {
+        std::lock_guard lock(mutex);
+        ++freeSlots;
+        done.notify_all();
+    }
+
+    void execute(const Index i) {
+        try {
+            task(i);
+        } catch (...) {
+            std::lock_guard lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        if (++finished == taskCount) {
+            std::lock_guard lock(mutex);
+            done.notify_all();
+        }
+    }
+
+    void wait() {
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this]() { return finished.load() == taskCount && freeSlots.load() == helperLimit; });
+    }
+};
+
+struct ThreadPool::Range {
+    Job* job;
+    Index begin;
+    Index end;
+};
+
+struct ThreadPool::Queue {
+    std::mutex mutex;
+    std::deque<Range> ranges;
+};
+
+ThreadPool::ThreadPool(Size workerCount)
+    : m_queues(new Queue[MAX_WORKERS + 1]), m_workerCount(0), m_sleeping(0), m_epoch(0), m_stopping(false) {
+    ensureWorkerCount(workerCount);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+Size ThreadPool::workerCount() const { return m_workerCount.load(); }
+
+void ThreadPool::ensureWorkerCount(Size workerCount) {
+    workerCount = std::min(workerCount, MAX_WORKERS);
+    if (m_workerCount.load() >= workerCount) {
+        return;
+    }
+    std::lock_guard lock(m_mutex);
+    while (static_cast<Size>(m_workers.size()) < workerCount) {
+        const Index index = static_cast<Index>(m_workers.size());
+        m_workers.emplace_back([this, index]() { workerLoop(index); });
+        ++m_workerCount;
+    }
+}
+
+void ThreadPool::run(Size taskCount, const Task& task, Size threadCount) {
+    if (taskCount <= 0) {
+        return;
+    }
+
+    const Size helperLimit = std::min({threadCount, taskCount, MAX_WORKERS + 1}) - 1;
+    ensureWorkerCount(helperLimit);
+    Job job(task, taskCount, std::max<Size>(0, helperLimit));
+
+    if (job.helperLimit == 0) {
+        for (Index i = 0; i < taskCount; ++i) {
+            job.execute(i);
+        }
+    } else {
+        Queue& queue = localQueue();
+        process({&job, 0, taskCount}, queue);
+        help(job, queue);
+    }
+    job.wait();
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+ThreadPool::Queue& ThreadPool::localQueue() {
+    return m_queues[currentWorker.pool == this ? currentWorker.index : MAX_WORKERS];
+}
+
+void ThreadPool::push(Queue& queue, const Range& range) {
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.ranges.push_back(range);
+    }
+    // Sleeping workers recheck the deques whenever the epoch moves, so a push cannot be missed
+    ++m_epoch;
+    if (m_sleeping.load() > 0) {
+        std::lock_guard lock(m_mutex);
+        m_wakeUp.notify_one();
+    }
+}
+
+// Removes a range of job from queue, the newest or the oldest one. Without a job the oldest range
+// whose job still has a free slot is taken and the slot is claimed.
+Optional<ThreadPool::Range> ThreadPool::take(Queue& queue, const Job* job, const bool newest) {
+    std::lock_guard lock(queue.mutex);
+    auto& ranges = queue.ranges;
+    for (Index i = 0; i < static_cast<Size>(ranges.size()); ++i) {
+        const auto it = newest ? ranges.end() - 1 - i : ranges.begin() + i;
+        if (job ? it->job == job : it->job->join()) {
+            const Range result = *it;
+            ranges.erase(it);
+            return result;
+        }
+    }
+    return nullopt;
+}
+
+Optional<ThreadPool::Range> ThreadPool::steal(const Queue& self, const Job* job) {
+    const Index start = currentWorker.pool == this ? currentWorker.index + 1 : 0;
+    const Size count  = m_workerCount.load();
+    for (Index i = 0; i <= count; ++i) {
+        // Worker deques round-robin from the next one, the shared deque last
+        const Index index = i == count ? MAX_WORKERS : (start + i) % count;
+        if (&m_queues[index] != &self) {
+            if (auto range = take(m_queues[index], job, false)) {
+                return range;
+            }
+        }
+    }
+    return nullopt;
+}
+
+void ThreadPool::process(Range range, Queue& queue) {
+    while (range.end - range.begin > 1) {
+        const Index middle = range.begin + (range.end - range.begin) / 2;
+        push(queue, {range.job, middle, range.end});
+        range.end = middle;
+    }
+    range.job->execute(range.begin);
+}
+
+// Works on job until no range of it is left in any deque. Ranges other threads are still splitting
+// are finished by them.
+void ThreadPool::help(Job& job, Queue& queue) {
+    while (true) {
+        auto range = take(queue, &job, true);
+        if (!range) {
+            range = steal(queue, &job);
+        }
+        if (!range) {
+            return;
+        }
+        process(*range, queue);
+    }
+}
+
+void ThreadPool::workerLoop(const Index self) {
+    currentWorker = {this, self};
+    Queue& queue  = m_queues[self];
+    while (true) {
+        const uint64_t epoch = m_epoch.load();
+        if (auto range = steal(queue, nullptr)) {
+            Job& job = *range->job;
+            process(*range, queue);
+            help(job, queue);
+            job.leave();
+            continue;
+        }
+
+        std::unique_lock lock(m_mutex);
+        ++m_sleeping;
+        m_wakeUp.wait(lock, [&]() { return m_stopping || m_epoch.load() != epoch; });
+        --m_sleeping;
+        if (m_stopping) {
+            return;
+        }
+    }
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool(0);
+    return pool;
+}
+
+}  // namespace nykdtb
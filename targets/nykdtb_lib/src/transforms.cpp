@@ -0,0 +1,250 @@
+#include "nykdtb/transforms.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "nykdtb/simd.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NYKDTB_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define NYKDTB_ALWAYS_INLINE inline
+#endif
+
+namespace nykdtb::nda::transforms::kernels {
+
+namespace {
+
+// Items processed together: one AVX-512 register worth. The lane loops below have this constant
+// trip count and are vectorized at whatever instruction set the calling kernel is compiled for.
+template<typename T>
+constexpr Size LANES = static_cast<Size>(64 / sizeof(T));
+
+// soa[e][l] = src[l * stride + e] for the first count lanes
+template<typename T, Size ELEMENTS>
+NYKDTB_ALWAYS_INLINE void gather(const T* src, const Index stride, T (&soa)[ELEMENTS][LANES<T>], const Size count) {
+    for (Index l = 0; l < count; ++l) {
+        for (Index e = 0; e < ELEMENTS; ++e) {
+            soa[e][l] = src[l * stride + e];
+        }
+    }
+}
+
+template<typename T, Size ELEMENTS>
+NYKDTB_ALWAYS_INLINE void scatter(const T (&soa)[ELEMENTS][LANES<T>], T* dst, const Size count) {
+    for (Index l = 0; l < count; ++l) {
+        for (Index e = 0; e < ELEMENTS; ++e) {
+            dst[l * ELEMENTS + e] = soa[e][l];
+        }
+    }
+}
+
+template<typename T, Size DIM>
+NYKDTB_ALWAYS_INLINE void composeLoop(
+    const T* lhs, const Index lhsStride, const T* rhs, const Index rhsStride, T* dst, const Size count) {
+    constexpr Size L = LANES<T>;
+    constexpr Size E = DIM * DIM;
+    alignas(64) T a[E][L]   = {};
+    alignas(64) T b[E][L]   = {};
+    alignas(64) T out[E][L] = {};
+
+    // A repeated operand is spread over the lanes once
+    if (lhsStride == 0) {
+        gather<T, E>(lhs, 0, a, L);
+    }
+    if (rhsStride == 0) {
+        gather<T, E>(rhs, 0, b, L);
+    }
+    for (Index base = 0; base < count; base += L) {
+        const Size n = std::min(L, count - base);
+        if (lhsStride != 0) {
+            gather<T, E>(lhs + base * lhsStride, lhsStride, a, n);
+        }
+        if (rhsStride != 0) {
+            gather<T, E>(rhs + base * rhsStride, rhsStride, b, n);
+        }
+        for (Index i = 0; i < DIM; ++i) {
+            for (Index j = 0; j < DIM; ++j) {
+                T* o = out[i * DIM + j];
+                for (Index l = 0; l < L; ++l) {
+                    o[l] = a[i * DIM][l] * b[j][l];
+                }
+                for (Index k = 1; k < DIM; ++k) {
+                    for (Index l = 0; l < L; ++l) {
+                        o[l] += a[i * DIM + k][l] * b[k * DIM + j][l];
+                    }
+                }
+            }
+        }
+        scatter<T, E>(out, dst + base * E, n);
+    }
+}
+
+template<typename T, Size DIM>
+NYKDTB_ALWAYS_INLINE void applyLoop(
+    const T* transforms, const Index transformStride, const T* points, T* dst, const Size count) {
+    constexpr Size L = LANES<T>;
+    constexpr Size E = DIM * DIM;
+    alignas(64) T t[E][L]   = {};
+    alignas(64) T p[3][L]   = {};
+    alignas(64) T out[3][L] = {};
+
+    if (transformStride == 0) {
+        gather<T, E>(transforms, 0, t, L);
+    }
+    for (Index base = 0; base < count; base += L) {
+        const Size n = std::min(L, count - base);
+        if (transformStride != 0) {
+            gather<T, E>(transforms + base * transformStride, transformStride, t, n);
+        }
+        gather<T, 3>(points + base * 3, 3, p, n);
+        for (Index r = 0; r < 3; ++r) {
+            const T* row0 = t[r * DIM];
+            const T* row1 = t[r * DIM + 1];
+            const T* row2 = t[r * DIM + 2];
+            for (Index l = 0; l < L; ++l) {
+                out[r][l] = row0[l] * p[0][l] + row1[l] * p[1][l] + row2[l] * p[2][l];
+            }
+            if constexpr (DIM == 4) {
+                const T* translation = t[r * DIM + 3];
+                for (Index l = 0; l < L; ++l) {
+                    out[r][l] += translation[l];
+                }
+            }
+        }
+        scatter<T, 3>(out, dst + base * 3, n);
+    }
+}
+
+template<typename T>
+NYKDTB_ALWAYS_INLINE void axisAngleLoop(const T* axes, const T* angles, T* dst, const Size count) {
+    constexpr Size L = LANES<T>;
+    alignas(64) T axis[3][L] = {};
+    alignas(64) T s[L]       = {};
+    alignas(64) T c[L]       = {};
+    alignas(64) T out[9][L]  = {};
+
+    for (Index base = 0; base < count; base += L) {
+        const Size n = std::min(L, count - base);
+        gather<T, 3>(axes + base * 3, 3, axis, n);
+        for (Index l = 0; l < n; ++l) {
+            s[l] = std::sin(angles[base + l]);
+            c[l] = std::cos(angles[base + l]);
+        }
+        const T* x = axis[0];
+        const T* y = axis[1];
+        const T* z = axis[2];
+        for (Index l = 0; l < L; ++l) {
+            const T a = T{1} - c[l];
+            out[0][l] = c[l] + x[l] * x[l] * a;
+            out[1][l] = x[l] * y[l] * a - z[l] * s[l];
+            out[2][l] = x[l] * z[l] * a + y[l] * s[l];
+            out[3][l] = y[l] * x[l] * a + z[l] * s[l];
+            out[4][l] = c[l] + y[l] * y[l] * a;
+            out[5][l] = y[l] * z[l] * a - x[l] * s[l];
+            out[6][l] = z[l] * x[l] * a - y[l] * s[l];
+            out[7][l] = z[l] * y[l] * a + x[l] * s[l];
+            out[8][l] = c[l] + z[l] * z[l] * a;
+        }
+        scatter<T, 9>(out, dst + base * 9, n);
+    }
+}
+
+template<typename T>
+struct KernelTable {
+    using Compose   = void (*)(const T*, Index, const T*, Index, T*, Size);
+    using Apply     = void (*)(const T*, Index, const T*, T*, Size);
+    using AxisAngle = void (*)(const T*, const T*, T*, Size);
+
+    Compose compose3;
+    Compose compose4;
+    Apply apply3;
+    Apply apply4;
+    AxisAngle axisAngle;
+};
+
+// Stamps out the kernels of one instruction set. The loops are force-inlined into these wrappers, so
+// the compiler vectorizes them with the wrapper's target.
+#define NYKDTB_TRANSFORM_KERNELS(PREFIX, ATTRIBUTES)                                                 \
+    template<typename T, Size DIM>                                                                   \
+    ATTRIBUTES void PREFIX##Compose(                                                                 \
+        const T* lhs, Index lhsStride, const T* rhs, Index rhsStride, T* dst, Size count) {          \
+        composeLoop<T, DIM>(lhs, lhsStride, rhs, rhsStride, dst, count);                             \
+    }                                                                                                \
+                                                                                                     \
+    template<typename T, Size DIM>                                                                   \
+    ATTRIBUTES void PREFIX##Apply(                                                                   \
+        const T* transforms, Index transformStride, const T* points, T* dst, Size count) {           \
+        applyLoop<T, DIM>(transforms, transformStride, points, dst, count);                          \
+    }                                                                                                \
+                                                                                                     \
+    template<typename T>                                                                             \
+    ATTRIBUTES void PREFIX##AxisAngle(const T* axes, const T* angles, T* dst, Size count) {          \
+        axisAngleLoop<T>(axes, angles, dst, count);                                                  \
+    }                                                                                                \
+                                                                                                     \
+    template<typename T>                                                                             \
+    constexpr KernelTable<T> PREFIX##Table() {                                                       \
+        return {PREFIX##Compose<T, 3>,                                                               \
+                PREFIX##Compose<T, 4>,                                                               \
+                PREFIX##Apply<T, 3>,                                                                 \
+                PREFIX##Apply<T, 4>,                                                                 \
+                PREFIX##AxisAngle<T>};                                                               \
+    }
+
+NYKDTB_TRANSFORM_KERNELS(scalar, )
+
+#ifdef NYKDTB_SIMD_X86
+
+NYKDTB_TRANSFORM_KERNELS(sse41, NYKDTB_TARGET("sse4.1"))
+NYKDTB_TRANSFORM_KERNELS(avx2, NYKDTB_TARGET("avx2"))
+NYKDTB_TRANSFORM_KERNELS(avx512, NYKDTB_TARGET("avx512f"))
+
+template<typename T>
+const KernelTable<T>& activeTable() {
+    static const KernelTable<T> result[] = {scalarTable<T>(), sse41Table<T>(), avx2Table<T>(), avx512Table<T>()};
+    return result[static_cast<int>(simd::activeLevel())];
+}
+
+#else
+
+template<typename T>
+const KernelTable<T>& activeTable() {
+    static const KernelTable<T> result = scalarTable<T>();
+    return result;
+}
+
+#endif
+
+}  // namespace
+
+void compose(const float* lhs, Index lhsStride, const float* rhs, Index rhsStride, float* dst, Size dim, Size count) {
+    const auto& table = activeTable<float>();
+    (dim == 3 ? table.compose3 : table.compose4)(lhs, lhsStride, rhs, rhsStride, dst, count);
+}
+
+void compose(
+    const double* lhs, Index lhsStride, const double* rhs, Index rhsStride, double* dst, Size dim, Size count) {
+    const auto& table = activeTable<double>();
+    (dim == 3 ? table.compose3 : table.compose4)(lhs, lhsStride, rhs, rhsStride, dst, count);
+}
+
+void apply(const float* transforms, Index transformStride, const float* points, float* dst, Size dim, Size count) {
+    const auto& table = activeTable<float>();
+    (dim == 3 ? table.apply3 : table.apply4)(transforms, transformStride, points, dst, count);
+}
+
+void apply(const double* transforms, Index transformStride, const double* points, double* dst, Size dim, Size count) {
+    const auto& table = activeTable<double>();
+    (dim == 3 ? table.apply3 : table.apply4)(transforms, transformStride, points, dst, count);
+}
+
+void axisAngle(const float* axes, const float* angles, float* dst, Size count) {
+    activeTable<float>().axisAngle(axes, angles, dst, count);
+}
+
+void axisAngle(const double* axes, const double* angles, double* dst, Size count) {
+    activeTable<double>().axisAngle(axes, angles, dst, count);
+}
+
+}  // namespace nykdtb::nda::transforms::kernels
@@ -0,0 +1,193 @@
+#include "nykdtb/allocator.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "nykdtb/ndarray_ops.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+bool alignedTo(const void* ptr, const std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+template<typename A>
+struct AllocatorParams {
+    static constexpr Size STACK_SIZE        = 4;
+    static constexpr Size SHAPE_STACK_SIZE  = 4;
+    static constexpr Size STORAGE_ALIGNMENT = 64;
+    using Allocator                         = A;
+};
+
+}  // namespace
+
+TEST_CASE("MallocAllocator", "[allocator]") {
+    // Sizes that are not multiples of the alignment are rounded up for aligned_alloc
+    void* ptr = MallocAllocator::allocate(100, 256);
+    REQUIRE(ptr != nullptr);
+    REQUIRE(alignedTo(ptr, 256));
+    MallocAllocator::deallocate(ptr, 100, 256);
+}
+
+TEST_CASE("MallocAllocator zeroed blocks", "[allocator]") {
+    const auto allZero = [](const void* ptr, const std::size_t bytes) {
+        const auto* begin = static_cast<const std::byte*>(ptr);
+        return std::all_of(begin, begin + bytes, [](const std::byte b) { return b == std::byte{0}; });
+    };
+
+    for (const std::size_t bytes : {std::size_t{100}, MallocAllocator::MAP_THRESHOLD + 100}) {
+        void* ptr = MallocAllocator::allocateZeroed(bytes, 64);
+        REQUIRE(alignedTo(ptr, 64));
+        REQUIRE(allZero(ptr, bytes));
+        MallocAllocator::deallocate(ptr, bytes, 64);
+    }
+
+    // Alignments above the page size are not mapped
+    void* ptr = MallocAllocator::allocateZeroed(MallocAllocator::MAP_THRESHOLD, 8192);
+    REQUIRE(alignedTo(ptr, 8192));
+    REQUIRE(allZero(ptr, MallocAllocator::MAP_THRESHOLD));
+    MallocAllocator::deallocate(ptr, MallocAllocator::MAP_THRESHOLD, 8192);
+
+    void* pooled = PoolAllocator::allocate(1000, 64);
+    std::memset(pooled, 0xff, 1000);
+    PoolAllocator::deallocate(pooled, 1000, 64);
+    void* reused = PoolAllocator::allocateZeroed(1000, 64);
+    REQUIRE(allZero(reused, 1000));
+    PoolAllocator::deallocate(reused, 1000, 64);
+}
+
+TEST_CASE("Arena", "[allocator]") {
+    Arena arena(4096);
+
+    SECTION("Bump allocations keep their alignment") {
+        auto* a = static_cast<std::byte*>(arena.allocate(3, 1));
+        auto* b = static_cast<std::byte*>(arena.allocate(64, 64));
+        auto* c = static_cast<std::byte*>(arena.allocate(8, 8));
+        REQUIRE(alignedTo(b, 64));
+        REQUIRE(alignedTo(c, 8));
+        REQUIRE(b > a);
+        REQUIRE(c == b + 64);
+        REQUIRE(arena.used() == static_cast<std::size_t>(c + 8 - a));
+    }
+    SECTION("Reset reuses the blocks") {
+        void* first = arena.allocate(1000, 16);
+        for (Index i = 0; i < 20; ++i) {
+            arena.allocate(1000, 16);
+        }
+        void* large = arena.allocate(100000, 256);
+        REQUIRE(alignedTo(large, 256));
+        const std::size_t reserved = arena.reserved();
+        REQUIRE(reserved >= 21 * 1000 + 100000);
+
+        arena.reset();
+        REQUIRE(arena.used() == 0);
+        REQUIRE(arena.allocate(1000, 16) == first);
+        for (Index i = 0; i < 20; ++i) {
+            arena.allocate(1000, 16);
+        }
+        arena.allocate(100000, 256);
+        REQUIRE(arena.reserved() == reserved);
+    }
+    SECTION("Scopes select the arena of ArenaAllocator") {
+        REQUIRE(Arena::current() == nullptr);
+        REQUIRE_THROWS_AS(ArenaAllocator::allocate(16, 16), NoActiveArena);
+        {
+            Arena::Scope scope(arena);
+            REQUIRE(Arena::current() == &arena);
+            {
+                Arena inner;
+                Arena::Scope innerScope(inner);
+                ArenaAllocator::allocate(16, 16);
+                REQUIRE(inner.used() == 16);
+            }
+            REQUIRE(Arena::current() == &arena);
+            ArenaAllocator::allocate(16, 16);
+            REQUIRE(arena.used() == 16);
+        }
+        REQUIRE(Arena::current() == nullptr);
+    }
+}
+
+TEST_CASE("PoolAllocator", "[allocator]") {
+    PoolAllocator::trim();
+
+    SECTION("Freed blocks are reused for the same size class") {
+        void* a = PoolAllocator::allocate(3000, 64);
+        REQUIRE(alignedTo(a, PoolAllocator::MIN_CLASS));
+        PoolAllocator::deallocate(a, 3000, 64);
+        void* b = PoolAllocator::allocate(4096, 256);
+        REQUIRE(b == a);
+        void* c = PoolAllocator::allocate(3000, 64);
+        REQUIRE(c != a);
+        PoolAllocator::deallocate(b, 4096, 256);
+        PoolAllocator::deallocate(c, 3000, 64);
+    }
+    SECTION("Blocks outside the classes bypass the pool") {
+        void* large = PoolAllocator::allocate(PoolAllocator::MAX_CLASS + 1, 64);
+        PoolAllocator::deallocate(large, PoolAllocator::MAX_CLASS + 1, 64);
+        void* overAligned = PoolAllocator::allocate(64, 4096);
+        REQUIRE(alignedTo(overAligned, 4096));
+        PoolAllocator::deallocate(overAligned, 64, 4096);
+    }
+    SECTION("Blocks may be freed by another thread") {
+        void* block = PoolAllocator::allocate(1000, 64);
+        std::thread([block]() { PoolAllocator::deallocate(block, 1000, 64); }).join();
+    }
+    PoolAllocator::trim();
+}
+
+TEST_CASE("Containers with allocator policies", "[allocator]") {
+    SECTION("PSVec") {
+        PSVec<int, 2, 16, PoolAllocator> values;
+        for (Index i = 0; i < 1000; ++i) {
+            values.push_back(i);
+        }
+        REQUIRE(!values.onStack());
+        REQUIRE(values[999] == 999);
+        values.resize(1);
+        REQUIRE(values.onStack());
+    }
+    SECTION("NDArray in an arena") {
+        using ArenaArray = NDArrayBase<double, AllocatorParams<ArenaAllocator>>;
+        Arena arena;
+        Arena::Scope scope(arena);
+        for (Index round = 0; round < 3; ++round) {
+            {
+                auto a       = ArenaArray::filled({64, 64}, 2.0);
+                const auto b = nda::d2::matMul(a, a);
+                nda::addAssign(a, b);
+                REQUIRE(a[{3, 5}] == 258.0);
+            }
+            REQUIRE(arena.used() > 0);
+            arena.reset();
+        }
+    }
+    SECTION("Zeroed NDArray storage") {
+        // Mapped straight from the OS
+        auto grid = NDArray<float>::zeros({4096, 2048});
+        grid[{4000, 7}] += 1.0F;
+        REQUIRE(nda::sum(grid) == 1.0F);
+
+        // Arena memory is reused without zeroing by the policy
+        using ArenaArray = NDArrayBase<int, AllocatorParams<ArenaAllocator>>;
+        Arena arena;
+        Arena::Scope scope(arena);
+        ArenaArray::filled({100}, 7);
+        arena.reset();
+        const auto zeros = ArenaArray::zeros({100});
+        REQUIRE(nda::sum(zeros) == 0);
+    }
+    SECTION("NDArray in the pool") {
+        using PoolArray = NDArrayBase<float, AllocatorParams<PoolAllocator>>;
+        const auto a    = PoolArray::filled({100, 3}, 1.0F);
+        const auto b    = a.clone();
+        REQUIRE(nda::eq(a, b));
+        REQUIRE(nda::sum(b) == 300.0F);
+        PoolAllocator::trim();
+    }
+}
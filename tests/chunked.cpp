@@ -0,0 +1,188 @@
+#include "nykdtb/chunked.hpp"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+using TestArray = NDArray<float>;
+
+// Slowly varying readings with a little noise, as from a sensor
+TestArray sensorData(const Size rows, const Size columns) {
+    std::mt19937 generator(7);
+    std::normal_distribution<float> noise(0.0F, 0.01F);
+    TestArray result = TestArray::zeros({rows, columns});
+    for (Index i = 0; i < result.size(); ++i) {
+        result[i] = 20.0F + std::sin(static_cast<float>(i / columns) * 0.01F) + noise(generator);
+    }
+    return result;
+}
+
+Vec<std::byte> roundTrip(const Vec<std::byte>& input) {
+    Vec<std::byte> compressed(input.size());
+    const std::size_t size = chunked::detail::compress(input.data(), input.size(), compressed.data(), input.size());
+    if (size == 0) {
+        return {};
+    }
+    Vec<std::byte> result(input.size());
+    chunked::detail::decompress(compressed.data(), size, result.data(), result.size());
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("chunked codec", "[chunked]") {
+    SECTION("Repetitive and overlapping runs") {
+        Vec<std::byte> input(100000, std::byte{0});
+        for (std::size_t i = 50000; i < input.size(); ++i) {
+            input[i] = static_cast<std::byte>(i % 7);
+        }
+        Vec<std::byte> compressed(input.size());
+        const std::size_t size =
+            chunked::detail::compress(input.data(), input.size(), compressed.data(), compressed.size());
+        REQUIRE(size > 0);
+        REQUIRE(size < input.size() / 50);
+        REQUIRE(roundTrip(input) == input);
+
+        Vec<std::byte> output(input.size());
+        REQUIRE_THROWS_AS(chunked::detail::decompress(compressed.data(), size - 1, output.data(), output.size()),
+                          chunked::InvalidFormat);
+        REQUIRE_THROWS_AS(chunked::detail::decompress(compressed.data(), size, output.data(), output.size() - 1),
+                          chunked::InvalidFormat);
+    }
+    SECTION("Incompressible and tiny input") {
+        std::mt19937 generator(3);
+        Vec<std::byte> input(4096);
+        for (auto& byte : input) {
+            byte = static_cast<std::byte>(generator());
+        }
+        REQUIRE(roundTrip(input).empty());
+        REQUIRE(roundTrip({std::byte{1}, std::byte{2}, std::byte{3}}).empty());
+    }
+    SECTION("Filters are reversible") {
+        for (const auto filter : {chunked::Filter::Shuffle, chunked::Filter::Delta, chunked::Filter::DeltaShuffle}) {
+            for (const std::size_t elementSize : {1, 2, 4, 8, 3}) {
+                Vec<std::byte> data(elementSize * 50);
+                for (std::size_t i = 0; i < data.size(); ++i) {
+                    data[i] = static_cast<std::byte>(i * i + 5);
+                }
+                auto filtered = data;
+                Vec<std::byte> scratch(data.size());
+                chunked::detail::applyFilter(filter, filtered.data(), scratch.data(), data.size(), elementSize);
+                // Shuffling single bytes leaves them in place
+                REQUIRE((filtered != data || (filter == chunked::Filter::Shuffle && elementSize == 1)));
+                chunked::detail::reverseFilter(filter, filtered.data(), scratch.data(), data.size(), elementSize);
+                REQUIRE(filtered == data);
+            }
+        }
+    }
+}
+
+TEST_CASE("chunked save and load", "[chunked]") {
+    const TempFile file("array.nyc");
+
+    SECTION("Filters") {
+        const TestArray array = sensorData(2000, 16);
+        using chunked::Filter;
+        for (const auto filter : {Filter::None, Filter::Shuffle, Filter::Delta, Filter::DeltaShuffle}) {
+            chunked::save(file.path, array, {.filter = filter, .chunkBytes = 1 << 14});
+            const chunked::Reader reader(file.path);
+            REQUIRE(reader.chunkCount() == 8);
+            REQUIRE(reader.header().filter == filter);
+            REQUIRE(nda::eq(reader.read<float>(), array));
+            if (filter == chunked::Filter::Shuffle) {
+                REQUIRE(reader.storedBytes() < array.size() * sizeof(float) * 3 / 4);
+            }
+        }
+    }
+    SECTION("Element types and ranks") {
+        NDArray<int64_t> counters = NDArray<int64_t>::zeros({10, 3, 4});
+        for (Index i = 0; i < counters.size(); ++i) {
+            counters[i] = 1000000 + i * 3;
+        }
+        chunked::save(file.path, counters, {.filter = chunked::Filter::Delta, .chunkBytes = 100});
+        REQUIRE(nda::eq(chunked::load<int64_t>(file.path), counters));
+
+        const NDArray<bool> flags{{true, false, false, true, true}};
+        chunked::save(file.path, flags);
+        REQUIRE(nda::eq(chunked::load<bool>(file.path), flags));
+        REQUIRE_THROWS_AS(chunked::load<uint8_t>(file.path), chunked::DtypeMismatch);
+    }
+    SECTION("Slices are written densely") {
+        TestArray array{{1, 2, 3, 4, 5, 6}, {2, 3}};
+        chunked::save(file.path, NDArraySlice<TestArray>(array, {IndexRange::e2e(), IndexRange::single(2)}));
+        REQUIRE(nda::eq(chunked::load<float>(file.path), TestArray{{3, 6}, {2, 1}}));
+    }
+    SECTION("Invalid files") {
+        {
+            std::ofstream stream(file.path, std::ios::binary);
+            stream << "not a chunked array file";
+        }
+        REQUIRE_THROWS_AS(chunked::Reader(file.path), chunked::InvalidFormat);
+
+        chunked::save(file.path, sensorData(100, 4));
+        std::filesystem::resize_file(file.path, std::filesystem::file_size(file.path) - 1);
+        REQUIRE_THROWS_AS(chunked::Reader(file.path), chunked::InvalidFormat);
+    }
+    SECTION("Element sizes that do not match the type") {
+        // The element size follows the magic, version and filter, the type string follows its length
+        const auto overwrite = [&](const std::streamoff offset, const std::string& bytes) {
+            chunked::save(file.path, NDArray<double>::filled({64, 4}, 1.5));
+            std::fstream stream(file.path, std::ios::binary | std::ios::in | std::ios::out);
+            stream.seekp(offset);
+            stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        };
+        overwrite(12, "<f4");
+        REQUIRE_THROWS_AS(chunked::load<float>(file.path), chunked::InvalidFormat);
+        overwrite(10, std::string(1, '\x04'));
+        REQUIRE_THROWS_AS(chunked::load<double>(file.path), chunked::InvalidFormat);
+        overwrite(12, "<f8");
+        REQUIRE(chunked::load<double>(file.path)[0] == 1.5);
+    }
+    SECTION("Shapes that do not fit Size") {
+        // The dimensions and the rows per chunk follow the rank as 64 bit little-endian values
+        const auto overwrite = [&](const std::streamoff offset, const uint64_t value) {
+            chunked::save(file.path, NDArray<double>::filled({64, 4}, 1.5));
+            std::fstream stream(file.path, std::ios::binary | std::ios::in | std::ios::out);
+            stream.seekp(offset);
+            for (Index i = 0; i < 8; ++i) {
+                stream.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+            }
+        };
+        overwrite(16, uint64_t{1} << 32);
+        REQUIRE_THROWS_AS(chunked::Reader(file.path), chunked::InvalidFormat);
+        // 64 rows of 1 << 26 elements overflow the element count
+        overwrite(24, uint64_t{1} << 26);
+        REQUIRE_THROWS_AS(chunked::Reader(file.path), chunked::InvalidFormat);
+        overwrite(32, std::numeric_limits<Size>::max());
+        REQUIRE(nda::eq(chunked::load<double>(file.path), NDArray<double>::filled({64, 4}, 1.5)));
+    }
+}
+
+TEST_CASE("chunked random access", "[chunked]") {
+    const TempFile file("rows.nyc");
+    TestArray array = sensorData(1000, 8);
+    chunked::save(file.path, array, {.chunkBytes = 1000, .threadCount = 4});
+
+    const chunked::Reader reader(file.path);
+    REQUIRE(reader.header().chunkRows == 31);
+    const Vec<std::pair<Index, Index>> ranges{{0, 1000}, {0, 31}, {30, 32}, {500, 777}, {999, 1000}};
+    for (const auto& [begin, end] : ranges) {
+        const auto rows = reader.readRows<float>(begin, end, 4);
+        REQUIRE(rows.shape() == TestArray::Shape{end - begin, 8});
+        const NDArraySlice<TestArray> expected(array, {IndexRange::between(begin, end), IndexRange::e2e()});
+        REQUIRE(nda::eq(rows, nda::materialize(expected)));
+    }
+    REQUIRE(reader.readRows<float>(10, 10).shape() == TestArray::Shape{0, 8});
+    REQUIRE_THROWS_AS(reader.readRows<float>(10, 1001), chunked::InvalidRange);
+    REQUIRE_THROWS_AS(reader.readRows<float>(5, 4), chunked::InvalidRange);
+}
@@ -0,0 +1,116 @@
+#include "nykdtb/csv.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <fstream>
+
+#include "nykdtb/ndarray_ops.hpp"
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+using TestArray = NDArray<float>;
+
+}  // namespace
+
+TEST_CASE("csv parse", "[csv]") {
+    SECTION("Values and blanks") {
+        const auto array = csv::parse<float>("1,2,3\n 4.5 , -5e1,+6\r\n\n  \n7,8,9");
+        REQUIRE(nda::eq(array, TestArray{{1, 2, 3, 4.5F, -50, 6, 7, 8, 9}, {3, 3}}));
+    }
+    SECTION("Delimiters and skipped lines") {
+        const auto tabs = csv::parse<int32_t>("a\tb\n1\t-2\n3\t4\n", {.delimiter = '\t', .skipLines = 1});
+        REQUIRE(nda::eq(tabs, NDArray<int32_t>{{1, -2, 3, 4}, {2, 2}}));
+
+        const auto spaces = csv::parse<double>("0.25 0.5\n1 2\n", {.delimiter = ' '});
+        REQUIRE(nda::eq(spaces, NDArray<double>{{0.25, 0.5, 1, 2}, {2, 2}}));
+    }
+    SECTION("Static arrays") {
+        using Matrix = NDArrayStatic<double, StaticParams, 2, 2>;
+        REQUIRE(nda::eq(csv::parse<Matrix>("1,2\n3,4\n"), Matrix{1, 2, 3, 4}));
+        REQUIRE_THROWS_AS(csv::parse<Matrix>("1,2,3\n"), Matrix::ShapeDoesNotMatchStaticShape);
+    }
+    SECTION("Errors") {
+        REQUIRE_THROWS_AS(csv::parse<float>("1,2\n3\n"), csv::ParseError);
+        REQUIRE_THROWS_AS(csv::parse<float>("1,2\n3,4,5\n"), csv::ParseError);
+        REQUIRE_THROWS_AS(csv::parse<float>("1,x\n"), csv::ParseError);
+        REQUIRE_THROWS_AS(csv::parse<uint8_t>("1,256\n"), csv::ParseError);
+        REQUIRE_THROWS_AS(csv::parse<float>(" \n\n"), csv::ParseError);
+    }
+}
+
+TEST_CASE("csv parse in chunks", "[csv]") {
+    // Enough rows for many chunks, with blank lines landing at chunk boundaries
+    constexpr Size ROWS = 20000;
+    std::string text;
+    for (Index i = 0; i < ROWS; ++i) {
+        text += std::to_string(i) + "," + std::to_string(i * 0.5) + "," + std::to_string(-i) + "\n";
+        if (i % 1000 == 0) {
+            text += "\n";
+        }
+    }
+    const auto serial = csv::parse<double>(text, {.threadCount = 1});
+    REQUIRE(serial.shape() == NDArray<double>::Shape{ROWS, 3});
+    REQUIRE(serial[{ROWS - 1, 1}] == (ROWS - 1) * 0.5);
+
+    const auto parallel = csv::parse<double>(text, {.threadCount = 4});
+    REQUIRE(nda::eq(serial, parallel));
+
+    text += "1,2\n";
+    REQUIRE_THROWS_AS(csv::parse<double>(text, {.threadCount = 4}), csv::ParseError);
+}
+
+TEST_CASE("csv load", "[csv]") {
+    const TempFile file("table.csv");
+    {
+        std::ofstream stream(file.path);
+        stream << "x,y\n1.5,2\n3,4.25\n";
+    }
+    REQUIRE(nda::eq(csv::load<float>(file.path, {.skipLines = 1}), TestArray{{1.5F, 2, 3, 4.25F}, {2, 2}}));
+    REQUIRE_THROWS_AS(csv::load<float>(file.path + ".missing"), MappingFailed);
+}
+
+TEST_CASE("csv format", "[csv]") {
+    SECTION("Layout by rank") {
+        REQUIRE(csv::toString(TestArray{{1, 2.5F, -3}}) == "1,2.5,-3\n");
+        REQUIRE(csv::toString(NDArray<int32_t>{{1, 2, 3, 4}, {2, 2}}, {.delimiter = '\t'}) == "1\t2\n3\t4\n");
+        REQUIRE(csv::toString(NDArray<int32_t>{{1, 2, 3, 4, 5, 6, 7, 8}, {2, 2, 2}}) == "1,2\n3,4\n\n5,6\n7,8\n");
+    }
+    SECTION("Precision and format") {
+        const NDArray<double> values{{0.1, 1.0 / 3.0, 12345.678}};
+        REQUIRE(csv::toString(values) == "0.1,0.3333333333333333,12345.678\n");
+        REQUIRE(csv::toString(values, {.precision = 3}) == "0.1,0.333,1.23e+04\n");
+        REQUIRE(csv::toString(values, {.precision = 2, .format = std::chars_format::fixed}) ==
+                "0.10,0.33,12345.68\n");
+    }
+    SECTION("Views are written in C order") {
+        TestArray array{{1, 2, 3, 4, 5, 6}, {2, 3}};
+        REQUIRE(csv::toString(NDArraySlice<TestArray>(array, {IndexRange::e2e(), IndexRange::single(1)})) == "2\n5\n");
+    }
+    SECTION("Blocks smaller than the text round trip") {
+        TestArray array = TestArray::zeros({300, 7});
+        for (Index i = 0; i < array.size(); ++i) {
+            array[i] = static_cast<float>(i) / 7.0F - 100.0F;
+        }
+        csv::Formatter formatter({.delimiter = ';'}, 16);
+        Size blocks = 0;
+        std::string text;
+        formatter.format(array, [&](const char* data, const std::size_t size) {
+            ++blocks;
+            text.append(data, size);
+        });
+        REQUIRE(blocks > 100);
+        REQUIRE(nda::eq(csv::parse<float>(text, {.delimiter = ';'}), array));
+        REQUIRE(formatter.toString(TestArray{{1, 2}}) == "1;2\n");
+    }
+}
+
+TEST_CASE("csv save", "[csv]") {
+    const TempFile file("saved.csv");
+    const NDArray<double> array{{1e-300, -0.0, 1e300, 42}, {2, 2}};
+    csv::save(file.path, array);
+    REQUIRE(nda::eq(csv::load<double>(file.path), array));
+    REQUIRE_THROWS_AS(csv::save("/nonexistent/nykdtb.csv", array), csv::WriteError);
+}
@@ -0,0 +1,84 @@
+#include "nykdtb/factorization.hpp"
+
+#include <catch2/catch.hpp>
+
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+using TestArray = NDArray<double>;
+
+namespace {
+
+TestArray randomMatrix(Size rows, Size cols, uint32_t seed) { return lcgArray<double>({rows, cols}, seed); }
+
+// A * A^T + n * I is symmetric positive definite
+TestArray spdMatrix(Size n, uint32_t seed) {
+    const auto a = randomMatrix(n, n, seed);
+    auto result  = nda::d2::matMul(a, nda::d2::transpose(a));
+    for (Index i = 0; i < n; ++i) {
+        result[{i, i}] += n;
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("LU factorization", "[factorization]") {
+    SECTION("Small matrix needing pivots") {
+        const TestArray a{{0, 2, 1, 1, 1, 0, 4, 0, 3}, {3, 3}};
+        const nda::d2::LU<double> lu(a);
+        REQUIRE(lu.determinant() == Approx(-10));
+        const auto logDet = lu.logDeterminant();
+        REQUIRE(logDet.sign == -1);
+        REQUIRE(logDet.logAbs == Approx(std::log(10.0)));
+
+        const auto x = lu.solve(TestArray{{3, 2, 7}, {3}});
+        REQUIRE(x.shape() == TestArray::Shape{3});
+        requireApprox(x, TestArray{{1, 1, 1}, {3}}, 1e-12);
+    }
+    SECTION("Many right-hand sides across several solve blocks") {
+        const Size n = 150;
+        const auto a = randomMatrix(n, n, 1);
+        const auto x = randomMatrix(n, 37, 2);
+        const auto b = nda::d2::matMul(a, x);
+        const nda::d2::LU<double> lu(a);
+
+        requireApprox(lu.solve(b), x, 1e-9);
+        requireApprox(nda::d2::matMul(a, lu.inverse()), nda::d2::identity<TestArray>({n, n}), 1e-9);
+    }
+    SECTION("Determinant agrees with the log determinant") {
+        const auto a = randomMatrix(20, 20, 3);
+        const nda::d2::LU<double> lu(a);
+        const auto logDet = lu.logDeterminant();
+        REQUIRE(lu.determinant() == Approx(logDet.sign * std::exp(logDet.logAbs)));
+    }
+    SECTION("Errors") {
+        REQUIRE_THROWS_AS(nda::d2::LU<double>(TestArray{{1, 2, 2, 4}, {2, 2}}), nda::d2::Matrix2DError);
+        REQUIRE_THROWS_AS(nda::d2::LU<double>(TestArray{{1, 2, 3, 4, 5, 6}, {2, 3}}), nda::d2::Matrix2DError);
+        const nda::d2::LU<double> lu(TestArray{{1, 2, 3, 4}, {2, 2}});
+        REQUIRE_THROWS_AS(lu.solve(TestArray{{1, 2, 3}, {3}}), nda::d2::Matrix2DError);
+    }
+}
+
+TEST_CASE("Cholesky factorization", "[factorization]") {
+    SECTION("Known factor") {
+        const TestArray a{{4, 12, -16, 12, 37, -43, -16, -43, 98}, {3, 3}};
+        const nda::d2::Cholesky<double> cholesky(a);
+        requireApprox(cholesky.factor(), TestArray{{2, 0, 0, 6, 1, 0, -8, 5, 3}, {3, 3}}, 1e-12);
+        REQUIRE(cholesky.determinant() == Approx(36));
+        REQUIRE(cholesky.logDeterminant() == Approx(std::log(36.0)));
+    }
+    SECTION("Many right-hand sides across several solve blocks") {
+        const Size n = 140;
+        const auto a = spdMatrix(n, 4);
+        const auto x = randomMatrix(n, 50, 5);
+        const nda::d2::Cholesky<double> cholesky(a);
+
+        requireApprox(cholesky.solve(nda::d2::matMul(a, x)), x, 1e-9);
+        REQUIRE(cholesky.logDeterminant() == Approx(nda::d2::LU<double>(a).logDeterminant().logAbs));
+    }
+    SECTION("Not positive definite") {
+        REQUIRE_THROWS_AS(nda::d2::Cholesky<double>(TestArray{{1, 2, 2, 1}, {2, 2}}), nda::d2::Matrix2DError);
+    }
+}
@@ -0,0 +1,101 @@
+#include "nykdtb/mapped.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "nykdtb/ndarray_ops.hpp"
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+using TestArray = NDArray<float>;
+using IR        = IndexRange;
+
+}  // namespace
+
+TEST_CASE("NDArrayMapped", "[mapped]") {
+    const TempFile file("mapped_array.bin");
+    {
+        auto array = NDArrayMapped<float>::create(file.path, {3, 4});
+        REQUIRE(array.size() == 12);
+        REQUIRE(nda::sum(array) == 0.0F);
+        for (Index i = 0; i < array.size(); ++i) {
+            array[i] = static_cast<float>(i);
+        }
+        array.sync();
+    }
+    REQUIRE(std::filesystem::file_size(file.path) == 12 * sizeof(float));
+
+    SECTION("Read only") {
+        const NDArrayMapped<const float> array(file.path, {3, 4});
+        array.advise(MapAdvice::Sequential);
+        REQUIRE(array.file().mode() == MapMode::ReadOnly);
+        REQUIRE(array[{2, 1}] == 9.0F);
+        REQUIRE(nda::sum(array) == 66.0F);
+        REQUIRE(nda::eq(nda::sum(array, 0), TestArray{{12, 15, 18, 21}, {4}}));
+
+        const TestArray rhs = TestArray::filled({4, 2}, 1.0F);
+        REQUIRE(nda::eq(nda::d2::matMul(array, rhs), TestArray{{6, 6, 22, 22, 38, 38}, {3, 2}}));
+
+        auto& source = const_cast<NDArrayMapped<const float>&>(array);
+        const NDArraySlice<NDArrayMapped<const float>> column(source, {IR::e2e(), IR::single(1)});
+        REQUIRE(nda::eq(nda::materialize(column), TestArray{{1, 5, 9}, {3, 1}}));
+    }
+    SECTION("Read write") {
+        {
+            NDArrayMapped<float> array(file.path, {3, 4});
+            NDArraySlice<NDArrayMapped<float>> lastRow(array, {IR::single(2), IR::e2e()});
+            nda::assign(lastRow, TestArray::filled({1}, -1.0F));
+            nda::addAssignScalar(array, 1.0F);
+            array.sync();
+        }
+        const NDArrayMapped<const float> reopened(file.path, {3, 4});
+        REQUIRE(nda::eq(reopened.clone(), TestArray{{1, 2, 3, 4, 5, 6, 7, 8, 0, 0, 0, 0}, {3, 4}}));
+    }
+    SECTION("Copy on write") {
+        {
+            NDArrayMapped<float> array(file.path, {3, 4}, 0, MapMode::CopyOnWrite);
+            array[0] = 100.0F;
+            REQUIRE(array[0] == 100.0F);
+        }
+        const NDArrayMapped<const float> reopened(file.path, {3, 4});
+        REQUIRE(reopened[0] == 0.0F);
+    }
+    SECTION("Offset and errors") {
+        const NDArrayMapped<const float> tail(file.path, {2, 2}, 8 * sizeof(float));
+        REQUIRE(nda::eq(tail.clone(), TestArray{{8, 9, 10, 11}, {2, 2}}));
+
+        using Mapped = NDArrayMapped<const float>;
+        REQUIRE_THROWS_AS(Mapped(file.path, {4, 4}), Mapped::InvalidMapping);
+        REQUIRE_THROWS_AS(Mapped(file.path, {2}, 2), Mapped::InvalidMapping);
+        REQUIRE_THROWS_AS(NDArrayMapped<float>(file.path, {2}, 0, MapMode::ReadOnly),
+                          NDArrayMapped<float>::InvalidMapping);
+        REQUIRE_THROWS_AS(Mapped(file.path + ".missing", {2}), MappingFailed);
+    }
+}
+
+TEST_CASE("MappedFile", "[mapped]") {
+    const TempFile file("mapped_file.bin");
+    {
+        std::ofstream stream(file.path, std::ios::binary);
+        stream << "header";
+    }
+
+    MappedFile mapped(file.path, MapMode::ReadOnly);
+    REQUIRE(mapped.size() == 6);
+    REQUIRE(static_cast<char>(mapped.data()[0]) == 'h');
+    mapped.advise(MapAdvice::WillNeed, 4);
+
+    MappedFile moved(mmove(mapped));
+    REQUIRE(mapped.data() == nullptr);
+    REQUIRE(static_cast<char>(moved.data()[5]) == 'r');
+
+    const auto empty = MappedFile::create(file.path, 0);
+    REQUIRE(empty.size() == 0);
+    REQUIRE(empty.data() == nullptr);
+    empty.sync();
+}
@@ -1,6 +1,7 @@
 #include "nykdtb/ndarray.hpp"
 
 #include <catch2/catch.hpp>
+#include <complex>
 
 #include "nykdtb/ndarray_ops.hpp"
 
@@ -65,6 +66,27 @@ TEST_CASE("NDArray with four elements and incorrect 2D shape", "[ndarray]") {
     REQUIRE_THROWS_AS(TestArray({1, 2, 3, 4}, {2, 1}), TestArray::ShapeDoesNotMatchSize);
 }
 
+template<typename A>
+constexpr bool HAS_UNINITIALIZED = requires(typename A::Shape shape) { A::uninitialized(shape); };
+
+TEST_CASE("NDArray uninitialized", "[ndarray]") {
+    auto arr = TestArray::uninitialized({3, 4});
+    REQUIRE(arr.size() == 12);
+    REQUIRE(arr.shape() == TestArray::Shape{3, 4});
+    REQUIRE(arr.strides() == TestArray::Shape{4, 1});
+
+    arr.resizeUninitialized({5, 4});
+    REQUIRE(arr.size() == 20);
+    REQUIRE(arr.strides() == TestArray::Shape{4, 1});
+
+    static_assert(HAS_UNINITIALIZED<TestArray>);
+    // Element types with a non-trivial constructor fall back to zeros
+    using ComplexArray = NDArray<std::complex<float>>;
+    static_assert(!HAS_UNINITIALIZED<ComplexArray>);
+    const auto complex = uninitializedArray<ComplexArray>({2});
+    REQUIRE(complex[1] == std::complex<float>{});
+}
+
 TEST_CASE("NDArray calculateStrides tests", "[ndarray]") {
     SECTION("One dimensional shape") {
         REQUIRE(NDArrayCalc::calculateStrides<TestArray::Strides, TestArray::Shape>({7}) == TestArray::Strides{1});
@@ -142,4 +164,89 @@ TEST_CASE("NDArray const slice", "[ndarray]") {
 
     REQUIRE(slc[0] == 3);
     REQUIRE(slc[1] == 4);
-}
\ No newline at end of file
+}
+
+TEST_CASE("NDArraySlice with steps", "[ndarray][slice]") {
+    const TestArray arr({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, {10});
+
+    SECTION("Every second element") {
+        auto slc = slice(arr, {IR::e2e().withStep(2)});
+        REQUIRE(slc.shape(0) == 5);
+        REQUIRE(nda::eq(slc.materialize(), TestArray({0, 2, 4, 6, 8}, {5})));
+    }
+    SECTION("Step not dividing the range") {
+        auto slc = slice(arr, {IR::between(1, 8).withStep(3)});
+        REQUIRE(nda::eq(slc.materialize(), TestArray({1, 4, 7}, {3})));
+        REQUIRE(slc[2] == 7);
+    }
+    SECTION("Reversed") {
+        auto slc = slice(arr, {IR::reversed()});
+        REQUIRE(nda::eq(slc.materialize(), TestArray({9, 8, 7, 6, 5, 4, 3, 2, 1, 0}, {10})));
+    }
+    SECTION("Negative step starts from the last element of the range") {
+        auto slc = slice(arr, {IR::between(2, 8).withStep(-2)});
+        REQUIRE(nda::eq(slc.materialize(), TestArray({7, 5, 3}, {3})));
+        REQUIRE(slc[{1}] == 5);
+    }
+    SECTION("Zero step is rejected") {
+        REQUIRE_THROWS_AS(slice(arr, {IR::e2e().withStep(0)}), NDArraySlice<const TestArray>::InvalidSliceShape);
+    }
+}
+
+TEST_CASE("NDArraySlice with steps in multiple dimensions", "[ndarray][slice]") {
+    TestArray arr({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}, {3, 4});
+
+    SECTION("Subsampled and reversed view") {
+        TestSlice slc(arr, {IR::reversed(), IR::e2e().withStep(2)});
+        REQUIRE(nda::eq(slc.materialize(), TestArray({8, 10, 4, 6, 0, 2}, {3, 2})));
+    }
+    SECTION("Writes through a stepped view") {
+        TestSlice slc(arr, {IR::after(1), IR::after(1).withStep(-2)});
+        nda::addAssign(slc, TestArray({100, 200, 300, 400}, {2, 2}));
+        REQUIRE(nda::eq(arr, TestArray({0, 1, 2, 3, 4, 205, 6, 107, 8, 409, 10, 311}, {3, 4})));
+    }
+    SECTION("Stepped slice of a stepped slice") {
+        TestSlice outer(arr, {IR::e2e(), IR::reversed()});
+        NDArraySlice<TestSlice> inner(outer, {IR::e2e().withStep(2), IR::e2e().withStep(3)});
+        REQUIRE(nda::eq(inner.materialize(), TestArray({3, 0, 11, 8}, {2, 2})));
+        nda::mulAssignScalar(inner, 2.0F);
+        REQUIRE(arr[3] == 6);
+        REQUIRE(arr[8] == 16);
+    }
+}
+
+TEST_CASE("NDArrayPermuted views", "[ndarray][permute]") {
+    TestArray arr({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23}, {2, 3, 4});
+
+    SECTION("Shape and element access follow the axes") {
+        auto view = permute(arr, {2, 0, 1});
+        REQUIRE(view.shape() == TestArray::Shape{4, 2, 3});
+        REQUIRE(view[{3, 1, 2}] == arr[{1, 2, 3}]);
+        REQUIRE(view[1] == arr[{0, 1, 0}]);
+        REQUIRE(view[7] == arr[{0, 1, 1}]);
+    }
+    SECTION("Iteration and materialize") {
+        auto view = permute(arr, {1, 0, 2});
+        REQUIRE(nda::eq(view.materialize(),
+                        TestArray({0, 1, 2, 3, 12, 13, 14, 15, 4,  5,  6,  7,
+                                   16, 17, 18, 19, 8, 9, 10, 11, 20, 21, 22, 23},
+                                  {3, 2, 4})));
+    }
+    SECTION("Writes go to the viewed array") {
+        auto view = permute(arr, {2, 1, 0});
+        nda::addAssign(view, TestArray::filled({4, 3, 2}, 100));
+        view[{0, 0, 1}] = -1;
+        REQUIRE(arr[{1, 0, 0}] == -1);
+        REQUIRE(arr[23] == 123);
+    }
+    SECTION("Permutation of a slice") {
+        TestSlice slc(arr, {IR::single(1), IR::e2e(), IR::between(1, 3)});
+        auto view = permute(slc, {2, 1, 0});
+        REQUIRE(nda::eq(view.materialize(), TestArray({13, 17, 21, 14, 18, 22}, {2, 3, 1})));
+    }
+    SECTION("Invalid axes") {
+        REQUIRE_THROWS_AS(permute(arr, {0, 1}), NDArrayPermuted<TestArray>::InvalidAxes);
+        REQUIRE_THROWS_AS(permute(arr, {0, 1, 1}), NDArrayPermuted<TestArray>::InvalidAxes);
+        REQUIRE_THROWS_AS(permute(arr, {0, 1, 3}), NDArrayPermuted<TestArray>::InvalidAxes);
+    }
+}
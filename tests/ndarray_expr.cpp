@@ -0,0 +1,85 @@
+#include "nykdtb/ndarray_expr.hpp"
+
+#include <catch2/catch.hpp>
+
+using namespace nykdtb;
+
+using TestArray = NDArray<float>;
+using TestSlice = NDArraySlice<TestArray>;
+
+struct TestExprStaticParams {
+    static constexpr Size STORAGE_ALIGNMENT = 16;
+};
+
+TEST_CASE("NDArray expression evaluation", "[ndarray][expr]") {
+    const TestArray a{{1, 2, 3, 4}, {2, 2}};
+    const TestArray b{{2, 2, 2, 2}, {2, 2}};
+    const TestArray c{{1, 2, 3, 4}, {2, 2}};
+    const TestArray d{{1, 1, 1, 1}, {2, 2}};
+
+    SECTION("Fused evaluate into new array") {
+        const auto result = nda::evaluate(nda::lazy(a) + nda::lazy(b) * c - d);
+        REQUIRE(nda::eq(result, TestArray{{2, 5, 8, 11}, {2, 2}}));
+    }
+    SECTION("Scalars and negation") {
+        const auto result = nda::evaluate(-(nda::lazy(a) * 2.0F) + 1.0F);
+        REQUIRE(nda::eq(result, TestArray{{-1, -3, -5, -7}, {2, 2}}));
+    }
+    SECTION("Assign into existing array") {
+        auto target = TestArray::zeros({2, 2});
+        nda::assign(target, nda::lazy(a) / b);
+        REQUIRE(nda::eq(target, TestArray{{0.5, 1, 1.5, 2}, {2, 2}}));
+    }
+    SECTION("Compound assign") {
+        auto target = a.clone();
+        nda::addAssign(target, nda::lazy(b) * d);
+        REQUIRE(nda::eq(target, TestArray{{3, 4, 5, 6}, {2, 2}}));
+    }
+    SECTION("Shape mismatch is rejected") {
+        const TestArray e{{1, 2, 3, 4}, {4}};
+        REQUIRE_THROWS_AS(nda::lazy(a) + e, nda::ShapesDoNotMatch);
+    }
+}
+
+TEST_CASE("NDArray expression into slice and static", "[ndarray][expr]") {
+    SECTION("Slice target and slice operand") {
+        TestArray target = TestArray::zeros({3, 3});
+        const TestArray source{{1, 2, 3, 4, 5, 6, 7, 8, 9}, {3, 3}};
+        const auto operand = slice(source, {IR::between(1, 3), IR::between(1, 3)});
+
+        TestSlice targetSlice(target, {IR::until(2), IR::until(2)});
+        nda::assign(targetSlice, nda::lazy(operand) * 10.0F);
+
+        REQUIRE(nda::eq(target, TestArray{{50, 60, 0, 80, 90, 0, 0, 0, 0}, {3, 3}}));
+    }
+    SECTION("Static operands") {
+        using Static = NDArrayStatic<float, TestExprStaticParams, 2, 2>;
+        const Static lhs{{1, 2, 3, 4}};
+        const Static rhs{{4, 3, 2, 1}};
+
+        const Static result = nda::evaluate(nda::lazy(lhs) + rhs);
+        for (Index i = 0; i < 4; ++i) {
+            REQUIRE(result[i] == 5);
+        }
+    }
+}
+
+TEST_CASE("NDArray expression broadcasting", "[ndarray][expr][broadcast]") {
+    const TestArray x{{1, 2, 3, 4, 5, 6}, {2, 3}};
+    const TestArray bias{{10, 20, 30}, {1, 3}};
+    const TestArray scale{{2, 3}, {2, 1}};
+
+    SECTION("Operands broadcast against each other") {
+        const auto result = nda::evaluate(nda::lazy(x) * scale + bias);
+        REQUIRE(nda::eq(result, TestArray{{12, 24, 36, 22, 35, 48}, {2, 3}}));
+    }
+    SECTION("Expression result shape is the broadcast shape") {
+        const auto result = nda::evaluate(nda::lazy(bias) + scale);
+        REQUIRE(result.shape() == TestArray::Shape{2, 3});
+        REQUIRE(nda::eq(result, TestArray{{12, 22, 32, 13, 23, 33}, {2, 3}}));
+    }
+    SECTION("Incompatible operands") {
+        const TestArray other{{1, 2}, {1, 2}};
+        REQUIRE_THROWS_AS(nda::lazy(x) + other, nda::ShapesDoNotMatch);
+    }
+}
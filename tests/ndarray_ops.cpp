@@ -1,6 +1,7 @@
 #include "nykdtb/ndarray_ops.hpp"
 
 #include <catch2/catch.hpp>
+#include <vector>
 
 using namespace nykdtb;
 
@@ -10,10 +11,10 @@ using TestSlice = NDArraySlice<TestArray>;
 TEST_CASE("NDArray matrix inverse", "[ndarray][matrix]") {
     TestArray arr{{1, 2, 3, 4}, {2, 2}};
     auto result = nda::d2::inverse(arr.clone());
-    REQUIRE(result[{0, 0}] == -2);
-    REQUIRE(result[{0, 1}] == 1);
-    REQUIRE(result[{1, 0}] == 1.5);
-    REQUIRE(result[{1, 1}] == -0.5);
+    REQUIRE(result[{0, 0}] == Approx(-2));
+    REQUIRE(result[{0, 1}] == Approx(1));
+    REQUIRE(result[{1, 0}] == Approx(1.5));
+    REQUIRE(result[{1, 1}] == Approx(-0.5));
 }
 
 TEST_CASE("NDArray matrix multiplication", "[ndarray][matrix]") {
@@ -58,3 +59,264 @@ TEST_CASE("NDArray cross procuct", "[ndarray][matrix]") {
 
     REQUIRE(nda::eq(result, TestArray{{0, 0, 1}, {3}}));
 }
+
+namespace {
+
+TestArray patternMatrix(Size rows, Size cols, Index seed) {
+    auto result = TestArray::zeros({rows, cols});
+    for (Index i = 0; i < result.size(); ++i) {
+        result[i] = static_cast<float>((i * 7 + seed * 3) % 5 - 2);
+    }
+    return result;
+}
+
+TestArray naiveMatMul(const TestArray& lhs, const TestArray& rhs) {
+    auto result = TestArray::zeros({lhs.shape(0), rhs.shape(1)});
+    for (Index i = 0; i < lhs.shape(0); ++i) {
+        for (Index j = 0; j < rhs.shape(1); ++j) {
+            for (Index k = 0; k < lhs.shape(1); ++k) {
+                result[{i, j}] += lhs[{i, k}] * rhs[{k, j}];
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("NDArray matrix multiplication, blocked path", "[ndarray][matrix]") {
+    SECTION("Edges not multiple of register tile, depth over one cache block") {
+        const auto lhs = patternMatrix(67, 300, 1);
+        const auto rhs = patternMatrix(300, 45, 2);
+
+        REQUIRE(nda::eq(nda::d2::matMul(lhs, rhs), naiveMatMul(lhs, rhs)));
+    }
+    SECTION("Slice operand") {
+        auto source    = patternMatrix(80, 90, 3);
+        const auto rhs = patternMatrix(60, 70, 4);
+        const TestSlice lhs(source, {IR::between(5, 75), IR::between(10, 70)});
+
+        REQUIRE(nda::eq(nda::d2::matMul(lhs, rhs), naiveMatMul(lhs.materialize(), rhs)));
+    }
+}
+
+TEST_CASE("NDArray parallel matrix multiplication", "[ndarray][matrix]") {
+    const auto lhs = patternMatrix(200, 150, 5);
+    const auto rhs = patternMatrix(150, 180, 6);
+    const auto ref = naiveMatMul(lhs, rhs);
+
+    SECTION("Explicit thread count") { REQUIRE(nda::eq(nda::d2::parallelMatMul(lhs, rhs, 4), ref)); }
+    SECTION("Default thread count") { REQUIRE(nda::eq(nda::d2::parallelMatMul(lhs, rhs), ref)); }
+    SECTION("Small shape falls back to serial") {
+        const TestArray small{{1, 2, 3, 4, 5, 6}, {3, 2}};
+        const TestArray other{{6, 5, 4, 3, 2, 1}, {2, 3}};
+        REQUIRE(nda::eq(nda::d2::parallelMatMul(small, other, 8), nda::d2::matMul(small, other)));
+    }
+}
+
+TEST_CASE("NDArray broadcasting element-wise ops", "[ndarray][broadcast]") {
+    const TestArray matrix{{1, 2, 3, 4, 5, 6}, {2, 3}};
+
+    SECTION("Bias row added in place") {
+        auto target = matrix.clone();
+        nda::addAssign(target, TestArray{{10, 20, 30}, {1, 3}});
+        REQUIRE(nda::eq(target, TestArray{{11, 22, 33, 14, 25, 36}, {2, 3}}));
+    }
+    SECTION("Missing leading dimension") {
+        auto target = matrix.clone();
+        nda::ewMulAssign(target, TestArray{{1, 0, -1}, {3}});
+        REQUIRE(nda::eq(target, TestArray{{1, 0, -3, 4, 0, -6}, {2, 3}}));
+    }
+    SECTION("Column broadcast") {
+        auto target = matrix.clone();
+        nda::subAssign(target, TestArray{{1, 4}, {2, 1}});
+        REQUIRE(nda::eq(target, TestArray{{0, 1, 2, 0, 1, 2}, {2, 3}}));
+    }
+    SECTION("Left operand expanded to the common shape") {
+        const auto result = nda::add(TestArray{{10, 20}, {2, 1}}, TestArray{{1, 2, 3}, {1, 3}});
+        REQUIRE(nda::eq(result, TestArray{{11, 12, 13, 21, 22, 23}, {2, 3}}));
+    }
+    SECTION("Broadcast into a slice") {
+        auto target = matrix.clone();
+        TestSlice lastColumns(target, {IR::e2e(), IR::after(1)});
+        nda::assign(lastColumns, TestArray::filled({1}, 7));
+        REQUIRE(nda::eq(target, TestArray{{1, 7, 7, 4, 7, 7}, {2, 3}}));
+    }
+    SECTION("Incompatible shapes") {
+        auto target = matrix.clone();
+        REQUIRE_THROWS_AS(nda::addAssign(target, TestArray{{1, 2}, {2}}), nda::ShapesDoNotMatch);
+        REQUIRE_THROWS_AS(nda::addAssign(target, TestArray{{1, 2, 3, 4, 5, 6}, {3, 2}}), nda::ShapesDoNotMatch);
+    }
+}
+
+TEST_CASE("NDArray element-wise ops on slices", "[ndarray][slice]") {
+    auto source = patternMatrix(6, 40, 7);
+    auto ref    = source.clone();
+
+    SECTION("Partial inner dimension against a slice of another array") {
+        auto other = patternMatrix(6, 40, 8);
+        TestSlice target(source, {IR::between(1, 5), IR::between(3, 37)});
+        const TestSlice operand(other, {IR::between(2, 6), IR::between(0, 34)});
+        nda::addAssign(target, operand);
+        for (Index i = 1; i < 5; ++i) {
+            for (Index j = 3; j < 37; ++j) {
+                ref[{i, j}] += other[{i + 1, j - 3}];
+            }
+        }
+        REQUIRE(nda::eq(source, ref));
+    }
+    SECTION("Full rows are one run") {
+        TestSlice rows(source, {IR::between(2, 5), IR::e2e()});
+        nda::mulAssignScalar(rows, 3.0F);
+        for (Index i = 2 * 40; i < 5 * 40; ++i) {
+            ref[i] *= 3.0F;
+        }
+        REQUIRE(nda::eq(source, ref));
+    }
+    SECTION("Slice of a slice") {
+        TestSlice outer(source, {IR::between(1, 6), IR::between(5, 35)});
+        NDArraySlice<TestSlice> inner(outer, {IR::between(1, 3), IR::between(2, 22)});
+        nda::subAssign(inner, TestArray::filled({2, 20}, 1));
+        for (Index i = 2; i < 4; ++i) {
+            for (Index j = 7; j < 27; ++j) {
+                ref[{i, j}] -= 1;
+            }
+        }
+        REQUIRE(nda::eq(source, ref));
+        const TestSlice refBlock(ref, {IR::between(2, 4), IR::between(7, 27)});
+        REQUIRE(nda::eq(inner, refBlock));
+    }
+    SECTION("Reductions") {
+        const TestSlice column(source, {IR::e2e(), IR::single(4)});
+        const auto dense = column.materialize();
+        REQUIRE(nda::dot(column, column) == nda::dot(dense, dense));
+        REQUIRE(nda::magnitude(column) == nda::magnitude(dense));
+        REQUIRE(nda::eq(column, dense));
+    }
+    SECTION("Comparisons stop at the first difference") {
+        source[{1, 2}] = 100.0F;
+        const TestSlice block(source, {IR::between(1, 4), IR::between(2, 30)});
+        const TestSlice shifted(source, {IR::between(2, 5), IR::between(2, 30)});
+        Size visited = 0;
+        REQUIRE(!nda::allElementPairs(block, shifted, [&](const float l, const float r) {
+            ++visited;
+            return l == r;
+        }));
+        REQUIRE(visited == 1);
+        REQUIRE(!nda::eq(block, shifted));
+    }
+    SECTION("Iterator visits slice elements in order") {
+        const TestSlice block(source, {IR::between(1, 4), IR::between(38, 40)});
+        std::vector<float> visited(block.begin(), block.end());
+        REQUIRE(visited == std::vector<float>{source[{1, 38}], source[{1, 39}], source[{2, 38}],
+                                              source[{2, 39}], source[{3, 38}], source[{3, 39}]});
+    }
+}
+
+TEST_CASE("NDArray transposed views", "[ndarray][matrix]") {
+    SECTION("Transpose of a matrix") {
+        const TestArray matrix{{1, 2, 3, 4, 5, 6}, {2, 3}};
+        const auto view = nda::d2::transpose(matrix);
+        REQUIRE(nda::eq(view, TestArray{{1, 4, 2, 5, 3, 6}, {3, 2}}));
+        auto cube = TestArray::zeros({2, 2, 2});
+        REQUIRE_THROWS_AS(nda::d2::transpose(cube), nda::d2::Matrix2DError);
+    }
+    SECTION("Transposed operands of matMul") {
+        const auto lhs  = patternMatrix(120, 70, 9);
+        const auto rhs  = patternMatrix(90, 120, 10);
+        const auto lhsT = nda::d2::transpose(lhs).materialize();
+        const auto rhsT = nda::d2::transpose(rhs).materialize();
+
+        const auto ref = naiveMatMul(lhsT, rhsT);
+        REQUIRE(nda::eq(nda::d2::matMul(nda::d2::transpose(lhs), nda::d2::transpose(rhs)), ref));
+        REQUIRE(nda::eq(nda::d2::parallelMatMul(nda::d2::transpose(lhs), rhsT, 3), ref));
+        REQUIRE(nda::eq(nda::d2::matMul(lhsT, nda::d2::transpose(rhs)), ref));
+    }
+    SECTION("Element-wise ops on a transposed view") {
+        auto matrix = patternMatrix(5, 7, 11);
+        auto ref    = matrix.clone();
+        auto view   = nda::d2::transpose(matrix);
+        nda::addAssign(view, nda::d2::transpose(ref));
+        nda::mulAssignScalar(view, 0.5F);
+        REQUIRE(nda::eq(matrix, ref));
+        REQUIRE(nda::dot(view, view) == nda::dot(ref, ref));
+    }
+}
+
+TEST_CASE("NDArray matrix inverse with pivoting", "[ndarray][matrix]") {
+    SECTION("Zero on the diagonal needs a row swap") {
+        const TestArray arr{{0, 2, 1, 0, 1, 0, 4, 0, 3}, {3, 3}};
+        const auto result  = nda::d2::inverse(arr);
+        const auto product = nda::d2::matMul(arr, result);
+        for (Index i = 0; i < 3; ++i) {
+            for (Index j = 0; j < 3; ++j) {
+                REQUIRE(product[{i, j}] == Approx(i == j ? 1.0F : 0.0F).margin(1e-6));
+            }
+        }
+    }
+    SECTION("Larger than one panel, shared workspace") {
+        NDArray<double> arr = NDArray<double>::zeros({75, 75});
+        uint32_t state = 12345;
+        for (Index i = 0; i < arr.size(); ++i) {
+            state  = state * 1664525U + 1013904223U;
+            arr[i] = static_cast<double>(state >> 8) / static_cast<double>(1U << 24) - 0.5;
+        }
+        nda::lu::Workspace<double> workspace;
+        const auto result  = nda::d2::inverse(arr, workspace);
+        const auto product = nda::d2::matMul(arr, result);
+        for (Index i = 0; i < 75; ++i) {
+            for (Index j = 0; j < 75; ++j) {
+                REQUIRE(product[{i, j}] == Approx(i == j ? 1.0 : 0.0).margin(1e-9));
+            }
+        }
+        REQUIRE(nda::eq(nda::d2::inverse(arr, workspace), result));
+    }
+    SECTION("Slice input") {
+        TestArray arr{{9, 1, 2, 9, 3, 4}, {2, 3}};
+        const TestSlice square(arr, {IR::e2e(), IR::after(1)});
+        REQUIRE(nda::eq(nda::d2::inverse(square), nda::d2::inverse(TestArray{{1, 2, 3, 4}, {2, 2}})));
+    }
+    SECTION("Singular matrix") {
+        const TestArray arr{{1, 2, 2, 4}, {2, 2}};
+        REQUIRE_THROWS_AS(nda::d2::inverse(arr), nda::d2::Matrix2DError);
+    }
+}
+
+TEST_CASE("NDArray parallel loops over the outer dimension", "[ndarray][parallel]") {
+    TestArray arr = TestArray::zeros({37, 3});
+
+    nda::parallelForOuter(
+        arr,
+        [](Index begin, auto& rows) {
+            for (Index i = 0; i < rows.shape(0); ++i) {
+                for (Index j = 0; j < rows.shape(1); ++j) {
+                    rows[{i, j}] = static_cast<TestArray::Type>((begin + i) * 3 + j);
+                }
+            }
+        },
+        4,
+        5);
+    for (Index i = 0; i < arr.size(); ++i) {
+        REQUIRE(arr[i] == static_cast<TestArray::Type>(i));
+    }
+
+    const TestArray& constArr = arr;
+    const auto total = nda::parallelReduceOuter(
+        constArr,
+        TestArray::Type{0},
+        [](Index, const auto& rows) {
+            TestArray::Type result = 0;
+            for (const auto value : rows) {
+                result += value;
+            }
+            return result;
+        },
+        [](auto lhs, auto rhs) { return lhs + rhs; },
+        3);
+    REQUIRE(total == Approx(110 * 111 / 2));
+
+    TestSlice odd(arr, {IR::e2e().withStep(2), IR::between(1, 3)});
+    const auto rows = nda::parallelReduceOuter(
+        odd, Size{0}, [](Index, const auto& block) { return block.shape(0); }, std::plus<Size>{}, 2, 4);
+    REQUIRE(rows == 19);
+}
@@ -2,6 +2,7 @@
 
 #include "nykdtb/ndarray.hpp"
 #include "nykdtb/ndarray_ops.hpp"
+#include "testutils.hpp"
 
 using namespace nykdtb;
 
@@ -44,8 +45,81 @@ TEST_CASE("NDArray static matMul", "[ndarray][static]") {
 TEST_CASE("NDArray static matrix inverse", "[ndarray][static]") {
     StaticTestArray<2, 2> arr{{1, 2, 3, 4}};
     auto result = nda::d2::inverse(arr.clone());
-    REQUIRE(result[{0, 0}] == -2);
-    REQUIRE(result[{0, 1}] == 1);
-    REQUIRE(result[{1, 0}] == 1.5);
-    REQUIRE(result[{1, 1}] == -0.5);
-}
\ No newline at end of file
+    REQUIRE(result[{0, 0}] == Approx(-2));
+    REQUIRE(result[{0, 1}] == Approx(1));
+    REQUIRE(result[{1, 0}] == Approx(1.5));
+    REQUIRE(result[{1, 1}] == Approx(-0.5));
+}
+
+namespace {
+
+template<Size M, Size N>
+StaticTestArray<M, N> lcgStatic(uint32_t seed) {
+    StaticTestArray<M, N> result;
+    lcgFill(result, seed);
+    return result;
+}
+
+template<typename Static>
+DynamicTestArray toDynamic(const Static& array) {
+    return DynamicTestArray(array.begin(), array.end(), DynamicTestArray::Shape{array.shape(0), array.shape(1)});
+}
+
+// The closed-form kernels are checked against the dynamic gemm and LU paths
+template<Size N>
+void checkClosedForm(uint32_t seed) {
+    const auto a = lcgStatic<N, N>(seed);
+    requireApprox(nda::d2::inverse(a), nda::d2::inverse(toDynamic(a)), 1e-4);
+    REQUIRE(nda::d2::determinant(a) == Approx(nda::d2::determinant(toDynamic(a))).margin(1e-6));
+    requireApprox(nda::d2::matMul(a, nda::d2::inverse(a)), nda::d2::identity<DynamicTestArray>({N, N}), 1e-4);
+}
+
+}  // namespace
+
+TEST_CASE("NDArray static shaped matMul", "[ndarray][static]") {
+    const auto lhs = lcgStatic<3, 4>(1);
+    const auto rhs = lcgStatic<4, 2>(2);
+
+    const auto result = nda::d2::matMul(lhs, rhs);
+    static_assert(std::is_same_v<std::remove_cvref_t<decltype(result)>, StaticTestArray<3, 2>>);
+    requireApprox(result, nda::d2::matMul(toDynamic(lhs), toDynamic(rhs)), 1e-4);
+
+    SECTION("4x4 float") {
+        const auto a = lcgStatic<4, 4>(3);
+        const auto b = lcgStatic<4, 4>(4);
+        requireApprox(nda::d2::matMul(a, b), nda::d2::matMul(toDynamic(a), toDynamic(b)), 1e-4);
+    }
+    SECTION("Larger than the unrolled limit") {
+        const auto a = lcgStatic<9, 7>(5);
+        const auto b = lcgStatic<7, 5>(6);
+        requireApprox(nda::d2::matMul(a, b), nda::d2::matMul(toDynamic(a), toDynamic(b)), 1e-4);
+    }
+}
+
+TEST_CASE("NDArray static closed-form inverse and determinant", "[ndarray][static]") {
+    checkClosedForm<1>(7);
+    checkClosedForm<2>(8);
+    checkClosedForm<3>(9);
+    checkClosedForm<4>(10);
+
+    REQUIRE(nda::d2::determinant(StaticTestArray<3, 3>{{2, 0, 1, 1, 3, 2, 1, 1, 2}}) == Approx(6));
+    REQUIRE_THROWS_AS(nda::d2::inverse(StaticTestArray<3, 3>{{1, 2, 3, 2, 4, 6, 0, 1, 1}}), nda::d2::Matrix2DError);
+}
+
+TEST_CASE("NDArray static transposed", "[ndarray][static]") {
+    const StaticTestArray<2, 3> a{{1, 2, 3, 4, 5, 6}};
+    const auto result = nda::d2::transposed(a);
+    static_assert(std::is_same_v<std::remove_cvref_t<decltype(result)>, StaticTestArray<3, 2>>);
+    REQUIRE(nda::eq(toDynamic(result), DynamicTestArray{{1, 4, 2, 5, 3, 6}, {3, 2}}));
+}
+
+TEST_CASE("NDArray static kernels are constexpr", "[ndarray][static]") {
+    using Matrix          = NDArrayStatic<double, TestNDArrayStaticParams, 2, 2>;
+    constexpr Matrix a    = Matrix{{1, 2, 3, 4}};
+    constexpr Matrix prod = nda::d2::matMul(a, nda::d2::transposed(a));
+    constexpr Matrix inv  = nda::d2::inverse(a);
+    static_assert(prod[1] == 11 && prod[3] == 25);
+    static_assert(inv[0] == -2 && inv[3] == -0.5);
+    static_assert(nda::d2::determinant(a) == -2);
+    REQUIRE(prod[0] == 5);
+}
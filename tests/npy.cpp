@@ -0,0 +1,164 @@
+#include "nykdtb/npy.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+using TestArray = NDArray<float>;
+using IR        = IndexRange;
+
+std::string fileContents(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+// An .npy file with the given header and raw element bytes
+void writeRaw(const std::string& path, const npy::Header& header, const void* data, const std::size_t bytes) {
+    std::ofstream stream(path, std::ios::binary);
+    stream << npy::formatHeader(header);
+    stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+}
+
+}  // namespace
+
+TEST_CASE("npy header", "[npy]") {
+    const std::string header = npy::formatHeader({"<f4", false, {3, 4}});
+    REQUIRE(header.size() == 128);
+    REQUIRE(header.substr(0, 8) == std::string("\x93NUMPY\x01\x00", 8));
+    REQUIRE(header.substr(10).find("{'descr': '<f4', 'fortran_order': False, 'shape': (3, 4), }") == 0);
+    REQUIRE(header.back() == '\n');
+    REQUIRE(npy::formatHeader({"<i8", true, {5}}).find("'shape': (5,)") != std::string::npos);
+
+    const auto parsed = npy::parseHeader(reinterpret_cast<const std::byte*>(header.data()), header.size());
+    REQUIRE(parsed.descr == "<f4");
+    REQUIRE(!parsed.fortranOrder);
+    REQUIRE(parsed.shape == npy::Shape{3, 4});
+    REQUIRE(parsed.dataOffset == 128);
+
+    const std::string garbage = "not an npy file";
+    REQUIRE_THROWS_AS(npy::parseHeader(reinterpret_cast<const std::byte*>(garbage.data()), garbage.size()),
+                      npy::InvalidFormat);
+
+    // The dictionary ends inside the shape, the buffer holds nothing past it
+    const std::string dict      = "{'descr': '<f4', 'fortran_order': False, 'shape': (3,";
+    const std::string truncated = std::string("\x93NUMPY\x01\x00", 8) + static_cast<char>(dict.size()) + '\0' + dict;
+    const Vec<std::byte> bytes(reinterpret_cast<const std::byte*>(truncated.data()),
+                               reinterpret_cast<const std::byte*>(truncated.data()) + truncated.size());
+    REQUIRE_THROWS_AS(npy::parseHeader(bytes.data(), bytes.size()), npy::InvalidFormat);
+
+    // Element counts and strides that overflow Size, even when another dimension is empty
+    for (const npy::Shape& shape : {npy::Shape{65536, 65536}, npy::Shape{0, 65536, 65536}}) {
+        const std::string oversized = npy::formatHeader({"<f4", false, shape});
+        REQUIRE_THROWS_AS(npy::parseHeader(reinterpret_cast<const std::byte*>(oversized.data()), oversized.size()),
+                          npy::InvalidFormat);
+    }
+
+    // A version 2 header length far beyond the end of the file
+    const TempFile file("header_length.npy");
+    std::ofstream(file.path, std::ios::binary) << std::string("\x93NUMPY\x02\x00\xF0\xFF\xFF\xFF{'descr'", 20);
+    REQUIRE_THROWS_AS(npy::readHeader(file.path), npy::InvalidFormat);
+    REQUIRE_THROWS_AS(npy::load<float>(file.path), npy::InvalidFormat);
+}
+
+TEST_CASE("npy save and load", "[npy]") {
+    const TempFile file("array.npy");
+
+    SECTION("Dynamic arrays") {
+        TestArray array = TestArray::zeros({3, 5});
+        for (Index i = 0; i < array.size(); ++i) {
+            array[i] = static_cast<float>(i) * 0.5F;
+        }
+        npy::save(file.path, array);
+        REQUIRE(std::filesystem::file_size(file.path) == 128 + 15 * sizeof(float));
+        REQUIRE(nda::eq(npy::load<float>(file.path), array));
+
+        REQUIRE_THROWS_AS(npy::load<double>(file.path), npy::DtypeMismatch);
+        using Transposed = NDArrayStatic<float, StaticParams, 5, 3>;
+        REQUIRE_THROWS_AS(npy::load<Transposed>(file.path), Transposed::ShapeDoesNotMatchStaticShape);
+    }
+    SECTION("Integer, bool and static arrays") {
+        const NDArray<int16_t> shorts{{-1, 2, -3}};
+        npy::save(file.path, shorts);
+        REQUIRE(nda::eq(npy::load<int16_t>(file.path), shorts));
+
+        const NDArray<bool> flags{{true, false, true, true}, {2, 2}};
+        npy::save(file.path, flags);
+        REQUIRE(fileContents(file.path).find("'|b1'") != std::string::npos);
+        REQUIRE(nda::eq(npy::load<bool>(file.path), flags));
+
+        using Matrix = NDArrayStatic<double, StaticParams, 2, 3>;
+        const Matrix matrix{1, 2, 3, 4, 5, 6};
+        npy::save(file.path, matrix);
+        REQUIRE(nda::eq(npy::load<Matrix>(file.path), matrix));
+    }
+    SECTION("Slices are written densely") {
+        TestArray array{{1, 2, 3, 4, 5, 6}, {2, 3}};
+        const NDArraySlice<TestArray> columns(array, {IR::e2e(), IR::e2e().withStep(2)});
+        npy::save(file.path, columns);
+        REQUIRE(nda::eq(npy::load<float>(file.path), TestArray{{1, 3, 4, 6}, {2, 2}}));
+    }
+    SECTION("Fortran order is transposed to C order") {
+        // Column-major storage of {{1, 2, 3}, {4, 5, 6}}
+        const int32_t data[] = {1, 4, 2, 5, 3, 6};
+        writeRaw(file.path, {"<i4", true, {2, 3}}, data, sizeof(data));
+        REQUIRE(nda::eq(npy::load<int32_t>(file.path), NDArray<int32_t>{{1, 2, 3, 4, 5, 6}, {2, 3}}));
+        REQUIRE_THROWS_AS(npy::map<const int32_t>(file.path), npy::LayoutMismatch);
+    }
+    SECTION("Foreign byte order") {
+        const uint8_t data[] = {0, 0, 1, 2, 0xFF, 0xFF, 0xFF, 0xFE};
+        const std::string foreign = std::endian::native == std::endian::little ? ">i4" : "<i4";
+        writeRaw(file.path, {foreign, false, {2}}, data, sizeof(data));
+        REQUIRE(nda::eq(npy::load<int32_t>(file.path), NDArray<int32_t>{{258, -2}}));
+        REQUIRE_THROWS_AS(npy::map<const int32_t>(file.path), npy::LayoutMismatch);
+    }
+    SECTION("Truncated data") {
+        const float data[] = {1, 2};
+        writeRaw(file.path, {"<f4", false, {3}}, data, sizeof(data));
+        REQUIRE_THROWS_AS(npy::load<float>(file.path), npy::InvalidFormat);
+    }
+}
+
+TEST_CASE("npy map", "[npy]") {
+    const TempFile file("mapped.npy");
+    npy::save(file.path, TestArray{{1, 2, 3, 4, 5, 6}, {3, 2}});
+
+    {
+        const auto mapped = npy::map<const float>(file.path);
+        REQUIRE(mapped.shape() == TestArray::Shape{3, 2});
+        REQUIRE(reinterpret_cast<const std::byte*>(mapped.begin()) == mapped.file().data() + 128);
+        REQUIRE(nda::sum(mapped) == 21.0F);
+    }
+    {
+        auto mapped = npy::map<float>(file.path);
+        nda::mulAssignScalar(mapped, 2.0F);
+    }
+    REQUIRE(nda::eq(npy::load<float>(file.path), TestArray{{2, 4, 6, 8, 10, 12}, {3, 2}}));
+}
+
+TEST_CASE("npy streaming writer", "[npy]") {
+    const TempFile file("stream.npy");
+
+    npy::Writer<float> writer(file.path, {3});
+    writer.append(TestArray{{1, 2, 3}});
+    writer.append(TestArray{{4, 5, 6, 7, 8, 9}, {2, 3}});
+    REQUIRE(writer.rows() == 3);
+    REQUIRE_THROWS_AS(writer.append(TestArray{{1, 2}}), npy::LayoutMismatch);
+
+    writer.flush();
+    REQUIRE(npy::readHeader(file.path).shape == npy::Shape{3, 3});
+    const auto headerLength = npy::readHeader(file.path).dataOffset;
+
+    TestArray block{{0, 0, 0, 10, 11, 12}, {2, 3}};
+    writer.append(NDArraySlice<TestArray>(block, {IR::single(1), IR::e2e()}));
+    writer.close();
+
+    REQUIRE(npy::readHeader(file.path).dataOffset == headerLength);
+    REQUIRE(nda::eq(npy::load<float>(file.path), TestArray{{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, {4, 3}}));
+}
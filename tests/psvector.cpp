@@ -15,6 +15,39 @@ using RefArr = std::array<ContainerTestAppliance, SIZE>;
 
 using RefVec = std::vector<ContainerTestAppliance>;
 
+namespace {
+
+// Owns a heap value, counts the move constructions that were not skipped by relocation
+struct Relocatable {
+    static inline Size moves = 0;
+
+    explicit Relocatable(int value)
+        : value(new int(value)) {}
+    Relocatable(const Relocatable& other)
+        : value(new int(*other.value)) {}
+    Relocatable& operator=(const Relocatable& other) {
+        *value = *other.value;
+        return *this;
+    }
+    Relocatable(Relocatable&& other) noexcept
+        : value(other.value) {
+        other.value = nullptr;
+        ++moves;
+    }
+    Relocatable& operator=(Relocatable&& other) noexcept {
+        std::swap(value, other.value);
+        return *this;
+    }
+    ~Relocatable() { delete value; }
+
+    int* value;
+};
+
+}  // namespace
+
+template<>
+struct nykdtb::IsTriviallyRelocatable<Relocatable> : std::true_type {};
+
 TEST_CASE("PSVec DefaultConstruct", "[psvec]") {
     TestVec<4> test;
     REQUIRE(test.empty());
@@ -205,7 +238,13 @@ TEST_CASE("PSVec Erase two elements on heap with container 4 size, move back to
         test.emplace_back(r.track());
     }
 
+    // Still well above a quarter of the capacity, the heap storage is kept
     test.erase(test.begin() + 1, test.begin() + 3);
+    REQUIRE_FALSE(test.onStack());
+    REQUIRE(test.size() == 4);
+    REQUIRE(ref[3].compare({Op::Default, Op::Moved, Op::Moved}));
+
+    test.shrink_to_fit();
     REQUIRE(test.onStack());
     REQUIRE(test.size() == 4);
     REQUIRE(ref[0] == test[0]);
@@ -653,3 +692,183 @@ TEST_CASE("PSVec resize reduce from heap to stack") {
     REQUIRE(init.compare({Op::Default, Op::Destructed}));
     REQUIRE(test[0].compare({Op::Default, Op::Moved, Op::Moved}));
 }
+
+TEST_CASE("PSVec reserve and capacity", "[psvec]") {
+    PSVec<int, 4> test;
+    REQUIRE(test.capacity() == 4);
+    test.reserve(3);
+    REQUIRE(test.onStack());
+
+    test.reserve(100);
+    REQUIRE_FALSE(test.onStack());
+    REQUIRE(test.capacity() == 100);
+    const int* storage = test.begin();
+    for (Index i = 0; i < 100; ++i) {
+        test.push_back(i);
+    }
+    REQUIRE(test.begin() == storage);
+    REQUIRE(test.capacity() == 100);
+
+    test.push_back(100);
+    REQUIRE(test.capacity() == 202);
+    REQUIRE(test[100] == 100);
+}
+
+TEST_CASE("PSVec resize allocates exactly", "[psvec]") {
+    PSVec<int, 4> test{1, 2, 3};
+    test.resize(50);
+    REQUIRE(test.capacity() == 50);
+    REQUIRE(test[2] == 3);
+    REQUIRE(test[49] == 0);
+
+    test.resize(60, 7);
+    REQUIRE(test.capacity() == 60);
+    REQUIRE(test[59] == 7);
+
+    // Appending past the resized capacity grows geometrically again
+    test.push_back(60);
+    REQUIRE(test.capacity() == 122);
+}
+
+TEST_CASE("PSVec exact allocation on construction", "[psvec]") {
+    const auto filled = PSVec<int, 4>::constructFilled(50, 7);
+    REQUIRE(filled.capacity() == 50);
+    const PSVec<int, 4> copy(filled);
+    REQUIRE(copy.capacity() == 50);
+}
+
+TEST_CASE("PSVec shrink hysteresis", "[psvec]") {
+    PSVec<int, 4> test;
+    for (Index i = 0; i < 5; ++i) {
+        test.push_back(i);
+    }
+    REQUIRE(test.capacity() == 10);
+    const int* storage = test.begin();
+
+    // Oscillating around the stack size keeps the heap block
+    for (Index round = 0; round < 10; ++round) {
+        test.erase(test.end() - 1);
+        REQUIRE_FALSE(test.onStack());
+        test.push_back(4);
+        REQUIRE(test.begin() == storage);
+    }
+
+    test.resize(2);
+    REQUIRE(test.onStack());
+    REQUIRE(test[0] == 0);
+    REQUIRE(test[1] == 1);
+}
+
+TEST_CASE("PSVec shrink to fit on heap", "[psvec]") {
+    PSVec<int, 2> test;
+    for (Index i = 0; i < 40; ++i) {
+        test.push_back(i);
+    }
+    test.resize(30);
+    REQUIRE(test.capacity() == 62);
+    test.shrink_to_fit();
+    REQUIRE(test.capacity() == 30);
+    REQUIRE(test[29] == 29);
+
+    test.resize(7);
+    REQUIRE(test.capacity() == 14);
+    REQUIRE(test[6] == 6);
+}
+
+TEST_CASE("PSVec custom growth factor", "[psvec]") {
+    PSVec<int, 2, alignof(int), MallocAllocator, PSVecGrowth<150, 2>> test;
+    for (Index i = 0; i < 3; ++i) {
+        test.push_back(i);
+    }
+    REQUIRE(test.capacity() == 4);
+    test.push_back(3);
+    test.push_back(4);
+    REQUIRE(test.capacity() == 7);
+    test.resize(3);
+    REQUIRE(test.onStack() == false);
+    test.erase(test.begin());
+    REQUIRE(test.onStack());
+}
+
+TEST_CASE("PSVec relocates opted in types without moving them", "[psvec]") {
+    Relocatable::moves = 0;
+    PSVec<Relocatable, 2> test;
+    for (int i = 0; i < 100; ++i) {
+        test.emplace_back(i);
+    }
+    REQUIRE(Relocatable::moves == 0);
+
+    auto moved = mmove(test);
+    moved.erase(moved.begin() + 1, moved.end());
+    moved.shrink_to_fit();
+    REQUIRE(moved.onStack());
+    REQUIRE(*moved[0].value == 0);
+    REQUIRE(Relocatable::moves == 0);
+}
+
+TEST_CASE("PSVec erases relocatable elements from the middle", "[psvec]") {
+    Relocatable::moves = 0;
+    PSVec<Relocatable, 2> test;
+    for (int i = 0; i < 8; ++i) {
+        test.emplace_back(i);
+    }
+
+    test.erase(test.begin() + 1);
+    REQUIRE(test.size() == 7);
+    REQUIRE(*test[0].value == 0);
+    for (Index i = 1; i < 7; ++i) {
+        REQUIRE(*test[i].value == i + 1);
+    }
+
+    test.erase(test.begin() + 2, test.begin() + 4);
+    REQUIRE(test.size() == 5);
+    REQUIRE(*test[1].value == 2);
+    REQUIRE(*test[2].value == 5);
+    REQUIRE(*test[4].value == 7);
+    REQUIRE(Relocatable::moves == 0);
+}
+
+TEST_CASE("PSVec trivially copyable insert and erase", "[psvec]") {
+    PSVec<int, 4> test;
+    std::vector<int> ref;
+    for (int i = 0; i < 20; ++i) {
+        test.push_back(i);
+        ref.push_back(i);
+    }
+
+    const int inserted[] = {100, 101, 102};
+    test.insert(test.begin() + 5, std::begin(inserted), std::end(inserted));
+    ref.insert(ref.begin() + 5, std::begin(inserted), std::end(inserted));
+    test.erase(test.begin() + 2, test.begin() + 9);
+    ref.erase(ref.begin() + 2, ref.begin() + 9);
+    // Interval longer than the elements behind it
+    test.erase(test.end() - 5, test.end() - 1);
+    ref.erase(ref.end() - 5, ref.end() - 1);
+    test.erase(test.end() - 1);
+    ref.erase(ref.end() - 1);
+
+    REQUIRE(std::vector<int>(test.begin(), test.end()) == ref);
+    const PSVec<int, 4> copy(test);
+    REQUIRE(copy == test);
+}
+
+TEST_CASE("PSVec resize uninitialized", "[psvec]") {
+    PSVec<int, 4> test{1, 2, 3};
+    test.resizeUninitialized(40);
+    REQUIRE(test.size() == 40);
+    REQUIRE(test.capacity() == 40);
+    REQUIRE(test.onStack() == false);
+    REQUIRE(test[2] == 3);
+    for (Index i = 3; i < 40; ++i) {
+        test[i] = static_cast<int>(i);
+    }
+    REQUIRE(test[39] == 39);
+
+    test.resizeUninitialized(2);
+    REQUIRE(test.onStack());
+    REQUIRE(test[1] == 2);
+
+    const auto constructed = PSVec<int, 4>::constructUninitialized(10);
+    REQUIRE(constructed.size() == 10);
+    REQUIRE(constructed.capacity() == 10);
+}
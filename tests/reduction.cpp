@@ -0,0 +1,186 @@
+#include "nykdtb/reduction.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <functional>
+
+#include "nykdtb/ndarray_ops.hpp"
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+using TestArray = NDArray<double>;
+using TestSlice = NDArraySlice<TestArray>;
+using IR        = IndexRange;
+
+namespace {
+
+// Multiples of 1/8 in [-125, 125]
+template<typename T>
+NDArray<T> eighthsArray(typename NDArray<T>::Shape shape, uint32_t seed) {
+    auto result = NDArray<T>::zeros(mmove(shape));
+    for (Index i = 0; i < result.size(); ++i) {
+        result[i] = static_cast<T>(static_cast<int32_t>(lcgNext(seed) >> 16) % 2001 - 1000) / T(8);
+    }
+    return result;
+}
+
+// The norm of integer arrays would truncate the square root
+template<typename A>
+concept HasNorm = requires(const A& array) { nda::norm(array); };
+
+// Straightforward reference: gathers the elements of every output along the axis in order
+template<NDArrayLike A>
+Vec<Vec<double>> gatherAlongAxis(const A& array, const Index axis) {
+    const auto dense = nda::materialize(array);
+    const auto shape = dense.shape();
+    Size outer       = 1;
+    Size inner       = 1;
+    for (Index i = 0; i < static_cast<Size>(shape.size()); ++i) {
+        if (i < axis) {
+            outer *= shape[i];
+        } else if (i > axis) {
+            inner *= shape[i];
+        }
+    }
+    Vec<Vec<double>> result(outer * inner);
+    for (Index o = 0; o < outer; ++o) {
+        for (Index k = 0; k < shape[axis]; ++k) {
+            for (Index i = 0; i < inner; ++i) {
+                result[o * inner + i].push_back(static_cast<double>(dense[(o * shape[axis] + k) * inner + i]));
+            }
+        }
+    }
+    return result;
+}
+
+template<NDArrayLike A>
+void checkAxisReductions(const A& array, const Index axis) {
+    const auto expected = gatherAlongAxis(array, axis);
+    const auto sums     = nda::sum(array, axis);
+    const auto means    = nda::mean(array, axis);
+    const auto mins     = nda::min(array, axis);
+    const auto maxs     = nda::max(array, axis);
+    const auto argmaxs  = nda::argmax(array, axis);
+    const auto norms    = nda::norm(array, axis);
+    REQUIRE(sums.size() == static_cast<Size>(expected.size()));
+
+    for (Index o = 0; o < sums.size(); ++o) {
+        const auto& values = expected[o];
+        double sum         = 0;
+        double squares     = 0;
+        Index best         = 0;
+        for (Index k = 0; k < static_cast<Size>(values.size()); ++k) {
+            sum += values[k];
+            squares += values[k] * values[k];
+            best = values[k] > values[best] ? k : best;
+        }
+        REQUIRE(sums[o] == Approx(sum).margin(1e-9));
+        REQUIRE(means[o] == Approx(sum / static_cast<double>(values.size())).margin(1e-9));
+        REQUIRE(mins[o] == *std::min_element(values.begin(), values.end()));
+        REQUIRE(maxs[o] == values[best]);
+        REQUIRE(argmaxs[o] == best);
+        REQUIRE(norms[o] == Approx(std::sqrt(squares)));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Reductions along an axis", "[reduction]") {
+    auto array = eighthsArray<double>({7, 300, 5}, 1);
+
+    SECTION("Every axis of a dense array") {
+        for (Index axis = 0; axis < 3; ++axis) {
+            checkAxisReductions(array, axis);
+        }
+        REQUIRE(nda::eq(nda::sum(array, -1), nda::sum(array, 2)));
+        REQUIRE(nda::sum(array, 1).shape() == TestArray::Shape{7, 5});
+    }
+    SECTION("Slices and permuted views") {
+        const TestSlice slice(array, {IR::between(1, 6), IR::e2e().withStep(3), IR::reversed()});
+        const auto permuted = permute(array, {2, 0, 1});
+        for (Index axis = 0; axis < 3; ++axis) {
+            checkAxisReductions(slice, axis);
+            checkAxisReductions(permuted, axis);
+        }
+    }
+    SECTION("Long columns split into several chunks") {
+        const auto table = eighthsArray<double>({70001, 3}, 2);
+        checkAxisReductions(table, 0);
+        checkAxisReductions(table, 1);
+    }
+}
+
+TEST_CASE("Reductions over all elements", "[reduction]") {
+    const auto array = eighthsArray<double>({300, 401}, 3);
+    const auto flat  = gatherAlongAxis(TestArray(array.begin(), array.end(), {array.size()}), 0)[0];
+
+    double sum = 0;
+    Index best = 0;
+    for (Index i = 0; i < static_cast<Size>(flat.size()); ++i) {
+        sum += flat[i];
+        best = flat[i] > flat[best] ? i : best;
+    }
+    REQUIRE(nda::sum(array) == Approx(sum));
+    REQUIRE(nda::mean(array) == Approx(sum / array.size()));
+    REQUIRE(nda::argmax(array) == best);
+    REQUIRE(nda::max(array) == flat[best]);
+    REQUIRE(nda::min(array) == *std::min_element(flat.begin(), flat.end()));
+    REQUIRE(nda::norm(array) == Approx(nda::magnitude(array)));
+    STATIC_REQUIRE(HasNorm<TestArray>);
+    STATIC_REQUIRE(!HasNorm<NDArray<int32_t>>);
+
+    SECTION("Permuted views report linear indices in their own iteration order") {
+        const auto view = nda::d2::transpose(array);
+        REQUIRE(nda::argmax(view) == nda::argmax(nda::materialize(view)));
+        REQUIRE(nda::sum(view) == Approx(sum));
+    }
+    SECTION("NaN propagates through min and max") {
+        auto withNan  = array.clone();
+        withNan[1000] = std::numeric_limits<double>::quiet_NaN();
+        REQUIRE(std::isnan(nda::min(withNan)));
+        REQUIRE(std::isnan(nda::max(nda::d2::transpose(withNan))));
+        const auto mins = nda::min(withNan, 0);
+        const auto maxs = nda::max(withNan, 1);
+        REQUIRE(std::isnan(mins[1000 % 401]));
+        REQUIRE(!std::isnan(mins[0]));
+        REQUIRE(std::isnan(maxs[1000 / 401]));
+        REQUIRE(!std::isnan(maxs[0]));
+    }
+    SECTION("Integer arrays") {
+        const NDArray<int32_t> ints{{3, -7, 12, 12, 5, -1}, {2, 3}};
+        REQUIRE(nda::sum(ints) == 24);
+        REQUIRE(nda::min(ints) == -7);
+        REQUIRE(nda::argmax(ints) == 2);
+        REQUIRE(nda::eq(nda::sum(ints, 0), NDArray<int32_t>{{15, -2, 11}, {3}}));
+    }
+}
+
+TEST_CASE("Reductions are deterministic and accurate", "[reduction]") {
+    SECTION("Same bits for every thread count") {
+        const auto table = eighthsArray<float>({200003, 7}, 4);
+        const auto reference = nda::reduce(table, 0, nda::reduction::Sum{}, 1);
+        const auto referenceAll = nda::reduceAll(table, nda::reduction::Sum{}, 1);
+        for (const Size threads : {2, 3, 8}) {
+            REQUIRE(nda::eq(nda::reduce(table, 0, nda::reduction::Sum{}, threads), reference));
+            REQUIRE(nda::reduceAll(table, nda::reduction::Sum{}, threads) == referenceAll);
+        }
+    }
+    SECTION("Pairwise summation keeps float error small") {
+        const auto values = NDArray<float>::filled({1 << 22}, 0.1F);
+        REQUIRE(nda::sum(values) == Approx(419430.4).epsilon(1e-6));
+        REQUIRE(nda::sum(values, 0)[0] == Approx(419430.4).epsilon(1e-6));
+    }
+}
+
+TEST_CASE("Reduction errors", "[reduction]") {
+    const auto array = TestArray::zeros({3, 0});
+    REQUIRE_THROWS_AS(nda::sum(array, 2), nda::reduction::InvalidAxis);
+    REQUIRE_THROWS_AS(nda::sum(array, -3), nda::reduction::InvalidAxis);
+    REQUIRE_THROWS_AS(nda::max(array, 1), nda::reduction::EmptyReduction);
+    REQUIRE_THROWS_AS(nda::argmax(array), nda::reduction::EmptyReduction);
+    REQUIRE(nda::sum(array) == 0);
+    REQUIRE(nda::eq(nda::sum(array, 1), TestArray::zeros({3})));
+    REQUIRE(nda::max(array, 0).shape() == TestArray::Shape{0});
+}
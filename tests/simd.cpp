@@ -0,0 +1,156 @@
+#include "nykdtb/simd.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+
+#include "nykdtb/ndarray_ops.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+template<typename T>
+void checkKernels(simd::Level level) {
+    using simd::BinaryOp;
+    constexpr Size count = 77;
+
+    for (auto op : {BinaryOp::Add, BinaryOp::Sub, BinaryOp::Mul, BinaryOp::Div}) {
+        Vec<T> lhs(count);
+        Vec<T> rhs(count);
+        for (Index i = 0; i < count; ++i) {
+            lhs[i] = static_cast<T>(i * 3 - 50);
+            rhs[i] = static_cast<T>((i % 7) + 1);
+        }
+
+        Vec<T> expected(lhs);
+        Vec<T> expectedScalar(lhs);
+        for (Index i = 0; i < count; ++i) {
+            switch (op) {
+                case BinaryOp::Add:
+                    expected[i] += rhs[i];
+                    expectedScalar[i] += T(3);
+                    break;
+                case BinaryOp::Sub:
+                    expected[i] -= rhs[i];
+                    expectedScalar[i] -= T(3);
+                    break;
+                case BinaryOp::Mul:
+                    expected[i] *= rhs[i];
+                    expectedScalar[i] *= T(3);
+                    break;
+                case BinaryOp::Div:
+                    expected[i] /= rhs[i];
+                    expectedScalar[i] /= T(3);
+                    break;
+            }
+        }
+
+        simd::setMaxLevel(level);
+        Vec<T> actual(lhs);
+        Vec<T> actualScalar(lhs);
+        simd::apply(op, actual.data(), rhs.data(), count);
+        simd::applyScalar(op, actualScalar.data(), T(3), count);
+
+        REQUIRE(actual == expected);
+        REQUIRE(actualScalar == expectedScalar);
+    }
+
+    // Min and Max propagate NaN from the first lane, the vector body and the scalar tail alike
+    if constexpr (std::is_floating_point_v<T>) {
+        for (Index at : {0, 1, 40, count - 1}) {
+            Vec<T> values(count);
+            for (Index i = 0; i < count; ++i) {
+                values[i] = static_cast<T>(i * 3 - 50);
+            }
+            values[at] = std::numeric_limits<T>::quiet_NaN();
+            const Vec<T> ones(count, T(1));
+
+            simd::setMaxLevel(level);
+            for (auto op : {simd::ReduceOp::Min, simd::ReduceOp::Max}) {
+                REQUIRE(std::isnan(simd::reduce(op, values.data(), count)));
+
+                Vec<T> intoNumbers(ones);
+                Vec<T> intoNan(values);
+                simd::accumulate(op, intoNumbers.data(), values.data(), count);
+                simd::accumulate(op, intoNan.data(), ones.data(), count);
+                for (Index i = 0; i < count; ++i) {
+                    const T other = op == simd::ReduceOp::Min ? std::min(values[i], T(1)) : std::max(values[i], T(1));
+                    REQUIRE(std::isnan(intoNumbers[i]) == (i == at));
+                    REQUIRE(std::isnan(intoNan[i]) == (i == at));
+                    if (i != at) {
+                        REQUIRE(intoNumbers[i] == other);
+                        REQUIRE(intoNan[i] == other);
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename T>
+void checkTranspose(simd::Level level) {
+    constexpr Size rows       = 19;
+    constexpr Size cols       = 13;
+    constexpr Index srcStride = 21;
+    constexpr Index dstStride = 23;
+
+    Vec<T> src(rows * srcStride);
+    for (Index i = 0; i < static_cast<Size>(src.size()); ++i) {
+        src[i] = static_cast<T>(i);
+    }
+    Vec<T> expected(cols * dstStride, T(-1));
+    for (Index r = 0; r < rows; ++r) {
+        for (Index c = 0; c < cols; ++c) {
+            expected[c * dstStride + r] = src[r * srcStride + c];
+        }
+    }
+
+    simd::setMaxLevel(level);
+    Vec<T> actual(cols * dstStride, T(-1));
+    simd::transpose(src.data(), srcStride, actual.data(), dstStride, rows, cols);
+    REQUIRE(actual == expected);
+}
+
+}  // namespace
+
+TEST_CASE("SIMD transpose matches scalar results on every available level", "[simd]") {
+    const auto detected = simd::detectedLevel();
+    for (auto level : {simd::Level::Scalar, simd::Level::SSE41, simd::Level::AVX2, simd::Level::AVX512}) {
+        if (level > detected) {
+            continue;
+        }
+        checkTranspose<float>(level);
+        checkTranspose<double>(level);
+        checkTranspose<int32_t>(level);
+    }
+    simd::setMaxLevel(detected);
+}
+
+TEST_CASE("SIMD kernels match scalar results on every available level", "[simd]") {
+    const auto detected = simd::detectedLevel();
+    for (auto level : {simd::Level::Scalar, simd::Level::SSE41, simd::Level::AVX2, simd::Level::AVX512}) {
+        if (level > detected) {
+            continue;
+        }
+        checkKernels<float>(level);
+        checkKernels<double>(level);
+        checkKernels<int32_t>(level);
+        REQUIRE(simd::activeLevel() == level);
+    }
+    simd::setMaxLevel(detected);
+}
+
+TEST_CASE("SIMD dispatch from element-wise ops", "[simd][ndarray]") {
+    NDArray<int32_t> lhs = NDArray<int32_t>::filled({5, 7}, 4);
+    const NDArray<int32_t> rhs = NDArray<int32_t>::filled({5, 7}, 2);
+
+    nda::ewMulAssign(lhs, rhs);
+    nda::subAssignScalar(lhs, 1);
+    nda::ewDivAssign(lhs, rhs);
+
+    for (const auto value : lhs) {
+        REQUIRE(value == 3);
+    }
+}
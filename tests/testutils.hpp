@@ -0,0 +1,68 @@
+#ifndef NYKDTB_TESTUTILS_HPP
+#define NYKDTB_TESTUTILS_HPP
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+
+#include "nykdtb/ndarray.hpp"
+
+namespace nykdtb {
+
+// Path in the temporary directory, the file is removed when the test is done
+struct TempFile {
+    explicit TempFile(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("nykdtb_" + name)).string()) {}
+    ~TempFile() { std::filesystem::remove(path); }
+
+    std::string path;
+};
+
+// Static arrays with a smaller alignment than the default
+struct StaticParams {
+    static constexpr Size STORAGE_ALIGNMENT = 64;
+};
+
+// Linear congruential generator, the same sequence on every platform and standard library
+inline static uint32_t lcgNext(uint32_t& seed) {
+    seed = seed * 1664525U + 1013904223U;
+    return seed;
+}
+
+// Fills array with values in [-0.5, 0.5)
+template<NDArrayLike A>
+inline static void lcgFill(A& array, uint32_t seed) {
+    using T = std::remove_cvref_t<typename A::Type>;
+    for (Index i = 0; i < array.size(); ++i) {
+        array[i] = static_cast<T>(lcgNext(seed) >> 8) / static_cast<T>(1U << 24) - T(0.5);
+    }
+}
+
+template<typename T>
+inline static NDArray<T> lcgArray(typename NDArray<T>::Shape shape, const uint32_t seed) {
+    auto result = NDArray<T>::zeros(mmove(shape));
+    lcgFill(result, seed);
+    return result;
+}
+
+template<typename T>
+inline static void requireApprox(const T* actual, const T* expected, const Size count, const double margin) {
+    for (Index i = 0; i < count; ++i) {
+        REQUIRE(actual[i] == Approx(expected[i]).margin(margin));
+    }
+}
+
+template<NDArrayLike A, NDArrayLike E>
+inline static void requireApprox(const A& actual, const E& expected, const double margin) {
+    REQUIRE(NDArrayCalc::equalShapes(actual.shape(), expected.shape()));
+    for (Index i = 0; i < actual.size(); ++i) {
+        REQUIRE(actual[i] == Approx(expected[i]).margin(margin));
+    }
+}
+
+}  // namespace nykdtb
+
+#endif
@@ -0,0 +1,165 @@
+#include "nykdtb/threadpool.hpp"
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <string>
+
+using namespace nykdtb;
+
+TEST_CASE("ThreadPool runs every task once", "[threadpool]") {
+    ThreadPool pool(3);
+    Vec<std::atomic<Size>> hits(1000);
+
+    pool.run(static_cast<Size>(hits.size()), [&](Index i) { ++hits[i]; }, 4);
+
+    for (const auto& hit : hits) {
+        REQUIRE(hit.load() == 1);
+    }
+}
+
+TEST_CASE("ThreadPool rethrows task exception", "[threadpool]") {
+    ThreadPool pool(2);
+
+    REQUIRE_THROWS_AS(pool.run(
+                          10,
+                          [](Index i) {
+                              if (i == 7) {
+                                  throw RuntimeException("task failed");
+                              }
+                          },
+                          3),
+                      RuntimeException);
+}
+
+TEST_CASE("ThreadPool nested run", "[threadpool]") {
+    std::atomic<Size> total{0};
+
+    parallelRun(
+        4, [&](Index) { parallelRun(8, [&](Index) { ++total; }, 2); }, 3);
+
+    REQUIRE(total.load() == 32);
+}
+
+TEST_CASE("ThreadPool spreads uneven tasks", "[threadpool]") {
+    ThreadPool pool(3);
+    std::atomic<Size> total{0};
+
+    // Early tasks are much slower, whoever holds them must get the rest stolen from its deque
+    pool.run(
+        64,
+        [&](Index i) {
+            if (i < 4) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            ++total;
+        },
+        4);
+
+    REQUIRE(total.load() == 64);
+}
+
+TEST_CASE("ThreadPool respects the thread count", "[threadpool]") {
+    ThreadPool pool(6);
+    std::atomic<Size> active{0};
+    std::atomic<Size> peak{0};
+
+    pool.run(
+        200,
+        [&](Index) {
+            const Size now = ++active;
+            Size seen      = peak.load();
+            while (seen < now && !peak.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            --active;
+        },
+        3);
+
+    REQUIRE(peak.load() <= 3);
+}
+
+TEST_CASE("ThreadPool concurrent runs from outside threads", "[threadpool]") {
+    ThreadPool pool(3);
+    Vec<std::atomic<Size>> totals(4);
+    Vec<std::thread> callers;
+
+    for (Index c = 0; c < 4; ++c) {
+        callers.emplace_back([&, c]() {
+            for (Index round = 0; round < 20; ++round) {
+                pool.run(50, [&](Index) { ++totals[c]; }, 3);
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    for (const auto& total : totals) {
+        REQUIRE(total.load() == 1000);
+    }
+}
+
+TEST_CASE("parallelFor covers the range in blocks", "[threadpool]") {
+    Vec<std::atomic<Size>> hits(1003);
+    std::atomic<Size> largestBlock{0};
+
+    parallelFor(
+        3,
+        1003,
+        [&](Index begin, Index end) {
+            largestBlock = std::max(largestBlock.load(), end - begin);
+            for (Index i = begin; i < end; ++i) {
+                ++hits[i];
+            }
+        },
+        4,
+        10);
+
+    REQUIRE(largestBlock.load() == 10);
+    for (Index i = 0; i < static_cast<Size>(hits.size()); ++i) {
+        REQUIRE(hits[i].load() == (i < 3 ? 0 : 1));
+    }
+    parallelFor(5, 5, [](Index, Index) { FAIL("Empty range has no blocks"); });
+}
+
+TEST_CASE("parallelReduce combines blocks in order", "[threadpool]") {
+    const auto concat = [](Index begin, Index end) {
+        std::string result;
+        for (Index i = begin; i < end; ++i) {
+            result += static_cast<char>('a' + i % 26);
+        }
+        return result;
+    };
+    const auto join = [](std::string lhs, const std::string& rhs) { return lhs + rhs; };
+
+    REQUIRE(parallelReduce(0, 52, std::string(">"), concat, join, 4, 3) ==
+            ">abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz");
+    REQUIRE(parallelReduce(0, 0, std::string("empty"), concat, join, 4) == "empty");
+
+    SECTION("Deterministic for a fixed blocking") {
+        const auto sum = [](Index begin, Index end) {
+            float result = 0;
+            for (Index i = begin; i < end; ++i) {
+                result += 1.0F / static_cast<float>(i + 1);
+            }
+            return result;
+        };
+        const auto add       = [](float lhs, float rhs) { return lhs + rhs; };
+        const float expected = parallelReduce(0, 100000, 0.0F, sum, add, 4);
+        for (Index round = 0; round < 10; ++round) {
+            REQUIRE(parallelReduce(0, 100000, 0.0F, sum, add, 4) == expected);
+        }
+        REQUIRE(parallelReduce(0, 100000, 0.0F, sum, add, 1, 4096) ==
+                parallelReduce(0, 100000, 0.0F, sum, add, 8, 4096));
+    }
+}
+
+TEST_CASE("Default thread count is configurable", "[threadpool]") {
+    const auto original = defaultThreadCount();
+    setDefaultThreadCount(3);
+    REQUIRE(defaultThreadCount() == 3);
+    setDefaultThreadCount(0);
+    REQUIRE(defaultThreadCount() >= 1);
+    setDefaultThreadCount(original);
+}
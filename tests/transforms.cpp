@@ -0,0 +1,113 @@
+#include "nykdtb/transforms.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+#include "nykdtb/ndarray_ops.hpp"
+#include "nykdtb/simd.hpp"
+#include "testutils.hpp"
+
+using namespace nykdtb;
+
+namespace {
+
+// Item i of a {N, dim, dim} batch as a dense 2D matrix
+template<typename T>
+NDArray<T> item(const NDArray<T>& batch, const Index i) {
+    const Size dim  = batch.shape(1);
+    const T* matrix = batch.begin() + i * dim * dim;
+    return NDArray<T>(matrix, matrix + dim * dim, typename NDArray<T>::Shape{dim, dim});
+}
+
+template<typename T>
+void checkCompose(const Size dim, const Size lhsCount, const Size rhsCount) {
+    const auto lhs    = lcgArray<T>({lhsCount, dim, dim}, 1);
+    const auto rhs    = lcgArray<T>({rhsCount, dim, dim}, 2);
+    const auto result = nda::transforms::compose(lhs, rhs);
+    const Size count  = std::max(lhsCount, rhsCount);
+    REQUIRE(result.shape() == typename NDArray<T>::Shape{count, dim, dim});
+    for (Index i = 0; i < count; ++i) {
+        const auto expected = nda::d2::matMul(item(lhs, lhsCount == 1 ? 0 : i), item(rhs, rhsCount == 1 ? 0 : i));
+        requireApprox(result.begin() + i * dim * dim, expected.begin(), dim * dim, 1e-5);
+    }
+}
+
+template<typename T>
+void checkApply(const Size dim, const Size transformCount, const Size pointCount) {
+    const auto transforms = lcgArray<T>({transformCount, dim, dim}, 3);
+    const auto points     = lcgArray<T>({pointCount, 3}, 4);
+    const auto result     = nda::transforms::apply(transforms, points);
+    REQUIRE(result.shape() == typename NDArray<T>::Shape{pointCount, 3});
+    for (Index i = 0; i < pointCount; ++i) {
+        const auto matrix = item(transforms, transformCount == 1 ? 0 : i);
+        T expected[3];
+        for (Index r = 0; r < 3; ++r) {
+            expected[r] = dim == 4 ? matrix[{r, 3}] : T(0);
+            for (Index c = 0; c < 3; ++c) {
+                expected[r] += matrix[{r, c}] * points[{i, c}];
+            }
+        }
+        requireApprox(result.begin() + i * 3, expected, 3, 1e-5);
+    }
+}
+
+template<typename T>
+void checkAxisAngle(const Size count) {
+    auto axes   = lcgArray<T>({count, 3}, 5);
+    auto angles = lcgArray<T>({count}, 6);
+    nda::mulAssignScalar(angles, T(10));
+    for (Index i = 0; i < count; ++i) {
+        const T length = std::sqrt(axes[{i, 0}] * axes[{i, 0}] + axes[{i, 1}] * axes[{i, 1}] +
+                                   axes[{i, 2}] * axes[{i, 2}]);
+        for (Index c = 0; c < 3; ++c) {
+            axes[{i, c}] /= length;
+        }
+    }
+
+    const auto result = nda::transforms::axisAngle(axes, angles);
+    REQUIRE(result.shape() == typename NDArray<T>::Shape{count, 3, 3});
+    for (Index i = 0; i < count; ++i) {
+        const auto expected =
+            nda::d2::rotAngleMx<NDArray<T>>(axes[{i, 0}], axes[{i, 1}], axes[{i, 2}], angles[i]);
+        requireApprox(result.begin() + i * 9, expected.begin(), 9, 1e-5);
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Batched transforms match per-matrix results on every available level", "[transforms]") {
+    const auto detected = simd::detectedLevel();
+    for (auto level : {simd::Level::Scalar, simd::Level::SSE41, simd::Level::AVX2, simd::Level::AVX512}) {
+        if (level > detected) {
+            continue;
+        }
+        simd::setMaxLevel(level);
+        for (const Size dim : {3, 4}) {
+            checkCompose<float>(dim, 37, 37);
+            checkCompose<double>(dim, 37, 37);
+            checkCompose<float>(dim, 1, 21);
+            checkCompose<double>(dim, 21, 1);
+            checkApply<float>(dim, 45, 45);
+            checkApply<double>(dim, 1, 45);
+        }
+        checkAxisAngle<float>(29);
+        checkAxisAngle<double>(29);
+    }
+    simd::setMaxLevel(detected);
+}
+
+TEST_CASE("Batched transform shape errors", "[transforms]") {
+    using TestArray = NDArray<float>;
+    const auto rotations = TestArray::zeros({4, 3, 3});
+    REQUIRE_THROWS_AS(nda::transforms::compose(rotations, TestArray::zeros({3, 3, 3})),
+                      nda::transforms::TransformShapeError);
+    REQUIRE_THROWS_AS(nda::transforms::compose(rotations, TestArray::zeros({4, 4, 4})),
+                      nda::transforms::TransformShapeError);
+    REQUIRE_THROWS_AS(nda::transforms::apply(rotations, TestArray::zeros({4, 4})),
+                      nda::transforms::TransformShapeError);
+    REQUIRE_THROWS_AS(nda::transforms::apply(TestArray::zeros({4, 2, 2}), TestArray::zeros({4, 3})),
+                      nda::transforms::TransformShapeError);
+    REQUIRE_THROWS_AS(nda::transforms::axisAngle(TestArray::zeros({4, 3}), TestArray::zeros({3})),
+                      nda::transforms::TransformShapeError);
+}
@@ -0,0 +1,73 @@
+#include "nykdtb/transpose.hpp"
+
+#include <catch2/catch.hpp>
+
+#include "nykdtb/ndarray_ops.hpp"
+
+using namespace nykdtb;
+
+using TestArray = NDArray<float>;
+using TestSlice = NDArraySlice<TestArray>;
+
+namespace {
+
+template<typename T>
+NDArray<T> sequence(NDArray<Size>::Shape shape) {
+    auto result = NDArray<T>::zeros(shape);
+    for (Index i = 0; i < result.size(); ++i) {
+        result[i] = static_cast<T>(i);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Blocked materialize of permuted views", "[transpose]") {
+    SECTION("Large 2D transpose with ragged edges") {
+        const auto matrix = sequence<float>({203, 157});
+        const auto view   = nda::d2::transpose(matrix);
+        REQUIRE(nda::eq(nda::materialize(view), view.materialize()));
+        REQUIRE(nda::eq(nda::d2::transposed(matrix), view.materialize()));
+    }
+    SECTION("HWC to CHW") {
+        const auto image = sequence<int32_t>({37, 45, 3});
+        const auto view  = permute(image, {2, 0, 1});
+        REQUIRE(nda::eq(nda::materialize(view), view.materialize()));
+    }
+    SECTION("Inner dimension kept, outer dimensions swapped") {
+        const auto stack = sequence<double>({6, 5, 70});
+        const auto view  = permute(stack, {1, 0, 2});
+        REQUIRE(nda::eq(nda::materialize(view), view.materialize()));
+    }
+    SECTION("Four dimensions with size 1 axes") {
+        const auto batch = sequence<float>({3, 1, 20, 90});
+        const auto view  = permute(batch, {3, 1, 0, 2});
+        REQUIRE(nda::eq(nda::materialize(view), view.materialize()));
+    }
+    SECTION("Stepped and reversed slices") {
+        auto matrix = sequence<float>({90, 80});
+        const TestSlice stepped(matrix, {IR::e2e().withStep(3), IR::reversed()});
+        REQUIRE(nda::eq(nda::materialize(stepped), stepped.materialize()));
+        const TestSlice column(matrix, {IR::reversed(), IR::single(5)});
+        REQUIRE(nda::eq(nda::materialize(column), column.materialize()));
+    }
+    SECTION("Non vectorizable element type") {
+        const auto matrix = sequence<int64_t>({70, 90});
+        const auto view   = permute(matrix, {1, 0});
+        REQUIRE(nda::eq(nda::materialize(view), view.materialize()));
+    }
+}
+
+TEST_CASE("Parallel materialize of permuted views", "[transpose]") {
+    const auto image = sequence<float>({300, 260, 3});
+    const auto view  = permute(image, {2, 0, 1});
+    const auto ref   = view.materialize();
+
+    SECTION("Explicit thread count") { REQUIRE(nda::eq(nda::parallelMaterialize(view, 4), ref)); }
+    SECTION("Default thread count") { REQUIRE(nda::eq(nda::parallelMaterialize(view), ref)); }
+    SECTION("Transpose split into row blocks") {
+        const auto matrix         = sequence<float>({700, 500});
+        const auto transposedView = nda::d2::transpose(matrix);
+        REQUIRE(nda::eq(nda::parallelMaterialize(transposedView, 3), transposedView.materialize()));
+    }
+}